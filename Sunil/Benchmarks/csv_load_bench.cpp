@@ -0,0 +1,145 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../common/mapped_csv.h"
+using namespace std;
+
+/*
+ Load time and peak RSS of the old ifstream/stringstream loaders versus
+ MappedCSV, on an air_sensors.csv-shaped dump (Zone,PM25,PM10,CO,Wind).
+
+   csv_load_bench <dump.csv>                 benchmark an existing dump
+   csv_load_bench --generate <rows> <out.csv> write a synthetic dump first
+
+ Each method runs in its own forked child so peak RSS is not shared.
+ "load" keeps every record in a vector (what the programs do), "scan"
+ only aggregates (what a one-pass report needs).
+*/
+
+struct Record {
+    string zone;
+    int pm25, pm10, co;
+    char wind;
+};
+
+void generateDump(const string& path, long long rows) {
+    ofstream out(path);
+    out << "Zone,PM25,PM10,CO,Wind\n";
+    const char winds[4] = {'N','E','S','W'};
+    unsigned seed = 1;
+    string buf;
+    for (long long i = 0; i < rows; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        buf += "Zone" + to_string(seed % 5000) + "," + to_string(seed % 400) + ","
+             + to_string((seed >> 8) % 450) + "," + to_string((seed >> 16) % 15) + ","
+             + winds[(seed >> 20) % 4] + "\n";
+        if (buf.size() > (1 << 20)) { out << buf; buf.clear(); }
+    }
+    out << buf;
+}
+
+// The pattern every loader used before MappedCSV
+long long legacyLoad(const string& path, bool keep) {
+    vector<Record> data;
+    ifstream fin(path);
+    string line;
+    long long sum = 0;
+    getline(fin, line); // skip header
+    while (getline(fin, line)) {
+        if (line.empty()) continue;
+        stringstream ss(line);
+        Record r;
+        string temp;
+        getline(ss, r.zone, ',');
+        getline(ss, temp, ','); r.pm25 = stoi(temp);
+        getline(ss, temp, ','); r.pm10 = stoi(temp);
+        getline(ss, temp, ','); r.co = stoi(temp);
+        getline(ss, temp, ','); r.wind = temp[0];
+        sum += r.pm25 + r.pm10 + r.co;
+        if (keep) data.push_back(r);
+    }
+    return keep ? (long long)data.size() : sum;
+}
+
+long long mappedLoad(const string& path, bool keep) {
+    vector<Record> data;
+    MappedCSV fin(path);
+    CSVRow row;
+    long long sum = 0;
+    fin.skipLine(); // skip header
+    while (fin.nextRow(row)) {
+        int pm25 = row.toInt(1), pm10 = row.toInt(2), co = row.toInt(3);
+        sum += pm25 + pm10 + co;
+        if (keep) {
+            Record r;
+            r.zone = row.str(0);
+            r.pm25 = pm25; r.pm10 = pm10; r.co = co;
+            r.wind = row[4].empty() ? ' ' : row[4][0];
+            data.push_back(r);
+        }
+    }
+    return keep ? (long long)data.size() : sum;
+}
+
+void runInChild(const string& name, const string& path, bool mapped, bool keep) {
+    int fds[2];
+    if (pipe(fds) != 0) { perror("pipe"); return; }
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        auto t0 = chrono::steady_clock::now();
+        long long result = mapped ? mappedLoad(path, keep) : legacyLoad(path, keep);
+        double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        struct rusage ru;
+        getrusage(RUSAGE_SELF, &ru);
+        double out[3] = {sec, (double)ru.ru_maxrss, (double)result};
+        if (write(fds[1], out, sizeof(out)) != (ssize_t)sizeof(out)) _exit(1);
+        _exit(0);
+    }
+    close(fds[1]);
+    double in[3] = {0, 0, 0};
+    ssize_t got = read(fds[0], in, sizeof(in));
+    close(fds[0]);
+    waitpid(pid, 0, 0);
+    if (got != (ssize_t)sizeof(in)) { cerr << name << ": child failed\n"; return; }
+
+    cout << "bench=csv_load method=" << name
+         << " mode=" << (keep ? "load" : "scan")
+         << " seconds=" << in[0]
+         << " peak_rss_mb=" << in[1] / 1024.0
+         << " result=" << (long long)in[2] << endl;
+}
+
+int main(int argc, char* argv[]) {
+    string path;
+    if (argc >= 4 && string(argv[1]) == "--generate") {
+        path = argv[3];
+        generateDump(path, atoll(argv[2]));
+    } else if (argc >= 2) {
+        path = argv[1];
+    } else {
+        cerr << "Usage: csv_load_bench <dump.csv> | --generate <rows> <out.csv>\n";
+        return 1;
+    }
+
+    MappedCSV probe(path);
+    if (!probe.isOpen()) {
+        cerr << "Error opening file: " << path << endl;
+        return 1;
+    }
+    cout << "file=" << path << " size_mb=" << probe.bytes() / 1e6 << endl;
+    probe.close();
+
+    for (int keep = 0; keep <= 1; keep++) {
+        runInChild("ifstream_stringstream", path, false, keep);
+        runInChild("mmap_string_view", path, true, keep);
+    }
+    return 0;
+}
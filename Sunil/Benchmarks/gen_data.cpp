@@ -0,0 +1,111 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <cctype>
+using namespace std;
+
+/*
+ Seeded synthetic inputs in the schema of each program's CSV, for the
+ "bench-algorithms <csv>" modes and run_benchmarks.sh.
+
+   gen_data <schema> <rows> <out.csv> [seed]
+
+   traffic  traffic_data.csv       signal_id,vehicles,emergency
+   air      air_sensors.csv        Zone,PM25,PM10,CO,Wind
+   water    water_zones_data.csv   Zone,SubZone,WaterLevel,Pollution
+   land     land_pol_data.csv      Zone,Subzone,PollutionLevel,SoilToxicity,Moisture,HeavyMetalIndex
+   city     city_pollution_data.csv Area,AirAQI,WaterPollution,LandQuality,FloodRisk,IndustrialRisk
+
+ Values stay in the ranges of the shipped files. Row keys (zone, subzone,
+ area) are unique; water and land subzones come 50 to a zone. City areas
+ get place-like names from syllables plus a number, so prefix search has
+ realistic shared prefixes. The same seed always gives the same file.
+*/
+
+struct Rng {
+    uint64_t s;
+    explicit Rng(uint64_t seed) : s(seed * 0x9E3779B97F4A7C15ull + 1) {}
+    uint32_t next() {                   // splitmix64, top 32 bits
+        uint64_t z = (s += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return (uint32_t)((z ^ (z >> 31)) >> 32);
+    }
+    int range(int lo, int hi) { return lo + (int)(next() % (uint32_t)(hi - lo + 1)); }
+};
+
+const char* header(const string& schema) {
+    if (schema == "traffic") return "signal_id,vehicles,emergency";
+    if (schema == "air")     return "Zone,PM25,PM10,CO,Wind";
+    if (schema == "water")   return "Zone,SubZone,WaterLevel,Pollution";
+    if (schema == "land")    return "Zone,Subzone,PollutionLevel,SoilToxicity,Moisture,HeavyMetalIndex";
+    if (schema == "city")    return "Area,AirAQI,WaterPollution,LandQuality,FloodRisk,IndustrialRisk";
+    return 0;
+}
+
+string areaName(Rng& rng, long long i) {
+    static const char* syllables[] = {
+        "ko", "ra", "man", "ga", "la", "in", "di", "ra", "na", "gar", "wh", "ite", "field",
+        "ye", "la", "han", "ka", "jay", "pee", "nya", "ba", "sa", "va", "na", "gu", "di",
+        "hal", "li", "ma", "rat", "hal", "li", "he", "bb", "al", "je", "pe", "ban"
+    };
+    const int count = sizeof(syllables) / sizeof(syllables[0]);
+    string name;
+    int parts = rng.range(2, 4);
+    for (int p = 0; p < parts; p++)
+        name += syllables[rng.next() % count];
+    name[0] = (char)toupper(name[0]);
+    return name + " " + to_string(i);
+}
+
+void writeRow(string& buf, const string& schema, Rng& rng, long long i) {
+    static const char winds[4] = {'N', 'E', 'S', 'W'};
+    static const char* risks[3] = {"Low", "Medium", "High"};
+    string zone = "Zone" + to_string(i / 50);
+
+    if (schema == "traffic") {
+        buf += to_string(i + 1) + "," + to_string(rng.range(0, 60)) + ","
+             + (rng.next() % 1000 == 0 ? "1" : "0");
+    } else if (schema == "air") {
+        buf += "Zone" + to_string(i) + "," + to_string(rng.range(20, 300)) + ","
+             + to_string(rng.range(30, 350)) + "," + to_string(rng.range(1, 10)) + ","
+             + winds[rng.next() % 4];
+    } else if (schema == "water") {
+        buf += zone + "," + zone + "-S" + to_string(i % 50) + ","
+             + to_string(rng.range(20, 100)) + "," + to_string(rng.range(5, 90));
+    } else if (schema == "land") {
+        buf += zone + "," + zone + "-S" + to_string(i % 50) + ","
+             + to_string(rng.range(10, 100)) + "," + to_string(rng.range(5, 80)) + ","
+             + to_string(rng.range(10, 70)) + "," + to_string(rng.range(0, 60));
+    } else {
+        buf += areaName(rng, i) + "," + to_string(rng.range(30, 300)) + ","
+             + to_string(rng.range(5, 90)) + "," + to_string(rng.range(20, 95)) + ","
+             + risks[rng.next() % 3] + "," + risks[rng.next() % 3];
+    }
+    buf += '\n';
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 4 || !header(argv[1])) {
+        cerr << "Usage: gen_data <traffic|air|water|land|city> <rows> <out.csv> [seed]\n";
+        return 1;
+    }
+    string schema = argv[1];
+    long long rows = atoll(argv[2]);
+    Rng rng(argc > 4 ? strtoull(argv[4], 0, 10) : 1);
+
+    ofstream out(argv[3], ios::binary);
+    if (!out) {
+        cerr << "Error opening file: " << argv[3] << endl;
+        return 1;
+    }
+    string buf = string(header(schema)) + "\n";
+    for (long long i = 0; i < rows; i++) {
+        writeRow(buf, schema, rng, i);
+        if (buf.size() > (1 << 20)) { out << buf; buf.clear(); }
+    }
+    out << buf;
+    return out.good() ? 0 : 1;
+}
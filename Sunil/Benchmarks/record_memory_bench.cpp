@@ -0,0 +1,247 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <queue>
+#include <unordered_map>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <malloc.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../common/mapped_csv.h"
+#include "../common/intern.h"
+using namespace std;
+
+/*
+ Heap allocations and memory of the record arrays before and after the
+ names were interned (common/intern.h), on a CSV in one program's schema
+ (Benchmarks/gen_data writes them):
+
+   record_memory_bench <air|water|land|city> <csv>
+
+ "string" is the old layout: std::string names in every record, records
+ pushed without reserve, name lookups through unordered_map<string, int>.
+ "interned" is the current one: 4-byte ZoneIds (air and the app keep
+ string_views into an arena instead), vectors reserved from MappedCSV's row
+ estimate, name lookups through NameIndex. Both parse with MappedCSV, so
+ only the layout differs. Each program's load-time structures are built:
+
+   air    the sensor vector
+   water  the subzone vector, a name index and the ZonePriority heap
+   land   the subzone vector, a name index and the waste-collection heap
+   city   the area table: names, lowercased-name index, records
+
+ Every operator new is counted. allocs covers the whole load, heaps
+ included; live_mb is what is still held once the heaps are gone, i.e.
+ what the program keeps. Each layout runs in its own forked child so the
+ shared name table and the counters start empty. Strings of 15 chars or
+ fewer fit std::string's inline buffer, so short names never allocated
+ even in the old layout; the saving there is record size, not calls.
+*/
+
+static size_t allocCalls = 0, liveBytes = 0, peakBytes = 0;
+
+// Bytes are what malloc actually handed out, rounding included
+void* operator new(size_t n) {
+    void* p = malloc(n ? n : 1);
+    if (!p) throw bad_alloc();
+    allocCalls++;
+    liveBytes += malloc_usable_size(p);
+    peakBytes = max(peakBytes, liveBytes);
+    return p;
+}
+void operator delete(void* p) noexcept {
+    if (!p) return;
+    liveBytes -= malloc_usable_size(p);
+    free(p);
+}
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete[](void* q) noexcept { operator delete(q); }
+void operator delete(void* q, size_t) noexcept { operator delete(q); }
+void operator delete[](void* q, size_t) noexcept { operator delete(q); }
+
+string toLower(string s) {
+    transform(s.begin(), s.end(), s.begin(), ::tolower);
+    return s;
+}
+
+/* ---------- old layouts ---------- */
+
+struct AirString { string zone; int pm25, pm10, co; char wind; int aqi, anomaly; };
+struct WaterString { string zone, name; float waterLevel, pollution; string basin; };
+struct WaterPriorityString {
+    string zone, subzone; float score;
+    bool operator<(const WaterPriorityString& o) const { return score < o.score; }
+};
+struct LandString { string zone, name; double pollution, soil, moisture, heavy, quality; int index; };
+struct CityString { int air, water, land; string flood, industrial; int row; };
+
+/* ---------- interned layouts ---------- */
+
+struct AirInterned { string_view zone; int pm25, pm10, co; char wind; int aqi, anomaly; };
+struct WaterInterned { ZoneId zone, name; float waterLevel, pollution; ZoneId basin; };
+struct WaterPriorityInterned {
+    ZoneId zone, subzone; float score;
+    bool operator<(const WaterPriorityInterned& o) const { return score < o.score; }
+};
+struct LandInterned { ZoneId zone, name; double pollution, soil, moisture, heavy, quality; int index; };
+struct CityInterned { int air, water, land; string_view flood, industrial; int row; };
+
+template<class T> struct ByQuality {
+    bool operator()(const T& a, const T& b) const {
+        return a.quality == b.quality ? a.pollution < b.pollution : a.quality > b.quality;
+    }
+};
+
+// What every run keeps until the counters are read
+struct Kept {
+    vector<AirString> airS;         vector<AirInterned> airI;
+    StringInterner airNames;
+    vector<WaterString> waterS;     vector<WaterInterned> waterI;
+    vector<LandString> landS;       vector<LandInterned> landI;
+    unordered_map<string, int> nameS;
+    NameIndex nameI;
+    vector<string> cityNamesS;      vector<CityString> cityS;
+    StringInterner cityStrings;     vector<string_view> cityNamesI;
+    vector<int> cityByNameI;        vector<CityInterned> cityI;
+    string lowered;
+};
+
+long long loadString(const string& schema, MappedCSV& file, Kept& k) {
+    CSVRow row;
+    if (schema == "air") {
+        while (file.nextRow(row))
+            k.airS.push_back({row.str(0), row.toInt(1), row.toInt(2), row.toInt(3),
+                              row[4].empty() ? ' ' : row[4][0], 0, 0});
+        return k.airS.size();
+    }
+    if (schema == "water") {
+        while (file.nextRow(row))
+            k.waterS.push_back({row.str(0), row.str(1), row.toFloat(2), row.toFloat(3), row.str(4)});
+        for (size_t i = 0; i < k.waterS.size(); i++) k.nameS[k.waterS[i].name] = i;
+        priority_queue<WaterPriorityString> pq;
+        for (auto& z : k.waterS) pq.push({z.zone, z.name, z.waterLevel + z.pollution});
+        return k.waterS.size();
+    }
+    if (schema == "land") {
+        while (file.nextRow(row))
+            k.landS.push_back({row.str(0), row.str(1), row.toDouble(2), row.toDouble(3), row.toDouble(4),
+                               row.toDouble(5), 100 - row.toDouble(2), (int)k.landS.size()});
+        for (auto& sz : k.landS) k.nameS[sz.name] = sz.index;
+        priority_queue<LandString, vector<LandString>, ByQuality<LandString>> pq(k.landS.begin(), k.landS.end());
+        return k.landS.size();
+    }
+    while (file.nextRow(row)) {
+        int id = k.cityNamesS.size();
+        k.nameS[toLower(row.str(0))] = id;
+        k.cityNamesS.push_back(row.str(0));
+        k.cityS.push_back({row.toInt(1), row.toInt(2), row.toInt(3), row.str(4), row.str(5), id});
+    }
+    return k.cityS.size();
+}
+
+long long loadInterned(const string& schema, MappedCSV& file, Kept& k) {
+    CSVRow row;
+    size_t expected = file.estimateRows();
+    if (schema == "air") {
+        k.airI.reserve(expected);
+        while (file.nextRow(row))
+            k.airI.push_back({k.airNames.store(row[0]), row.toInt(1), row.toInt(2), row.toInt(3),
+                              row[4].empty() ? ' ' : row[4][0], 0, 0});
+        return k.airI.size();
+    }
+    if (schema == "water") {
+        k.waterI.reserve(expected);
+        while (file.nextRow(row))
+            k.waterI.push_back({ZoneId(row[0]), ZoneId(row[1]), row.toFloat(2), row.toFloat(3), ZoneId(row[4])});
+        for (size_t i = 0; i < k.waterI.size(); i++) k.nameI.add(k.waterI[i].name, i);
+        priority_queue<WaterPriorityInterned> pq;
+        for (auto& z : k.waterI) pq.push({z.zone, z.name, z.waterLevel + z.pollution});
+        return k.waterI.size();
+    }
+    if (schema == "land") {
+        k.landI.reserve(expected);
+        while (file.nextRow(row))
+            k.landI.push_back({ZoneId(row[0]), ZoneId(row[1]), row.toDouble(2), row.toDouble(3), row.toDouble(4),
+                               row.toDouble(5), 100 - row.toDouble(2), (int)k.landI.size()});
+        for (auto& sz : k.landI) k.nameI.add(sz.name, sz.index);
+        priority_queue<LandInterned, vector<LandInterned>, ByQuality<LandInterned>> pq(k.landI.begin(), k.landI.end());
+        return k.landI.size();
+    }
+    k.cityNamesI.reserve(expected);
+    k.cityI.reserve(expected);
+    while (file.nextRow(row)) {
+        int id = k.cityNamesI.size();
+        k.lowered.assign(row[0].data(), row[0].size());
+        transform(k.lowered.begin(), k.lowered.end(), k.lowered.begin(), ::tolower);
+        uint32_t key = k.cityStrings.intern(k.lowered);
+        if (key >= k.cityByNameI.size()) k.cityByNameI.resize(key + 1, -1);
+        k.cityByNameI[key] = id;
+        k.cityNamesI.push_back(k.cityStrings.store(row[0]));
+        k.cityI.push_back({row.toInt(1), row.toInt(2), row.toInt(3),
+                           k.cityStrings.keep(row[4]), k.cityStrings.keep(row[5]), id});
+    }
+    return k.cityI.size();
+}
+
+void runInChild(const string& schema, const string& path, bool interned) {
+    int fds[2];
+    if (pipe(fds) != 0) { perror("pipe"); return; }
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        MappedCSV file(path);
+        file.skipLine(); // skip header
+        Kept* k = new Kept;
+        size_t calls0 = allocCalls, live0 = liveBytes;
+        peakBytes = liveBytes;
+        auto t0 = chrono::steady_clock::now();
+        long long rows = interned ? loadInterned(schema, file, *k) : loadString(schema, file, *k);
+        double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        double out[5] = {(double)rows, (double)(allocCalls - calls0), (double)(liveBytes - live0),
+                         (double)(peakBytes - live0), sec};
+        if (write(fds[1], out, sizeof(out)) != (ssize_t)sizeof(out)) _exit(1);
+        _exit(0);
+    }
+    close(fds[1]);
+    double in[5] = {0, 0, 0, 0, 0};
+    ssize_t got = read(fds[0], in, sizeof(in));
+    close(fds[0]);
+    waitpid(pid, 0, 0);
+    if (got != (ssize_t)sizeof(in)) { cerr << schema << ": child failed\n"; return; }
+
+    double perMillion = in[0] > 0 ? 1e6 / in[0] : 0;
+    cout << "bench=record_memory schema=" << schema
+         << " layout=" << (interned ? "interned" : "string")
+         << " rows=" << (long long)in[0]
+         << " allocs=" << (long long)in[1]
+         << " allocs_per_million=" << (long long)(in[1] * perMillion)
+         << " live_mb=" << in[2] / 1e6
+         << " mb_per_million=" << in[2] / 1e6 * perMillion
+         << " peak_mb=" << in[3] / 1e6
+         << " seconds=" << in[4] << endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        cerr << "Usage: record_memory_bench <air|water|land|city> <csv>\n";
+        return 1;
+    }
+    string schema = argv[1], path = argv[2];
+    if (schema != "air" && schema != "water" && schema != "land" && schema != "city") {
+        cerr << "Unknown schema: " << schema << endl;
+        return 1;
+    }
+    MappedCSV probe(path);
+    if (!probe.isOpen()) {
+        cerr << "Error opening file: " << path << endl;
+        return 1;
+    }
+    probe.close();
+
+    runInChild(schema, path, false);
+    runInChild(schema, path, true);
+    return 0;
+}
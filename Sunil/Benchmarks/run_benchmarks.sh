@@ -0,0 +1,190 @@
+#!/bin/sh
+# Cross-module algorithm benchmarks.
+#
+#   run_benchmarks.sh [max_rows] [out_dir]     (defaults: 10000000, ./results)
+#
+# Builds gen_data and the five programs, then for 10^3, 10^4, ... max_rows
+# rows generates each program's input schema (seed 1) and runs the
+# program's "bench-algorithms <csv>" mode from its own directory. Writes
+#
+#   <out_dir>/raw.txt                 every bench= line as printed
+#   <out_dir>/algorithms.csv          one row per function and size
+#   <out_dir>/measured_efficiency.csv per function: largest size timed,
+#                                     ns per row there, and the growth
+#                                     exponent k of time ~ rows^k between
+#                                     the two largest sizes
+#   <out_dir>/metrics_overhead.csv    per program and size, the share of
+#                                     the timed functions spent in the
+#                                     stage instrumentation (common/metrics.h),
+#                                     computed from timer counts and cost
+#   <out_dir>/metrics_ab.csv          per program, AB_PAIRS (default 9)
+#                                     back-to-back runs of the builds with
+#                                     and without -DNO_METRICS on AB_ROWS
+#                                     rows (default 10^6): median times,
+#                                     median paired gap, its noise and the
+#                                     verdict against 1%
+#
+# Exits non-zero when a program's instrumentation is over 1% beyond the
+# measured noise.
+#
+# The "Measured" column of each program's algorithm efficiency table is
+# taken from measured_efficiency.csv of a full run; update both together.
+#
+# Generated inputs are deleted after each run; a 10^7-row file is a few
+# hundred MB.
+set -e
+
+here=$(cd "$(dirname "$0")" && pwd)
+root=$(dirname "$here")
+max=${1:-10000000}
+out=${2:-$here/results}
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=c++17 -O2 -pthread}
+
+mkdir -p "$out/bin" "$out/data"
+out=$(cd "$out" && pwd)
+
+# Programs are also built with -DNO_METRICS as <name>_nometrics
+build() {
+    echo "build $2" >&2
+    $CXX $CXXFLAGS -o "$out/bin/$2" "$1"
+    [ "$2" = gen_data ] || $CXX $CXXFLAGS -DNO_METRICS -o "$out/bin/$2_nometrics" "$1"
+}
+build "$here/gen_data.cpp" gen_data
+build "$root/Traffic Management/t.cpp" t
+build "$root/Pollution Moniter/Air/AirQ_Moniter.cpp" AirQ_Moniter
+build "$root/Pollution Moniter/Water/waterQ.cpp" waterQ
+build "$root/Pollution Moniter/Land/LandQ.cpp" LandQ
+build "$root/Pollution Moniter/App/app.cpp" app
+
+# schema|program|directory the program runs in
+suites="traffic|t|$root/Traffic Management
+air|AirQ_Moniter|$root/Pollution Moniter/Air
+water|waterQ|$root/Pollution Moniter/Water
+land|LandQ|$root/Pollution Moniter/Land
+city|app|$root/Pollution Moniter/App"
+
+: > "$out/raw.txt"
+rows=1000
+while [ "$rows" -le "$max" ]; do
+    echo "$suites" | while IFS='|' read -r schema program dir; do
+        data="$out/data/$schema.csv"
+        echo "rows=$rows $program" >&2
+        "$out/bin/gen_data" "$schema" "$rows" "$data" 1
+        (cd "$dir" && "$out/bin/$program" bench-algorithms "$data") | grep '^bench=' >> "$out/raw.txt"
+        rm -f "$data"
+    done
+    rows=$((rows * 10))
+done
+
+awk '
+BEGIN { print "program,function,rows,ms,ns_per_row,capped_from" }
+/^bench=algorithm / {
+    delete f
+    for (i = 2; i <= NF; i++) { split($i, kv, "="); f[kv[1]] = kv[2] }
+    print f["program"] "," f["function"] "," f["rows"] "," f["ms"] "," f["ns_per_row"] "," f["capped_from"]
+}' "$out/raw.txt" > "$out/algorithms.csv"
+
+# Overhead lines follow the algorithm lines of their run, so the row
+# count is the first one seen after the previous overhead line
+awk '
+BEGIN { print "program,rows,timers,sampled_out,timer_ns,timed_ms,overhead_pct" }
+/^bench=algorithm / && rows == "" { split($4, kv, "="); rows = kv[2] }
+/^bench=metrics_overhead / {
+    delete f
+    for (i = 2; i <= NF; i++) { split($i, kv, "="); f[kv[1]] = kv[2] }
+    print f["program"] "," rows "," f["timers"] "," f["sampled_out"] "," f["timer_ns"] "," f["timed_ms"] "," f["overhead_pct"]
+    rows = ""
+}' "$out/raw.txt" > "$out/metrics_overhead.csv"
+
+# Growth is fitted between the two largest row counts of a function, where
+# fixed costs and timer noise matter least. Capped functions repeat their
+# cap as the row count; the fastest of those runs is kept.
+awk -F, '
+NR == 1 { next }
+{
+    key = $1 "," $2
+    if (!(key in top)) { order[++n] = key; top[key] = $3; topMs[key] = $4; prev[key] = 0; next }
+    if ($3 + 0 > top[key] + 0) {
+        prev[key] = top[key]; prevMs[key] = topMs[key]
+        top[key] = $3; topMs[key] = $4
+    } else if ($3 == top[key] && $4 + 0 < topMs[key] + 0) {
+        topMs[key] = $4
+    }
+}
+END {
+    print "Program,Function,Rows,Time (ms),ns per Row,Measured Growth (rows^k)"
+    for (i = 1; i <= n; i++) {
+        key = order[i]
+        growth = "n/a"
+        if (prev[key] > 0 && prevMs[key] > 0 && topMs[key] > 0)
+            growth = sprintf("%.2f", log(topMs[key] / prevMs[key]) / log(top[key] / prev[key]))
+        printf "%s,%d,%.4g,%.4g,%s\n", key, top[key], topMs[key], topMs[key] * 1e6 / top[key], growth
+    }
+}' "$out/algorithms.csv" > "$out/measured_efficiency.csv"
+
+# A/B: both builds of a program time the same input back to back,
+# AB_PAIRS times, the order swapping every pair so that drift hits both
+# equally. Each pair gives one gap (with / without - 1); the median gap is
+# compared against 1%. noise_pct is the ~95% half-width of that median,
+# 2.5 * 1.4826 * MAD / sqrt(pairs), from the spread of the gaps themselves:
+#   over_1pct     gap - noise >= 1, the instrumentation costs too much
+#   under_1pct    gap + noise <  1
+#   inconclusive  otherwise; more pairs or rows are needed to tell
+ab_rows=${AB_ROWS:-1000000}
+[ "$ab_rows" -le "$max" ] || ab_rows=$max
+ab_pairs=${AB_PAIRS:-9}
+
+# Sum of ms= over the bench=algorithm lines of one run
+timed_ms() {
+    (cd "$1" && "$2" bench-algorithms "$3") |
+        awk '/^bench=algorithm / { for (i = 2; i <= NF; i++) if ($i ~ /^ms=/) t += substr($i, 4) }
+             END { printf "%.6f\n", t }'
+}
+
+echo "program,rows,pairs,with_ms,without_ms,gap_pct,noise_pct,verdict" > "$out/metrics_ab.csv"
+echo "$suites" | while IFS='|' read -r schema program dir; do
+    data="$out/data/$schema.csv"
+    echo "a/b rows=$ab_rows $program" >&2
+    "$out/bin/gen_data" "$schema" "$ab_rows" "$data" 1
+    pairs=; pair=0
+    while [ "$pair" -lt "$ab_pairs" ]; do
+        if [ $((pair % 2)) -eq 0 ]; then
+            w=$(timed_ms "$dir" "$out/bin/$program" "$data")
+            x=$(timed_ms "$dir" "$out/bin/${program}_nometrics" "$data")
+        else
+            x=$(timed_ms "$dir" "$out/bin/${program}_nometrics" "$data")
+            w=$(timed_ms "$dir" "$out/bin/$program" "$data")
+        fi
+        pairs="$pairs $w:$x"
+        pair=$((pair + 1))
+    done
+    rm -f "$data"
+    echo "$program,$ab_rows,$ab_pairs,$pairs" | awk -F, '
+    function median(v, k,    i, j, t) {
+        for (i = 2; i <= k; i++)
+            for (j = i; j > 1 && v[j - 1] > v[j]; j--) { t = v[j]; v[j] = v[j - 1]; v[j - 1] = t }
+        return k % 2 ? v[(k + 1) / 2] : (v[k / 2] + v[k / 2 + 1]) / 2
+    }
+    {
+        k = split($4, p, " ")
+        for (i = 1; i <= k; i++) {
+            split(p[i], wx, ":")
+            w[i] = wx[1]; x[i] = wx[2]
+            g[i] = wx[2] > 0 ? (wx[1] / wx[2] - 1) * 100 : 0
+        }
+        gap = median(g, k)
+        for (i = 1; i <= k; i++) d[i] = g[i] > gap ? g[i] - gap : gap - g[i]
+        noise = 2.5 * 1.4826 * median(d, k) / sqrt(k)
+        verdict = gap - noise >= 1 ? "over_1pct" : gap + noise < 1 ? "under_1pct" : "inconclusive"
+        printf "%s,%s,%s,%.4g,%.4g,%.2f,%.2f,%s\n", $1, $2, $3, median(w, k), median(x, k), gap, noise, verdict
+    }' >> "$out/metrics_ab.csv"
+done
+
+echo "wrote $out/algorithms.csv, $out/measured_efficiency.csv, $out/metrics_overhead.csv and $out/metrics_ab.csv" >&2
+
+awk -F, 'NR > 1 && $8 != "under_1pct" {
+             print "instrumentation in " $1 " at " $2 " rows: gap " $6 "% +- " $7 "% (" $8 ")" > "/dev/stderr"
+             if ($8 == "over_1pct") bad = 1
+         }
+         END { exit bad }' "$out/metrics_ab.csv"
@@ -1,15 +1,34 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <vector>
 #include <queue>
+#include <algorithm>
 #include <climits>
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <thread>
+#include <unistd.h>
+#include <fcntl.h>
+#include <immintrin.h>
+#include "../../common/mapped_csv.h"
+#include "../../common/column_snapshot.h"
+#include "../../common/bench_timer.h"
+#include "../../common/metrics.h"
+#include "../../common/intern.h"
 using namespace std;
 
 /* ===================== DATA STRUCTURES ===================== */
 
+// Zone names are copied back to back into one arena and records hold a
+// view. They are not interned: every sensor has its own zone, so a name
+// table would only add a hash and a slot per row (measured_memory.csv).
+string_view zoneName(string_view s){
+    static StringInterner* arena=new StringInterner;
+    return arena->store(s);
+}
+
 struct AirSensor {
-    string zone;
+    string_view zone;       // into the zone arena
     int pm25, pm10, co;
     char wind;
     int aqi;
@@ -34,29 +53,286 @@ int detectAnomaly(int aqi) {
     else return 2;
 }
 
+/* ===================== BATCH AQI KERNEL (SoA) ===================== */
+
+// Structure-of-arrays sensor table for whole-city refreshes. zone and
+// wind stay out of the hot arrays the kernel streams through.
+struct SensorStore {
+    vector<string_view> zone;
+    vector<char> wind;
+    vector<int> pm25, pm10, co;
+    vector<int> aqi, anomaly;
+
+    size_t size() const { return pm25.size(); }
+    void add(const AirSensor& s){
+        zone.push_back(s.zone); wind.push_back(s.wind);
+        pm25.push_back(s.pm25); pm10.push_back(s.pm10); co.push_back(s.co);
+        aqi.push_back(s.aqi); anomaly.push_back(s.anomaly);
+    }
+};
+
+void computeBatchScalar(const int* pm25,const int* pm10,const int* co,int* aqi,int* anomaly,size_t n){
+    for(size_t i=0;i<n;i++){
+        aqi[i]=calculateAQI(pm25[i],pm10[i],co[i]);
+        anomaly[i]=detectAnomaly(aqi[i]);
+    }
+}
+
+// 8 sensors per step. x/9 uses the signed magic-number division
+// (mulhi by 0x38E38E39, >>1, +1 for negatives) which matches C's
+// truncating '/', and the anomaly level is (aqi>=100)+(aqi>=180).
+__attribute__((target("avx2")))
+void computeBatchAVX2(const int* pm25,const int* pm10,const int* co,int* aqi,int* anomaly,size_t n){
+    const __m256i magic=_mm256_set1_epi32(0x38E38E39);
+    const __m256i t1=_mm256_set1_epi32(99), t2=_mm256_set1_epi32(179);
+    const __m256i zero=_mm256_setzero_si256();
+    size_t i=0;
+    for(;i+8<=n;i+=8){
+        __m256i a=_mm256_loadu_si256((const __m256i*)(pm25+i));
+        __m256i b=_mm256_loadu_si256((const __m256i*)(pm10+i));
+        __m256i c=_mm256_loadu_si256((const __m256i*)(co+i));
+        // pm25*3 + pm10*2 + co*4
+        __m256i x=_mm256_add_epi32(_mm256_add_epi32(a,_mm256_slli_epi32(a,1)),
+                  _mm256_add_epi32(_mm256_slli_epi32(b,1),_mm256_slli_epi32(c,2)));
+
+        __m256i even=_mm256_srli_epi64(_mm256_mul_epi32(x,magic),32);
+        __m256i odd=_mm256_mul_epi32(_mm256_srli_epi64(x,32),magic);
+        __m256i hi=_mm256_blend_epi32(even,odd,0xAA);
+        __m256i q=_mm256_sub_epi32(_mm256_srai_epi32(hi,1),_mm256_srai_epi32(x,31));
+
+        __m256i level=_mm256_sub_epi32(zero,_mm256_add_epi32(_mm256_cmpgt_epi32(q,t1),_mm256_cmpgt_epi32(q,t2)));
+        _mm256_storeu_si256((__m256i*)(aqi+i),q);
+        _mm256_storeu_si256((__m256i*)(anomaly+i),level);
+    }
+    computeBatchScalar(pm25+i,pm10+i,co+i,aqi+i,anomaly+i,n-i);
+}
+
+bool cpuHasAVX2(){
+    static const bool has=__builtin_cpu_supports("avx2");
+    return has;
+}
+
+// aqi/anomaly of n sensors, AVX2 when available, else the scalar kernel
+void computeBatch(const int* pm25,const int* pm10,const int* co,int* aqi,int* anomaly,size_t n){
+    StageTimer timer(StageQuality,n);
+    if(cpuHasAVX2()) computeBatchAVX2(pm25,pm10,co,aqi,anomaly,n);
+    else computeBatchScalar(pm25,pm10,co,aqi,anomaly,n);
+}
+
+// Recomputes aqi/anomaly for the whole store
+void computeBatch(SensorStore& s){
+    computeBatch(s.pm25.data(),s.pm10.data(),s.co.data(),s.aqi.data(),s.anomaly.data(),s.size());
+}
+
+// Loaders and the stream hand sensors to the kernel this many at a time,
+// so every AQI goes through it and a batch stays in L1
+const size_t SensorBatch=256;
+
+// Readings of up to SensorBatch sensors in SoA form, filled as they are
+// parsed
+struct SensorColumns {
+    size_t n=0;
+    int pm25[SensorBatch], pm10[SensorBatch], co[SensorBatch];
+    int aqi[SensorBatch], anomaly[SensorBatch];
+
+    void add(const AirSensor& s){ pm25[n]=s.pm25; pm10[n]=s.pm10; co[n]=s.co; n++; }
+    void compute(){ computeBatch(pm25,pm10,co,aqi,anomaly,n); }
+
+    // Computes the batch into the last n sensors of data and empties it
+    void computeInto(vector<AirSensor>& data){
+        compute();
+        AirSensor* s=data.data()+data.size()-n;
+        for(size_t k=0;k<n;k++){ s[k].aqi=aqi[k]; s[k].anomaly=anomaly[k]; }
+        n=0;
+    }
+};
+
+// Per-sensor AoS loop vs SoA scalar vs SoA AVX2, checked bit for bit
+void benchmarkKernel(size_t n,int reps){
+    vector<AirSensor> aos(n);
+    SensorStore store;
+    uint32_t seed=99;
+    for(size_t i=0;i<n;i++){
+        seed=seed*1664525u+1013904223u;
+        AirSensor& s=aos[i];
+        s.zone=zoneName("Zone"+to_string(i%5000)); s.wind='N';
+        s.pm25=seed%500; s.pm10=(seed>>9)%600; s.co=(seed>>18)%40;
+        s.aqi=s.anomaly=0;
+        store.add(s);
+    }
+    vector<int> refAqi(n),refLevel(n);
+
+    auto t0=chrono::steady_clock::now();
+    for(int r=0;r<reps;r++)
+        for(auto& s:aos){ s.aqi=calculateAQI(s.pm25,s.pm10,s.co); s.anomaly=detectAnomaly(s.aqi); }
+    double aosMs=chrono::duration<double,milli>(chrono::steady_clock::now()-t0).count()/reps;
+
+    t0=chrono::steady_clock::now();
+    for(int r=0;r<reps;r++)
+        computeBatchScalar(store.pm25.data(),store.pm10.data(),store.co.data(),refAqi.data(),refLevel.data(),n);
+    double scalarMs=chrono::duration<double,milli>(chrono::steady_clock::now()-t0).count()/reps;
+
+    double simdMs=0;
+    bool identical=true;
+    if(cpuHasAVX2()){
+        t0=chrono::steady_clock::now();
+        for(int r=0;r<reps;r++) computeBatch(store);
+        simdMs=chrono::duration<double,milli>(chrono::steady_clock::now()-t0).count()/reps;
+    } else computeBatch(store);
+    for(size_t i=0;i<n;i++)
+        if(store.aqi[i]!=refAqi[i] || store.anomaly[i]!=refLevel[i] || aos[i].aqi!=refAqi[i]) identical=false;
+
+    // Edge values, including negatives, through the same kernel
+    int edge[]={0,1,8,9,10,-1,-8,-9,-10,99,100,179,180,181,-100,1000000,-1000000};
+    int ne=sizeof(edge)/sizeof(edge[0]);
+    vector<int> ea,eb,ec,ra(ne*ne),rl(ne*ne),va(ne*ne),vl(ne*ne);
+    for(int x:edge) for(int y:edge){ ea.push_back(x); eb.push_back(y); ec.push_back(x-y); }
+    computeBatchScalar(ea.data(),eb.data(),ec.data(),ra.data(),rl.data(),ea.size());
+    if(cpuHasAVX2()) computeBatchAVX2(ea.data(),eb.data(),ec.data(),va.data(),vl.data(),ea.size());
+    else { va=ra; vl=rl; }
+    if(va!=ra || vl!=rl) identical=false;
+
+    cout<<"bench=aqi_kernel sensors="<<n
+        <<" aos_ms="<<aosMs
+        <<" soa_scalar_ms="<<scalarMs
+        <<" soa_avx2_ms="<<(cpuHasAVX2() ? to_string(simdMs) : string("n/a"))
+        <<" sensors_per_sec="<<(long long)(n/((cpuHasAVX2()?simdMs:scalarMs)/1000.0))
+        <<" bit_identical="<<identical<<endl;
+}
+
 /* ===================== CSV READING ===================== */
 
 vector<AirSensor> readCSV(const string& file) {
     vector<AirSensor> data;
-    ifstream fin(file);
-    string line;
-    getline(fin,line); // skip header
-    while(getline(fin,line)) {
-        stringstream ss(line);
+    MappedCSV fin(file);
+    CSVRow row;
+    if(!fin.isOpen()) { cerr<<"Error opening file: "<<file<<endl; exit(1); }
+    StageTimer timer(StageParse);
+    fin.skipLine(); // skip header
+    data.reserve(fin.estimateRows());
+    SensorColumns batch;
+    while(fin.nextRow(row)) {
         AirSensor s;
-        string temp;
-        getline(ss,s.zone,',');
-        getline(ss,temp,','); s.pm25 = stoi(temp);
-        getline(ss,temp,','); s.pm10 = stoi(temp);
-        getline(ss,temp,','); s.co = stoi(temp);
-        getline(ss,temp,','); s.wind = temp[0];
-        s.aqi = calculateAQI(s.pm25,s.pm10,s.co);
-        s.anomaly = detectAnomaly(s.aqi);
+        s.zone = zoneName(row[0]);
+        s.pm25 = row.toInt(1);
+        s.pm10 = row.toInt(2);
+        s.co = row.toInt(3);
+        s.wind = row[4].empty() ? ' ' : row[4][0];
         data.push_back(s);
+        batch.add(s);
+        if(batch.n==SensorBatch) batch.computeInto(data);
     }
+    batch.computeInto(data);
+    timer.addItems(data.size());
     return data;
 }
 
+/* ===================== COLUMNAR SNAPSHOT ===================== */
+
+// air_sensors.csv as columns: zone (dictionary), pm25/pm10/co (int32), wind (uint8)
+bool writeSnapshot(const vector<AirSensor>& data,const string& file){
+    vector<string> zone; vector<int32_t> pm25,pm10,co; vector<uint8_t> wind;
+    for(auto& s:data){
+        zone.push_back(string(s.zone));
+        pm25.push_back(s.pm25); pm10.push_back(s.pm10); co.push_back(s.co);
+        wind.push_back((uint8_t)s.wind);
+    }
+    SnapshotWriter w(data.size());
+    w.addStrings("zone",zone);
+    w.addInt32("pm25",pm25); w.addInt32("pm10",pm10); w.addInt32("co",co);
+    w.addUInt8("wind",wind);
+    return w.write(file);
+}
+
+bool readSnapshot(const string& file,vector<AirSensor>& data){
+    MappedSnapshot snap;
+    if(!snap.open(file)) return false;
+    StageTimer timer(StageParse,snap.rows());
+    DictColumn zone=snap.dictColumn("zone");
+    const int32_t* pm25=snap.int32Column("pm25");
+    const int32_t* pm10=snap.int32Column("pm10");
+    const int32_t* co=snap.int32Column("co");
+    const uint8_t* wind=snap.uint8Column("wind");
+    if(!zone.codes || !pm25 || !pm10 || !co || !wind) return false;
+
+    // Each distinct zone is copied once; records share its view
+    vector<string_view> names(zone.count);
+    for(uint32_t z=0;z<zone.count;z++) names[z]=zoneName(zone.value(z));
+
+    // The pm columns are already SoA: the kernel reads them in place
+    size_t n=snap.rows();
+    data.resize(n);
+    int aqi[SensorBatch], level[SensorBatch];
+    for(size_t base=0;base<n;base+=SensorBatch){
+        size_t m=min(SensorBatch,n-base);
+        computeBatch(pm25+base,pm10+base,co+base,aqi,level,m);
+        for(size_t k=0;k<m;k++){
+            size_t i=base+k;
+            AirSensor& s=data[i];
+            s.zone=names[zone.codes[i]];
+            s.pm25=pm25[i]; s.pm10=pm10[i]; s.co=co[i]; s.wind=(char)wind[i];
+            s.aqi=aqi[k];
+            s.anomaly=level[k];
+        }
+    }
+    return true;
+}
+
+// Uses <csv>.snap when it is newer than the CSV
+vector<AirSensor> loadSensors(const string& csv){
+    vector<AirSensor> data;
+    if(snapshotIsFresh(csv+".snap",csv) && readSnapshot(csv+".snap",data)) return data;
+    return readCSV(csv);
+}
+
+// CSV parse vs snapshot load vs a single-column scan
+void benchmarkSnapshot(long long rows){
+    const string csv="/tmp/air_bench.csv", snap=csv+".snap";
+    {
+        vector<AirSensor> gen(rows);
+        const char winds[4]={'N','E','S','W'};
+        uint32_t seed=7;
+        FILE* f=fopen(csv.c_str(),"w");
+        if(!f){ cerr<<"Error opening file: "<<csv<<endl; return; }
+        fprintf(f,"Zone,PM25,PM10,CO,Wind\n");
+        for(long long i=0;i<rows;i++){
+            seed=seed*1664525u+1013904223u;
+            AirSensor& s=gen[i];
+            s.zone=zoneName("Zone"+to_string(seed%20000));
+            s.pm25=seed%400; s.pm10=(seed>>8)%450; s.co=(seed>>16)%15; s.wind=winds[(seed>>20)%4];
+            fprintf(f,"%s,%d,%d,%d,%c\n",string(s.zone).c_str(),s.pm25,s.pm10,s.co,s.wind);
+        }
+        fclose(f);
+        writeSnapshot(gen,snap);
+    }
+
+    auto t0=chrono::steady_clock::now();
+    vector<AirSensor> a=readCSV(csv);
+    double csvMs=chrono::duration<double,milli>(chrono::steady_clock::now()-t0).count();
+
+    t0=chrono::steady_clock::now();
+    vector<AirSensor> b;
+    readSnapshot(snap,b);
+    double snapMs=chrono::duration<double,milli>(chrono::steady_clock::now()-t0).count();
+
+    t0=chrono::steady_clock::now();
+    MappedSnapshot m;
+    m.open(snap);
+    const int32_t* pm25=m.int32Column("pm25");
+    long long sum=0;
+    for(uint64_t i=0;i<m.rows();i++) sum+=pm25[i];
+    double scanMs=chrono::duration<double,milli>(chrono::steady_clock::now()-t0).count();
+
+    cout<<"bench=snapshot rows="<<rows
+        <<" csv_load_ms="<<csvMs
+        <<" snapshot_load_ms="<<snapMs
+        <<" pm25_scan_ms="<<scanMs
+        <<" match="<<(a.size()==b.size() && (a.empty() || (a.back().zone==b.back().zone && a.back().aqi==b.back().aqi)))
+        <<" checksum="<<sum<<endl;
+    remove(csv.c_str());
+    remove(snap.c_str());
+}
+
 /* ===================== SORTING ===================== */
 
 int partition(vector<AirSensor>& a,int low,int high){
@@ -79,6 +355,129 @@ void quickSort(vector<AirSensor>& a,int low,int high){
     }
 }
 
+/* ===================== TOP-K RANKING ===================== */
+
+// Indexed max-heap of sensor ids keyed by AQI (ties: lower id first).
+// pos[] tracks each sensor's heap slot, so a changed reading is moved
+// in O(log n) and the worst k zones are read without sorting anything.
+class AQIRanking{
+public:
+    void build(const vector<AirSensor>& s){
+        int n=s.size();
+        StageTimer timer(StageSort,n);
+        key.resize(n); heap.resize(n); pos.resize(n);
+        for(int i=0;i<n;i++){ key[i]=s[i].aqi; heap[i]=i; pos[i]=i; }
+        for(int i=n/2-1;i>=0;i--) siftDown(i);
+    }
+
+    // New sensors get the next id (ids match the sensors vector)
+    void update(int sensor,int aqi){
+        if(sensor==(int)key.size()){
+            key.push_back(aqi); heap.push_back(sensor); pos.push_back(heap.size()-1);
+            siftUp(pos[sensor]);
+            return;
+        }
+        int old=key[sensor];
+        key[sensor]=aqi;
+        if(aqi>old) siftUp(pos[sensor]);
+        else if(aqi<old) siftDown(pos[sensor]);
+    }
+
+    // Worst k sensors, highest AQI first. Walks the heap from the root
+    // with a small frontier queue: O(k log k), the heap is not modified.
+    vector<int> topK(int k) const{
+        vector<int> out;
+        if(heap.empty() || k<=0) return out;
+        auto worse=[this](int a,int b){ return !above(heap[a],heap[b]); };
+        priority_queue<int,vector<int>,decltype(worse)> frontier(worse);
+        frontier.push(0);
+        while(!frontier.empty() && (int)out.size()<k){
+            int slot=frontier.top(); frontier.pop();
+            out.push_back(heap[slot]);
+            if(2*slot+1<(int)heap.size()) frontier.push(2*slot+1);
+            if(2*slot+2<(int)heap.size()) frontier.push(2*slot+2);
+        }
+        return out;
+    }
+
+    int size() const { return heap.size(); }
+
+private:
+    vector<int> heap, pos, key;
+
+    bool above(int a,int b) const { return key[a]>key[b] || (key[a]==key[b] && a<b); }
+    void place(int slot,int sensor){ heap[slot]=sensor; pos[sensor]=slot; }
+
+    void siftUp(int i){
+        int x=heap[i];
+        while(i>0){
+            int parent=(i-1)/2;
+            if(!above(x,heap[parent])) break;
+            place(i,heap[parent]);
+            i=parent;
+        }
+        place(i,x);
+    }
+    void siftDown(int i){
+        int n=heap.size(), x=heap[i];
+        for(;;){
+            int best=2*i+1;
+            if(best>=n) break;
+            if(best+1<n && above(heap[best+1],heap[best])) best++;
+            if(!above(heap[best],x)) break;
+            place(i,heap[best]);
+            i=best;
+        }
+        place(i,x);
+    }
+};
+
+// Ranking updates vs re-running quickSort per update, on calm-weather
+// data where most readings share a handful of AQI values
+void benchmarkRanking(int n,int updates){
+    vector<AirSensor> s(n);
+    uint32_t seed=3;
+    auto rnd=[&seed](){ seed=seed*1664525u+1013904223u; return seed>>8; };
+    for(int i=0;i<n;i++){ s[i].zone=zoneName("Zone"+to_string(i)); s[i].wind='N'; s[i].aqi=40+rnd()%4; s[i].anomaly=0; }
+
+    AQIRanking r;
+    auto t0=chrono::steady_clock::now();
+    r.build(s);
+    double buildMs=chrono::duration<double,milli>(chrono::steady_clock::now()-t0).count();
+
+    t0=chrono::steady_clock::now();
+    long long check=0;
+    for(int u=0;u<updates;u++){
+        int i=rnd()%n;
+        s[i].aqi=40+rnd()%200;
+        r.update(i,s[i].aqi);
+        if(u%100==0) check+=r.topK(10)[0];
+    }
+    double perUpdateUs=chrono::duration<double,micro>(chrono::steady_clock::now()-t0).count()/updates;
+
+    t0=chrono::steady_clock::now();
+    vector<int> top=r.topK(10);
+    double topUs=chrono::duration<double,micro>(chrono::steady_clock::now()-t0).count();
+
+    // quickSort is quadratic on equal keys, so time it on a copy of a
+    // smaller prefix only
+    int m=min(n,20000);
+    vector<AirSensor> calm(s.begin(),s.begin()+m);
+    for(auto& x:calm) x.aqi=40+rnd()%4;
+    t0=chrono::steady_clock::now();
+    quickSort(calm,0,m-1);
+    double sortMs=chrono::duration<double,milli>(chrono::steady_clock::now()-t0).count();
+
+    bool ok=true;
+    for(size_t k=1;k<top.size();k++) if(s[top[k]].aqi>s[top[k-1]].aqi) ok=false;
+    cout<<"bench=topk_ranking sensors="<<n
+        <<" build_ms="<<buildMs
+        <<" update_us="<<perUpdateUs
+        <<" top10_us="<<topUs
+        <<" quicksort_calm_"<<m<<"_ms="<<sortMs
+        <<" ordered="<<ok<<" checksum="<<check<<endl;
+}
+
 /* ===================== WIND TRANSFER ===================== */
 
 int windTransfer(char w1,char w2){
@@ -96,33 +495,46 @@ public:
     Graph(int v): V(v), adj(v) {}
     void addEdge(int u,int v){adj[u].push_back(v); adj[v].push_back(u);}
 
-    void DFSUtil(int u,int pollution, vector<bool>& visited, vector<AirSensor>& s){
-        visited[u]=true;
-        cout<<s[u].zone<<" ("<<pollution<<"%) -> ";
-        for(int v:adj[u]){
-            int nextPollution = pollution*windTransfer(s[u].wind,s[v].wind)/100;
-            if(!visited[v] && nextPollution>30)
-                DFSUtil(v,nextPollution,visited,s);
-        }
-    }
+    // Traversals return the (zone, pollution %) chain in visiting order and
+    // leave printing to DFS/BFS, so benchmarks time the walk on its own.
 
-    void DFS(int src, vector<AirSensor>& s){
+    // Same visiting order as the recursive version, but with an explicit
+    // stack of (zone, pollution, next neighbour) so long chains cannot
+    // overflow the call stack
+    vector<pair<int,int>> dfsChain(int src,const vector<AirSensor>& s) const{
+        StageTimer timer(StageSearch,V);
+        struct Frame { int u, pollution; size_t next; };
+        vector<pair<int,int>> chain;
         vector<bool> visited(V,false);
-        cout<<"\nDFS Pollution Chain:\n";
-        DFSUtil(src,100,visited,s);
-        cout<<"END\n";
+        vector<Frame> stack;
+        visited[src]=true;
+        chain.push_back({src,100});
+        stack.push_back({src,100,0});
+        while(!stack.empty()){
+            Frame& f=stack.back();
+            if(f.next==adj[f.u].size()){ stack.pop_back(); continue; }
+            int u=f.u, v=adj[u][f.next++];
+            int nextPollution = f.pollution*windTransfer(s[u].wind,s[v].wind)/100;
+            if(!visited[v] && nextPollution>30){
+                visited[v]=true;
+                chain.push_back({v,nextPollution});
+                stack.push_back({v,nextPollution,0});
+            }
+        }
+        return chain;
     }
 
-    void BFS(int src, vector<AirSensor>& s){
+    vector<pair<int,int>> bfsChain(int src,const vector<AirSensor>& s) const{
+        StageTimer timer(StageSearch,V);
+        vector<pair<int,int>> chain;
         vector<bool> visited(V,false);
         vector<int> pollution(V,0);
         queue<int> q;
         visited[src]=true; pollution[src]=100;
         q.push(src);
-        cout<<"\nBFS Pollution Spread:\n";
         while(!q.empty()){
             int u = q.front(); q.pop();
-            cout<<s[u].zone<<" ("<<pollution[u]<<"%) -> ";
+            chain.push_back({u,pollution[u]});
             for(int v:adj[u]){
                 int nextPollution = pollution[u]*windTransfer(s[u].wind,s[v].wind)/100;
                 if(!visited[v] && nextPollution>30){
@@ -132,50 +544,476 @@ public:
                 }
             }
         }
+        return chain;
+    }
+
+    static void printChain(const char* title,const vector<pair<int,int>>& chain,const vector<AirSensor>& s){
+        cout<<"\n"<<title<<":\n";
+        for(auto& h:chain) cout<<s[h.first].zone<<" ("<<h.second<<"%) -> ";
         cout<<"END\n";
     }
+
+    void DFS(int src, vector<AirSensor>& s){ printChain("DFS Pollution Chain",dfsChain(src,s),s); }
+    void BFS(int src, vector<AirSensor>& s){ printChain("BFS Pollution Spread",bfsChain(src,s),s); }
 };
 
+/* ===================== DISPERSION SIMULATION ===================== */
+
+// City area as a graph of cells in CSR form. Each step a cell keeps
+// keep[v] of its concentration and receives inCoef[k] * c[inFrom[k]]
+// over its in-links; out-links are only used to grow the frontier.
+struct DispersionGrid {
+    int cells=0;
+    vector<int> inStart, inFrom;
+    vector<float> inCoef;
+    vector<int> outStart, outTo;
+    vector<float> keep;
+};
+
+// width x height cells, one wind letter per cell. A cell sends `spread`
+// of its load to its four neighbours in proportion to windTransfer()
+// between its wind and the neighbour's direction (downwind 100, cross
+// wind 50, otherwise 20); shares pointing off the map leave the city.
+// Every cell also loses `decay` per step.
+DispersionGrid buildGridCity(int width,int height,const vector<char>& wind,float spread,float decay){
+    DispersionGrid g;
+    int n=width*height;
+    g.cells=n;
+    const int dx[4]={1,-1,0,0}, dy[4]={0,0,-1,1};
+    const char dir[4]={'E','W','N','S'};
+
+    g.keep.assign(n,(1-spread)*(1-decay));
+    g.outStart.assign(n+1,0);
+    vector<int> from,to; vector<float> coef;
+    from.reserve(4*n); to.reserve(4*n); coef.reserve(4*n);
+    for(int v=0;v<n;v++){
+        int x=v%width, y=v/width;
+        float total=0;
+        for(int d=0;d<4;d++) total+=windTransfer(wind[v],dir[d]);
+        for(int d=0;d<4;d++){
+            int nx=x+dx[d], ny=y+dy[d];
+            if(nx<0 || ny<0 || nx>=width || ny>=height) continue;
+            from.push_back(v); to.push_back(ny*width+nx);
+            coef.push_back(spread*(1-decay)*windTransfer(wind[v],dir[d])/total);
+            g.outStart[v+1]++;
+        }
+    }
+    for(int v=0;v<n;v++) g.outStart[v+1]+=g.outStart[v];
+    g.outTo=to;
+
+    g.inStart.assign(n+1,0);
+    for(size_t e=0;e<to.size();e++) g.inStart[to[e]+1]++;
+    for(int v=0;v<n;v++) g.inStart[v+1]+=g.inStart[v];
+    g.inFrom.resize(to.size()); g.inCoef.resize(to.size());
+    vector<int> fill(g.inStart.begin(),g.inStart.end()-1);
+    for(size_t e=0;e<to.size();e++){
+        int k=fill[to[e]]++;
+        g.inFrom[k]=from[e]; g.inCoef[k]=coef[e];
+    }
+    return g;
+}
+
+// Runs fn(thread,begin,end) over [0,n) split across threads
+template<class F> void parallelRanges(size_t n,int threads,F fn){
+    if(threads<=1 || n<4096){ fn(0,(size_t)0,n); return; }
+    vector<thread> pool;
+    for(int t=1;t<threads;t++) pool.emplace_back(fn,t,n*t/threads,n*(t+1)/threads);
+    fn(0,(size_t)0,n/threads);
+    for(auto& th:pool) th.join();
+}
+
+// Frontier-based, pull-style simulation: each step only visits cells
+// that hold pollution or border one. Every visited cell writes only its
+// own value, so the step parallelises without atomics on concentrations;
+// no recursion and no output inside the loop. Once the plume covers a
+// large part of the city the frontier bookkeeping costs more than it
+// saves, so the step falls back to a dense sweep over every cell.
+class DispersionSimulator{
+public:
+    DispersionSimulator(const DispersionGrid& grid,int threads,float eps=1e-3f)
+        : g(grid), threadCount(max(threads,1)), epsilon(eps), stepNo(0),
+          cur(grid.cells,0), next(grid.cells,0), emission(grid.cells,0), mark(grid.cells,-1) {}
+
+    // Adds a constant source (concentration units per step)
+    void setSource(int cell,float rate){
+        if(emission[cell]==0 && rate>0) sources.push_back(cell);
+        emission[cell]=rate;
+    }
+
+    void step(){
+        stepNo++;
+        vector<vector<int>> parts(threadCount);
+        size_t seedCount=activeCount+sources.size();
+
+        if(seedCount*5>(size_t)g.cells/4){
+            // Dense sweep: every cell is rewritten, so nothing stale
+            // survives; the loaded cells are only counted, not listed
+            vector<size_t> counts(threadCount,0);
+            parallelRanges(g.cells,threadCount,[&](int t,size_t b,size_t e){
+                size_t n=0;
+                for(size_t v=b;v<e;v++){
+                    float c=relax(v);
+                    next[v]=c;
+                    n+=c>0;
+                }
+                counts[t]=n;
+            });
+            staleListed=activeListed;
+            stale.swap(active);
+            activeListed=false;
+            activeCount=0;
+            for(size_t n:counts) activeCount+=n;
+            cur.swap(next);
+            return;
+        }
+
+        if(!activeListed){
+            // Leaving dense mode: list the loaded cells once
+            active.clear();
+            for(int v=0;v<g.cells;v++) if(cur[v]>0) active.push_back(v);
+            activeListed=true;
+        }
+
+        // Frontier = cells with load, their out-neighbours and all sources
+        vector<int> seeds=active;
+        seeds.insert(seeds.end(),sources.begin(),sources.end());
+        int stamp=stepNo;
+        parallelRanges(seeds.size(),threadCount,[&](int t,size_t b,size_t e){
+            vector<int>& out=parts[t];
+            for(size_t i=b;i<e;i++){
+                int u=seeds[i];
+                claim(u,stamp,out);
+                for(int k=g.outStart[u];k<g.outStart[u+1];k++) claim(g.outTo[k],stamp,out);
+            }
+        });
+        vector<int> frontier;
+        for(auto& p:parts){ frontier.insert(frontier.end(),p.begin(),p.end()); p.clear(); }
+
+        // The write buffer still holds the state from two steps ago;
+        // its loaded cells that fall outside this frontier must read as zero
+        if(staleListed){ for(int v:stale) if(mark[v]!=stamp) next[v]=0; }
+        else parallelRanges(g.cells,threadCount,[&](int,size_t b,size_t e){
+            for(size_t v=b;v<e;v++) if(mark[v]!=stamp) next[v]=0;
+        });
+
+        parallelRanges(frontier.size(),threadCount,[&](int t,size_t b,size_t e){
+            vector<int>& out=parts[t];
+            for(size_t i=b;i<e;i++){
+                int v=frontier[i];
+                float c=relax(v);
+                next[v]=c;
+                if(c>0) out.push_back(v);
+            }
+        });
+
+        stale.swap(active);
+        staleListed=true;
+        active.clear();
+        for(auto& p:parts) active.insert(active.end(),p.begin(),p.end());
+        activeCount=active.size();
+        cur.swap(next);
+    }
+
+    void run(int steps){ for(int i=0;i<steps;i++) step(); }
+
+    const vector<float>& concentration() const { return cur; }
+    size_t activeCells() const { return activeCount; }
+
+private:
+    const DispersionGrid& g;
+    int threadCount;
+    float epsilon;
+    int stepNo;
+    vector<float> cur, next, emission;
+    vector<int> mark;               // step that last put the cell in the frontier
+    vector<int> sources;
+    vector<int> active;             // cells with load in cur
+    vector<int> stale;              // cells with load in next (two steps old)
+    size_t activeCount=0;
+    bool activeListed=true, staleListed=true;   // false after a dense sweep
+
+    float relax(size_t v) const {
+        float c=g.keep[v]*cur[v]+emission[v];
+        for(int k=g.inStart[v];k<g.inStart[v+1];k++) c+=g.inCoef[k]*cur[g.inFrom[k]];
+        return c<epsilon ? 0 : c;
+    }
+    void claim(int v,int stamp,vector<int>& out){
+        if(__atomic_exchange_n(&mark[v],stamp,__ATOMIC_RELAXED)!=stamp) out.push_back(v);
+    }
+};
+
+// Forecast on a side x side grid: wind bands from the CSV sensors,
+// one source per sensor plus `extraSources` random ones, 10 s steps
+void benchmarkDispersion(int side,int minutes,int extraSources){
+    const char winds[4]={'E','N','W','S'};
+    vector<char> wind(side*side);
+    for(int v=0;v<side*side;v++) wind[v]=winds[(v%side)*4/side];
+    int threads=max(1u,thread::hardware_concurrency());
+
+    auto t0=chrono::steady_clock::now();
+    DispersionGrid g=buildGridCity(side,side,wind,0.4f,0.002f);
+    double buildMs=chrono::duration<double,milli>(chrono::steady_clock::now()-t0).count();
+
+    DispersionSimulator sim(g,threads);
+    uint32_t seed=17;
+    for(int i=0;i<extraSources;i++){
+        seed=seed*1664525u+1013904223u;
+        sim.setSource(seed%(side*side),50.0f+seed%200);
+    }
+    int steps=minutes*6;
+    t0=chrono::steady_clock::now();
+    sim.run(steps);
+    double sec=chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+
+    double total=0, peak=0;
+    for(float c:sim.concentration()){ total+=c; peak=max(peak,(double)c); }
+    cout<<"bench=dispersion cells="<<side*side
+        <<" sources="<<extraSources
+        <<" threads="<<threads
+        <<" steps="<<steps
+        <<" build_ms="<<buildMs
+        <<" forecast_s="<<sec
+        <<" ms_per_step="<<sec*1000/steps
+        <<" active_cells="<<sim.activeCells()
+        <<" peak="<<peak<<" total_load="<<total<<endl;
+}
+
+// Forecast for the CSV zones: each zone owns a vertical band of the
+// grid with its own wind and a source at the band centre scaled by AQI
+void forecastZones(vector<AirSensor>& s,int side,int minutes){
+    int z=s.size();
+    if(z==0) return;
+    vector<char> wind(side*side);
+    for(int v=0;v<side*side;v++) wind[v]=s[(v%side)*z/side].wind;
+    DispersionGrid g=buildGridCity(side,side,wind,0.4f,0.002f);
+    DispersionSimulator sim(g,max(1u,thread::hardware_concurrency()));
+    for(int i=0;i<z;i++){
+        int x=(2*i+1)*side/(2*z);
+        sim.setSource((side/2)*side+x,s[i].aqi/10.0f);
+    }
+    sim.run(minutes*6);
+
+    const vector<float>& c=sim.concentration();
+    cout<<"\nDispersion forecast ("<<minutes<<" min, "<<side<<"x"<<side<<" grid):\n";
+    for(int i=0;i<z;i++){
+        double sum=0, peak=0;
+        int cells=0;
+        for(int y=0;y<side;y++)
+            for(int x=i*side/z;x<(i+1)*side/z;x++){ sum+=c[y*side+x]; peak=max(peak,(double)c[y*side+x]); cells++; }
+        cout<<s[i].zone<<" | Mean: "<<sum/max(cells,1)<<" | Peak: "<<peak<<endl;
+    }
+}
+
 /* ===================== BELLMAN-FORD ===================== */
 
-void bellmanFord(int src,int V,vector<Edge>& edges,vector<AirSensor>& s,vector<bool>& blocked){
-    vector<int> dist(V,INT_MAX);
-    dist[src]=0;
+// Zones blocked for routing: anomaly-2 zones that some link enters, as
+// the pass-based Bellman-Ford marked them, but decided before any path
+// search so the result never depends on edge order. The source is never
+// blocked; routing starts where the vehicle already is.
+vector<bool> blockedZones(const vector<AirSensor>& s,const vector<Edge>& edges,int src){
+    StageTimer timer(StageAlerts,s.size());
+    vector<bool> blocked(s.size(),false);
+    for(auto& e:edges) if(e.to!=src && s[e.to].anomaly==2) blocked[e.to]=true;
+    return blocked;
+}
+
+// Edge cost including the anomaly penalty of the zone it enters
+int anomalyCost(const Edge& e,const vector<int>& anomaly){
+    int penalty=0;
+    if(anomaly[e.to]==1) penalty=-20;
+    if(anomaly[e.to]==2) penalty=-50;
+    return e.weight+penalty;
+}
+
+struct SpreadResult {
+    vector<long long> dist;     // LLONG_MAX = unreachable
+    vector<int> parent;
+    vector<int> cycle;          // zone loop, first zone repeated at the end; empty if none
+    long long relaxations=0;
+};
+
+// Any loop in the parent pointers is a negative cycle. Returns a zone on
+// it, or -1. O(V): each zone is walked at most once.
+int parentCycle(const vector<int>& parent){
+    int V=parent.size();
+    vector<int> seen(V,-1);
+    for(int s=0;s<V;s++){
+        int v=s;
+        while(v>=0 && seen[v]<0){ seen[v]=s; v=parent[v]; }
+        if(v>=0 && seen[v]==s) return v;
+    }
+    return -1;
+}
+
+// Queue-based Bellman-Ford (SPFA). Only zones whose distance changed are
+// rescanned, and the search stops as soon as the queue drains. Every V
+// relaxations the parent pointers are checked for a loop, so a negative
+// cycle is reported long before it has been walked V times; the loop is
+// returned instead of distances.
+SpreadResult spfa(int src,int V,const vector<Edge>& edges,const vector<int>& anomaly){
+    StageTimer timer(StageSearch,V);
+    // CSR out-edges with the penalties already applied
+    vector<int> start(V+1,0), to(edges.size()), cost(edges.size());
+    for(auto& e:edges) start[e.from+1]++;
+    for(int v=0;v<V;v++) start[v+1]+=start[v];
+    vector<int> fill(start.begin(),start.end()-1);
+    for(auto& e:edges){ int k=fill[e.from]++; to[k]=e.to; cost[k]=anomalyCost(e,anomaly); }
 
-    for(int i=0;i<V-1;i++){
-        for(auto &e:edges){
-            int penalty=0;
-            if(s[e.to].anomaly==1) penalty=-20;
-            if(s[e.to].anomaly==2) { penalty=-50; blocked[e.to]=true;}
-            if(dist[e.from]!=INT_MAX && dist[e.from]+e.weight+penalty<dist[e.to])
-                dist[e.to]=dist[e.from]+e.weight+penalty;
+    SpreadResult r;
+    r.dist.assign(V,LLONG_MAX);
+    r.parent.assign(V,-1);
+    vector<char> queued(V,0);
+    vector<int> q(V);                       // ring buffer, at most V zones queued
+    size_t head=0, tail=0, size=0;
+    r.dist[src]=0;
+    q[tail++]=src; size=1; queued[src]=1;
+
+    int onCycle=-1;
+    while(size && onCycle<0){
+        int u=q[head]; head= head+1==(size_t)V ? 0 : head+1; size--;
+        queued[u]=0;
+        for(int k=start[u];k<start[u+1];k++){
+            int v=to[k];
+            long long d=r.dist[u]+cost[k];
+            if(d>=r.dist[v]) continue;
+            r.dist[v]=d; r.parent[v]=u;
+            if(++r.relaxations%V==0 && (onCycle=parentCycle(r.parent))>=0) break;
+            if(!queued[v]){
+                queued[v]=1;
+                q[tail]=v; tail= tail+1==(size_t)V ? 0 : tail+1; size++;
+            }
         }
     }
 
+    if(onCycle>=0){
+        vector<int> loop;
+        int v=onCycle;
+        do { loop.push_back(v); v=r.parent[v]; } while(v!=onCycle);
+        loop.push_back(onCycle);
+        reverse(loop.begin(),loop.end());
+        r.cycle=loop;
+    }
+    return r;
+}
+
+void bellmanFord(int src,int V,vector<Edge>& edges,vector<AirSensor>& s,const vector<bool>& blocked){
+    vector<int> anomaly(V);
+    for(int i=0;i<V;i++) anomaly[i]=s[i].anomaly;
+    SpreadResult r=spfa(src,V,edges,anomaly);
+
     cout<<"\nBellman-Ford (Anomaly Spread Analysis):\n";
+    if(!r.cycle.empty()){
+        cout<<"Negative cycle: ";
+        for(size_t i=0;i<r.cycle.size();i++) cout<<s[r.cycle[i]].zone<<(i+1<r.cycle.size() ? " -> " : "\n");
+        return;
+    }
     for(int i=0;i<V;i++){
         if(blocked[i]) cout<<s[i].zone<<" = BLOCKED\n";
-        else cout<<s[src].zone<<" -> "<<s[i].zone<<" = "<<dist[i]<<endl;
+        else if(r.dist[i]==LLONG_MAX) cout<<s[src].zone<<" -> "<<s[i].zone<<" = "<<INT_MAX<<endl;
+        else cout<<s[src].zone<<" -> "<<s[i].zone<<" = "<<r.dist[i]<<endl;
+    }
+}
+
+// Classic V-1 full passes over the edge list, kept as the baseline
+vector<long long> bellmanFordPasses(int src,int V,const vector<Edge>& edges,const vector<int>& anomaly){
+    vector<long long> dist(V,LLONG_MAX);
+    dist[src]=0;
+    for(int i=0;i<V-1;i++)
+        for(auto& e:edges)
+            if(dist[e.from]!=LLONG_MAX && dist[e.from]+anomalyCost(e,anomaly)<dist[e.to])
+                dist[e.to]=dist[e.from]+anomalyCost(e,anomaly);
+    return dist;
+}
+
+// Random city of n zones, `degree` links each, ~10% anomaly 1 and
+// ~2% anomaly 2; base costs are large enough that no loop goes negative
+void randomZoneGraph(int n,int degree,uint32_t seed,vector<Edge>& edges,vector<int>& anomaly){
+    anomaly.assign(n,0);
+    edges.clear();
+    for(int v=0;v<n;v++){
+        seed=seed*1664525u+1013904223u;
+        int r=seed%100;
+        anomaly[v]= r<2 ? 2 : r<12 ? 1 : 0;
     }
+    for(int u=0;u<n;u++)
+        for(int d=0;d<degree;d++){
+            seed=seed*1664525u+1013904223u;
+            int v= d==0 ? (u+1)%n : (int)(seed%n);
+            edges.push_back({u,v,60+(int)(seed>>16)%100});
+        }
+}
+
+void benchmarkSpfa(int n){
+    vector<Edge> edges; vector<int> anomaly;
+    randomZoneGraph(n,4,7,edges,anomaly);
+
+    auto t0=chrono::steady_clock::now();
+    SpreadResult r=spfa(0,n,edges,anomaly);
+    double spfaMs=chrono::duration<double,milli>(chrono::steady_clock::now()-t0).count();
+    long long reached=0;
+    for(long long d:r.dist) reached+= d!=LLONG_MAX;
+
+    // Baseline only where V-1 passes finish in reasonable time
+    int small=min(n,3000);
+    vector<Edge> se; vector<int> sa;
+    randomZoneGraph(small,4,7,se,sa);
+    t0=chrono::steady_clock::now();
+    vector<long long> ref=bellmanFordPasses(0,small,se,sa);
+    double passMs=chrono::duration<double,milli>(chrono::steady_clock::now()-t0).count();
+    t0=chrono::steady_clock::now();
+    SpreadResult sr=spfa(0,small,se,sa);
+    double smallMs=chrono::duration<double,milli>(chrono::steady_clock::now()-t0).count();
+
+    // Same graph with one loop made negative: time until it is reported
+    edges.push_back({n/2,n/3,-1000});
+    edges.push_back({n/3,n/2,-1000});
+    t0=chrono::steady_clock::now();
+    SpreadResult cr=spfa(0,n,edges,anomaly);
+    double cycleMs=chrono::duration<double,milli>(chrono::steady_clock::now()-t0).count();
+
+    cout<<"bench=spfa zones="<<n
+        <<" edges="<<edges.size()-2
+        <<" spfa_ms="<<spfaMs
+        <<" relaxations="<<r.relaxations
+        <<" reached="<<reached
+        <<" cycle_detect_ms="<<cycleMs
+        <<" cycle_len="<<(cr.cycle.empty() ? 0 : cr.cycle.size()-1)
+        <<" baseline_zones="<<small
+        <<" baseline_passes_ms="<<passMs
+        <<" baseline_spfa_ms="<<smallMs
+        <<" baseline_match="<<(ref==sr.dist ? "yes" : "no")<<endl;
 }
 
 /* ===================== DIJKSTRA AVOIDING BLOCKED ZONES ===================== */
 
-void dijkstraAvoidingZones(int src,int n,vector<vector<pair<int,int>>>& adj,vector<bool>& blocked,vector<string>& zones){
+// Distances from src over routes that never enter a blocked zone;
+// INT_MAX = unreachable
+vector<int> dijkstraDistances(int src,int n,const vector<vector<pair<int,int>>>& adj,const vector<bool>& blocked){
+    StageTimer timer(StageSearch,n);
     vector<int> dist(n,INT_MAX);
     priority_queue<pair<int,int>,vector<pair<int,int>>,greater<>> pq;
-    if(blocked[src]) {cout<<"Source zone blocked. Routing aborted.\n"; return;}
     dist[src]=0;
     pq.push({0,src});
 
+    // Settle each zone once: the -10 link makes a negative loop, and
+    // re-expanding zones would keep lowering dist until int overflow
+    vector<bool> settled(n,false);
     while(!pq.empty()){
         int u=pq.top().second; pq.pop();
+        if(settled[u]) continue;
+        settled[u]=true;
         for(auto edge:adj[u]){
             int v=edge.first; int w=edge.second;
-            if(blocked[v]) continue;
+            if(blocked[v] || settled[v]) continue;
             if(dist[u]+w<dist[v]) { dist[v]=dist[u]+w; pq.push({dist[v],v}); }
         }
     }
+    return dist;
+}
+
+void dijkstraAvoidingZones(int src,int n,vector<vector<pair<int,int>>>& adj,vector<bool>& blocked,vector<string_view>& zones){
+    if(blocked[src]) {cout<<"Source zone blocked. Routing aborted.\n"; return;}
+    vector<int> dist=dijkstraDistances(src,n,adj,blocked);
 
     cout<<"\nDijkstra (Avoiding Polluted Zones):\n";
     for(int i=0;i<n;i++){
@@ -185,6 +1023,309 @@ void dijkstraAvoidingZones(int src,int n,vector<vector<pair<int,int>>>& adj,vect
     }
 }
 
+/* ===================== STREAMING INGESTION ===================== */
+
+// One reading per line, same columns as air_sensors.csv plus an optional
+// producer timestamp (ns since epoch) used to measure alert latency:
+//   zone,pm25,pm10,co,wind[,timestamp_ns]
+struct ReadingView {
+    const char* zone;
+    int zoneLen;
+    int pm25, pm10, co;
+    char wind;
+    long long timestamp; // 0 when absent
+};
+
+// Parses one line in [p,end) without allocating. Returns false on a
+// malformed line (header lines fail on the first number).
+bool parseReading(const char* p,const char* end,ReadingView& r){
+    const char* comma=(const char*)memchr(p,',',end-p);
+    if(!comma) return false;
+    r.zone=p; r.zoneLen=(int)(comma-p);
+    p=comma+1;
+
+    int* fields[3]={&r.pm25,&r.pm10,&r.co};
+    for(int f=0;f<3;f++){
+        if(p>=end || *p<'0' || *p>'9') return false;
+        int v=0;
+        while(p<end && *p>='0' && *p<='9') v=v*10+(*p++-'0');
+        *fields[f]=v;
+        if(p>=end || *p!=',') return false;
+        p++;
+    }
+    if(p>=end) return false;
+    r.wind=*p++;
+    r.timestamp=0;
+    if(p<end && *p==','){
+        p++;
+        while(p<end && *p>='0' && *p<='9') r.timestamp=r.timestamp*10+(*p++-'0');
+    }
+    return true;
+}
+
+// Open-addressing zone name -> sensor index table. Keys are not copied:
+// slots point at the sensors, whose names live in the zone arena.
+class ZoneLookup{
+public:
+    explicit ZoneLookup(const vector<AirSensor>& s): sensors(s) { rebuild(); }
+
+    void rebuild(){
+        size_t cap=16;
+        while(cap<sensors.size()*2) cap<<=1;
+        slots.assign(cap,-1);
+        for(size_t i=0;i<sensors.size();i++) place((int)i);
+    }
+
+    // Sensor i was just appended. The table doubles only when it would
+    // pass half full, so a stream of new zones costs O(1) amortized each.
+    void added(int i){
+        if(sensors.size()*2>slots.size()) rebuild();
+        else place(i);
+    }
+
+    int find(const char* name,int len) const{
+        size_t mask=slots.size()-1;
+        size_t h=hashOf(name,len)&mask;
+        while(slots[h]!=-1){
+            // An empty zone's view has no data pointer, so compare views
+            // rather than memcmp on it
+            if(sensors[slots[h]].zone==string_view(name,len)) return slots[h];
+            h=(h+1)&mask;
+        }
+        return -1;
+    }
+
+private:
+    const vector<AirSensor>& sensors;
+    vector<int> slots;
+
+    void place(int i){
+        size_t mask=slots.size()-1;
+        string_view z=sensors[i].zone;
+        size_t h=hashOf(z.data(),z.size())&mask;
+        while(slots[h]!=-1) h=(h+1)&mask;
+        slots[h]=i;
+    }
+
+    static size_t hashOf(const char* p,size_t len){
+        uint64_t h=1469598103934665603ULL; // FNV-1a
+        for(size_t i=0;i<len;i++){ h^=(unsigned char)p[i]; h*=1099511628211ULL; }
+        return (size_t)h;
+    }
+};
+
+struct StreamStats {
+    long long readings=0, malformed=0, alerts=0;
+    long long latencyBuckets[64]={0}; // log2(ns) histogram of alert latency
+    long long latencyCount=0;
+
+    void recordLatency(long long ns){
+        if(ns<1) ns=1;
+        latencyBuckets[63-__builtin_clzll((unsigned long long)ns)]++;
+        latencyCount++;
+    }
+    // Upper bound of the bucket holding quantile q
+    long long latencyQuantile(double q) const{
+        long long need=(long long)(q*latencyCount), seen=0;
+        for(int b=0;b<64;b++){
+            seen+=latencyBuckets[b];
+            if(seen>need) return 2LL<<b;
+        }
+        return 0;
+    }
+};
+
+long long nowNs(){
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Parsed readings waiting for the batch kernel, in arrival order, with
+// the sensor, wind and producer timestamp of each
+struct ReadingBatch : SensorColumns {
+    int sensor[SensorBatch];
+    char wind[SensorBatch];
+    long long timestamp[SensorBatch];
+
+    size_t size() const { return n; }
+    void add(int i,const ReadingView& r){
+        sensor[n]=i; pm25[n]=r.pm25; pm10[n]=r.pm10; co[n]=r.co;
+        wind[n]=r.wind; timestamp[n]=r.timestamp;
+        n++;
+    }
+};
+
+// Sensor a reading goes to. New zones are appended.
+int sensorFor(const ReadingView& r,vector<AirSensor>& sensors,ZoneLookup& lookup){
+    int i=lookup.find(r.zone,r.zoneLen);
+    if(i<0){
+        AirSensor s;
+        s.zone=zoneName(string_view(r.zone,r.zoneLen));
+        s.anomaly=0;
+        sensors.push_back(s);
+        i=(int)sensors.size()-1;
+        lookup.added(i);
+    }
+    return i;
+}
+
+// Applies reading j of a computed batch to its sensor in place.
+// Returns true when the sensor's anomaly level went up to 2.
+bool applyReading(const ReadingBatch& b,size_t j,vector<AirSensor>& sensors,AQIRanking* ranking){
+    AirSensor& s=sensors[b.sensor[j]];
+    int before=s.anomaly;
+    s.pm25=b.pm25[j]; s.pm10=b.pm10[j]; s.co=b.co[j]; s.wind=b.wind[j];
+    s.aqi=b.aqi[j];
+    s.anomaly=b.anomaly[j];
+    if(ranking) ranking->update(b.sensor[j],s.aqi);
+    return s.anomaly==2 && before<2;
+}
+
+// Runs the kernel over the batch, then applies its readings in order.
+// A batch is at most SensorBatch readings, so an alert waits for at
+// most that many parses.
+void applyBatch(ReadingBatch& b,vector<AirSensor>& sensors,AQIRanking* ranking,StreamStats& st,bool printAlerts){
+    if(b.size()==0) return;
+    b.compute();
+    for(size_t j=0;j<b.size();j++){
+        if(!applyReading(b,j,sensors,ranking)) continue;
+        st.alerts++;
+        if(b.timestamp[j]) st.recordLatency(nowNs()-b.timestamp[j]);
+        if(printAlerts)
+            cout<<"ALERT: "<<sensors[b.sensor[j]].zone<<" reached anomaly level 2\n"<<flush;
+    }
+    b.n=0;
+}
+
+// Processes every complete line in buf[0,len) and returns the number of
+// bytes consumed (a trailing partial line is left for the next read).
+size_t processBuffer(const char* buf,size_t len,vector<AirSensor>& sensors,ZoneLookup& lookup,
+                     ReadingBatch& batch,AQIRanking* ranking,StreamStats& st,bool printAlerts){
+    StageTimer timer(StageParse);
+    long long before=st.readings+st.malformed;
+    const char* p=buf;
+    const char* end=buf+len;
+    while(p<end){
+        const char* nl=(const char*)memchr(p,'\n',end-p);
+        if(!nl) break;
+        const char* lineEnd=(nl>p && nl[-1]=='\r')? nl-1 : nl;
+        ReadingView r;
+        if(lineEnd>p){
+            if(parseReading(p,lineEnd,r)){
+                st.readings++;
+                batch.add(sensorFor(r,sensors,lookup),r);
+                if(batch.size()==SensorBatch) applyBatch(batch,sensors,ranking,st,printAlerts);
+            } else st.malformed++;
+        }
+        p=nl+1;
+    }
+    applyBatch(batch,sensors,ranking,st,printAlerts);
+    timer.addItems(st.readings+st.malformed-before);
+    return p-buf;
+}
+
+// Reads fd until EOF; with follow=true keeps polling for appended data
+// (tail -f) until stop is set. ranking, when given, follows every update.
+void streamReadings(int fd,vector<AirSensor>& sensors,AQIRanking* ranking,StreamStats& st,bool follow,
+                    bool printAlerts,const volatile bool* stop){
+    ZoneLookup lookup(sensors);
+    ReadingBatch batch;
+    vector<char> buf(1<<20);
+    size_t have=0;
+    for(;;){
+        ssize_t n=read(fd,buf.data()+have,buf.size()-have);
+        if(n<0) { perror("read"); return; }
+        if(n==0){
+            if(!follow || (stop && *stop)) break;
+            this_thread::sleep_for(chrono::milliseconds(1));
+            continue;
+        }
+        have+=n;
+        size_t used=processBuffer(buf.data(),have,sensors,lookup,batch,ranking,st,printAlerts);
+        if(used==0 && have==buf.size()) { st.malformed++; used=have; } // over-long line
+        memmove(buf.data(),buf.data()+used,have-used);
+        have-=used;
+    }
+    if(have) processBuffer(string(buf.data(),have).append("\n").data(),have+1,sensors,lookup,batch,ranking,st,printAlerts);
+}
+
+// Writes "zone,pm25,pm10,co,wind,timestamp\n" without stdio.
+char* formatReading(char* out,string_view zone,int pm25,int pm10,int co,char wind,long long ts){
+    memcpy(out,zone.data(),zone.size()); out+=zone.size();
+    long long vals[4]={pm25,pm10,co,ts};
+    for(int f=0;f<4;f++){
+        *out++=',';
+        if(f==3){ *out++=wind; *out++=','; }
+        char tmp[24]; int k=0;
+        long long v=vals[f];
+        do { tmp[k++]=(char)('0'+v%10); v/=10; } while(v);
+        while(k) *out++=tmp[--k];
+    }
+    *out++='\n';
+    return out;
+}
+
+// Parse-only throughput on an in-memory log, then end-to-end through a
+// pipe with a producer thread stamping each reading.
+void benchmarkStreaming(long long total){
+    vector<AirSensor> sensors;
+    for(int i=0;i<1000;i++){
+        AirSensor s; s.zone=zoneName("Zone"+to_string(i));
+        s.pm25=s.pm10=s.co=0; s.wind='N'; s.aqi=0; s.anomaly=0;
+        sensors.push_back(s);
+    }
+    const char winds[4]={'N','E','S','W'};
+    uint32_t seed=12345;
+    auto rnd=[&seed](){ seed=seed*1664525u+1013904223u; return seed>>8; };
+
+    // In-memory
+    string log; log.reserve(total*40);
+    vector<char> line(128);
+    for(long long i=0;i<total;i++){
+        const AirSensor& s=sensors[rnd()%sensors.size()];
+        char* e=formatReading(line.data(),s.zone,rnd()%400,rnd()%450,rnd()%15,winds[rnd()%4],0);
+        log.append(line.data(),e-line.data());
+    }
+    StreamStats st;
+    ZoneLookup lookup(sensors);
+    ReadingBatch batch;
+    auto t0=chrono::steady_clock::now();
+    processBuffer(log.data(),log.size(),sensors,lookup,batch,0,st,false);
+    double sec=chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+    cout<<"bench=stream_parse readings="<<st.readings<<" seconds="<<sec
+        <<" readings_per_sec="<<(long long)(st.readings/sec)
+        <<" mb_per_sec="<<log.size()/sec/1e6<<endl;
+
+    // Through a pipe
+    int fds[2];
+    if(pipe(fds)!=0){ perror("pipe"); return; }
+    for(auto& s:sensors){ s.anomaly=0; s.aqi=0; }
+    thread producer([&](){
+        vector<char> out(1<<16);
+        char* p=out.data();
+        for(long long i=0;i<total;i++){
+            const AirSensor& s=sensors[rnd()%sensors.size()];
+            p=formatReading(p,s.zone,rnd()%400,rnd()%450,rnd()%15,winds[rnd()%4],nowNs());
+            if(p-out.data()>(long)out.size()-128 || i==total-1){
+                const char* q=out.data();
+                while(q<p){ ssize_t n=write(fds[1],q,p-q); if(n<=0) break; q+=n; }
+                p=out.data();
+            }
+        }
+        close(fds[1]);
+    });
+    StreamStats live;
+    t0=chrono::steady_clock::now();
+    streamReadings(fds[0],sensors,0,live,false,false,0);
+    sec=chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+    producer.join();
+    close(fds[0]);
+    cout<<"bench=stream_pipe readings="<<live.readings<<" seconds="<<sec
+        <<" readings_per_sec="<<(long long)(live.readings/sec)
+        <<" alerts="<<live.alerts
+        <<" alert_latency_p50_us<="<<live.latencyQuantile(0.50)/1000.0
+        <<" alert_latency_p99_us<="<<live.latencyQuantile(0.99)/1000.0<<endl;
+}
+
 /* ===================== DISPLAY ===================== */
 
 void display(vector<AirSensor>& s){
@@ -193,13 +1334,163 @@ void display(vector<AirSensor>& s){
         cout<<x.zone<<" | AQI: "<<x.aqi<<" | AnomalyLevel: "<<x.anomaly<<" | Wind: "<<x.wind<<endl;
 }
 
+// Worst k zones in ranking order, same format as display()
+void displayTop(const vector<AirSensor>& s,const AQIRanking& ranking,int k){
+    cout<<"\nCITY AIR STATUS (worst "<<min(k,ranking.size())<<" of "<<ranking.size()<<"):\n";
+    for(int i:ranking.topK(k))
+        cout<<s[i].zone<<" | AQI: "<<s[i].aqi<<" | AnomalyLevel: "<<s[i].anomaly<<" | Wind: "<<s[i].wind<<endl;
+}
+
+/* ===================== ALGORITHM BENCHMARK ===================== */
+
+// Times each algorithm of the one-shot analysis on an air_sensors.csv of
+// any size (Benchmarks/gen_data writes them). The zone graph is
+// randomZoneGraph(n,4) with the anomaly levels of the loaded sensors.
+// Super-linear functions run on a prefix: quickSort is quadratic in the
+// number of equal AQIs, the V-1 pass Bellman-Ford in V*E.
+void benchmarkAlgorithms(const string& csv){
+    const int quickSortCap=200000, passesCap=3000;
+    vector<AirSensor> sensors;
+    double ms=timeMs([&]{ sensors=readCSV(csv); });
+    int n=sensors.size();
+    reportAlgorithm("air","readCSV",n,ms);
+    if(n==0) return;
+
+    vector<AirSensor> sorted(sensors.begin(),sensors.begin()+min(n,quickSortCap));
+    ms=timeMs([&]{ quickSort(sorted,0,(int)sorted.size()-1); });
+    reportAlgorithm("air","quickSort",sorted.size(),ms,n);
+
+    AQIRanking ranking;
+    ms=timeMs([&]{ ranking.build(sensors); });
+    reportAlgorithm("air","AQIRanking::build",n,ms);
+
+    vector<Edge> edges; vector<int> anomaly;
+    randomZoneGraph(n,4,7,edges,anomaly);
+    for(int i=0;i<n;i++) anomaly[i]=sensors[i].anomaly;
+    Graph city(n);
+    for(auto& e:edges) city.addEdge(e.from,e.to);
+    vector<vector<pair<int,int>>> adj(n);
+    for(auto& e:edges){ adj[e.from].push_back({e.to,e.weight}); adj[e.to].push_back({e.from,e.weight}); }
+    vector<bool> blocked=blockedZones(sensors,edges,0);
+
+    // The searches are timed without printing their results: formatting
+    // a line per zone cost ~2 us each and dominated the search itself
+    ms=timeMs([&]{ city.bfsChain(0,sensors); });
+    reportAlgorithm("air","Graph::BFS",n,ms);
+    ms=timeMs([&]{ city.dfsChain(0,sensors); });
+    reportAlgorithm("air","Graph::DFS",n,ms);
+    ms=timeMs([&]{ spfa(0,n,edges,anomaly); });
+    reportAlgorithm("air","spfa",n,ms);
+    ms=timeMs([&]{ dijkstraDistances(0,n,adj,blocked); });
+    reportAlgorithm("air","dijkstraDistances",n,ms);
+
+    int small=min(n,passesCap);
+    vector<Edge> se; vector<int> sa;
+    randomZoneGraph(small,4,7,se,sa);
+    ms=timeMs([&]{ bellmanFordPasses(0,small,se,sa); });
+    reportAlgorithm("air","bellmanFordPasses",small,ms,n);
+    reportMetricsOverhead("air");
+}
+
 /* ===================== MAIN ===================== */
 
-int main(){
-    vector<AirSensor> sensors = readCSV("air_sensors.csv");
+/*
+ Usage:
+   AirQ_Moniter                          one-shot analysis of air_sensors.csv
+   AirQ_Moniter stream <log|-> [follow]  apply a reading log (or stdin) to the
+                                         sensors in place, printing alerts;
+                                         "follow" keeps tailing the log
+   AirQ_Moniter bench-stream [readings]  parse + pipe ingestion throughput
+   AirQ_Moniter snapshot [csv]           write <csv>.snap, loaded on later runs
+                                         while it is newer than the CSV
+   AirQ_Moniter bench-snapshot [rows]    CSV vs snapshot startup
+   AirQ_Moniter bench-kernel [sensors]   batch AQI / anomaly kernel
+   AirQ_Moniter bench-topk [sensors]     top-K ranking updates vs quickSort
+   AirQ_Moniter bench-spfa [zones]       anomaly spread solver vs V-1 pass Bellman-Ford
+   AirQ_Moniter forecast [minutes]       wind-aware dispersion forecast per zone
+   AirQ_Moniter bench-dispersion [side] [minutes] [sources]
+                                         city-grid dispersion forecast timing
+   AirQ_Moniter bench-algorithms <csv>   time every analysis algorithm on <csv>
+
+ Any mode also exports per-stage counters and latency histograms when
+ METRICS_OUT=<file|unix:path> is set (see common/metrics.h).
+*/
+int main(int argc,char* argv[]){
+    metricsExportAtExit("air");
+    string mode = argc>1 ? argv[1] : "";
+    if(mode=="stream" && argc>=3){
+        vector<AirSensor> sensors = loadSensors("air_sensors.csv");
+        int fd = string(argv[2])=="-" ? 0 : open(argv[2],O_RDONLY);
+        if(fd<0){ cerr<<"Error opening file: "<<argv[2]<<endl; return 1; }
+        bool follow = argc>=4 && string(argv[3])=="follow";
+        AQIRanking ranking;
+        ranking.build(sensors);
+        StreamStats st;
+        streamReadings(fd,sensors,&ranking,st,follow,true,0);
+        cout<<"Readings: "<<st.readings<<" | Malformed: "<<st.malformed<<" | Alerts: "<<st.alerts<<endl;
+        displayTop(sensors,ranking,10);
+        return 0;
+    }
+    if(mode=="bench-stream"){
+        benchmarkStreaming(argc>2 ? atoll(argv[2]) : 5000000);
+        return 0;
+    }
+    if(mode=="snapshot"){
+        string csv = argc>2 ? argv[2] : "air_sensors.csv";
+        vector<AirSensor> sensors = readCSV(csv);
+        if(!writeSnapshot(sensors,csv+".snap")){ cerr<<"Error writing "<<csv<<".snap\n"; return 1; }
+        cout<<"Wrote "<<sensors.size()<<" sensors to "<<csv<<".snap\n";
+        return 0;
+    }
+    if(mode=="bench-snapshot"){
+        benchmarkSnapshot(argc>2 ? atoll(argv[2]) : 2000000);
+        return 0;
+    }
+    if(mode=="bench-kernel"){
+        benchmarkKernel(argc>2 ? atoll(argv[2]) : 500000,20);
+        return 0;
+    }
+    if(mode=="bench-topk"){
+        benchmarkRanking(argc>2 ? atoi(argv[2]) : 1000000,1000000);
+        return 0;
+    }
+    if(mode=="bench-spfa"){
+        benchmarkSpfa(argc>2 ? atoi(argv[2]) : 100000);
+        return 0;
+    }
+    if(mode=="forecast"){
+        vector<AirSensor> sensors = loadSensors("air_sensors.csv");
+        forecastZones(sensors,100,argc>2 ? atoi(argv[2]) : 60);
+        return 0;
+    }
+    if(mode=="bench-dispersion"){
+        benchmarkDispersion(argc>2 ? atoi(argv[2]) : 1000,argc>3 ? atoi(argv[3]) : 60,argc>4 ? atoi(argv[4]) : 500);
+        return 0;
+    }
+    if(mode=="bench-algorithms" && argc>=3){
+        benchmarkAlgorithms(argv[2]);
+        return 0;
+    }
+    if(!mode.empty()){
+        cerr<<"Usage: AirQ_Moniter [stream <log|-> [follow] | bench-stream [readings]\n"
+              "                     | snapshot [csv] | bench-snapshot [rows] | bench-kernel [sensors]\n"
+              "                     | bench-topk [sensors] | bench-spfa [zones] | forecast [minutes]\n"
+              "                     | bench-dispersion [side] [minutes] [sources] | bench-algorithms <csv>]\n";
+        return 1;
+    }
+
+    vector<AirSensor> sensors = loadSensors("air_sensors.csv");
+
+    // Priority list straight from the ranking
+    AQIRanking ranking;
+    ranking.build(sensors);
+    displayTop(sensors,ranking,sensors.size());
 
-    quickSort(sensors,0,sensors.size()-1);
-    display(sensors);
+    // The demo graph below links the four worst zones, as it did when the
+    // sensors were sorted in place, so it runs on a copy in ranking order
+    vector<AirSensor> ranked;
+    for(int i:ranking.topK(sensors.size())) ranked.push_back(sensors[i]);
+    sensors.swap(ranked);
 
     // Graph for BFS/DFS
     Graph city(sensors.size());
@@ -213,7 +1504,7 @@ int main(){
 
     // Bellman-Ford edges
     vector<Edge> edges = { {0,1,40},{1,2,30},{2,3,20},{3,1,-10} };
-    vector<bool> blocked(sensors.size(),false);
+    vector<bool> blocked = blockedZones(sensors,edges,0);
 
     bellmanFord(0,sensors.size(),edges,sensors,blocked);
 
@@ -223,7 +1514,7 @@ int main(){
     adj[1].push_back({2,30}); adj[2].push_back({1,30});
     adj[2].push_back({3,20}); adj[3].push_back({2,20});
     adj[3].push_back({1,-10}); adj[1].push_back({3,-10});
-    vector<string> zones;
+    vector<string_view> zones;
     for(auto &x:sensors) zones.push_back(x.zone);
 
     dijkstraAvoidingZones(0,sensors.size(),adj,blocked,zones);
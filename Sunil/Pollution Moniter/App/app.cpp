@@ -1,97 +1,1139 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <unordered_map>
 #include <algorithm>
+#include <queue>
+#include <array>
+#include <chrono>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <csignal>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "../../common/mapped_csv.h"
+#include "../../common/rule_engine.h"
+#include "../../common/bench_timer.h"
+#include "../../common/metrics.h"
+#include "../../common/intern.h"
 
 using namespace std;
 
 /*
  Prototype:
- - Area search (Trie concept simulated using string matching)
+ - Area search and autocomplete (radix tree over case-folded names,
+   one-typo tolerant, completions ranked by pollution severity)
  - Hash table for fast data lookup
  - CSV-based real-time data simulation
+ - Server mode: many concurrent lookups over a Unix socket, fresh data
+   swapped in (read-copy-update) without blocking readers
 */
 
 struct PollutionData {
     int airAQI;
     int waterPollution;
     int landQuality;
-    string floodRisk;
-    string industrialRisk;
+    string_view floodRisk;      // interned in the owning AreaTable
+    string_view industrialRisk;
+    int row;            // area id: position in AreaTable's vectors and columns
 };
 
-unordered_map<string, PollutionData> pollutionDB;
-
 // Convert string to lowercase (for flexible search)
 string toLower(string s) {
     transform(s.begin(), s.end(), s.begin(), ::tolower);
     return s;
 }
 
-// Load CSV data into hash table
-void loadCSV(const string& filename) {
-    ifstream file(filename);
-    string line;
+// Case-folded prefix index over area names for search and autocomplete.
+//
+// Names are folded to lowercase and sorted, so every prefix owns one
+// contiguous range of the sorted array. A radix tree (one node per
+// branching point, labels pointing into the names) finds that range in
+// O(prefix length). A max segment tree over the severities of the
+// sorted names then yields the top-N of any range best-first in
+// O(N log n). Nodes covering many names keep their top 10 so the common
+// short-prefix completion is a copy; small ranges are simply scanned.
+class AreaIndex {
+public:
+    void build(const vector<string_view>& names, const vector<float>& severity) {
+        int n = names.size();
+        StageTimer timer(StageSort, n);
+        vector<string> folded(n);
+        for (int i = 0; i < n; i++) folded[i] = fold(names[i]);
+        ids.resize(n);
+        for (int i = 0; i < n; i++) ids[i] = i;
+        sort(ids.begin(), ids.end(), [&](int a, int b) { return folded[a] < folded[b]; });
+
+        // Folded names back to back in sorted order
+        offset.assign(n + 1, 0);
+        chars.clear();
+        for (int i = 0; i < n; i++) {
+            chars += folded[ids[i]];
+            offset[i + 1] = chars.size();
+        }
+
+        nodes.clear();
+        nodes.push_back(Node());
+        lead.assign(1, {});
+        if (n > 0) buildNode(0, 0, n, 0);
+
+        // Segment tree of argmax severity over sorted positions
+        sev.resize(n);
+        for (int i = 0; i < n; i++) sev[i] = severity[ids[i]];
+        size = 1;
+        while (size < n) size *= 2;
+        tree.assign(2 * size, -1);
+        for (int i = 0; i < n; i++) tree[size + i] = i;
+        for (int i = size - 1; i > 0; i--) tree[i] = better(tree[2 * i], tree[2 * i + 1]);
+
+        topCache.clear();
+        topOf.assign(nodes.size(), -1);
+        for (size_t id = 0; id < nodes.size(); id++) {
+            const Node& node = nodes[id];
+            if (node.hi - node.lo <= SmallRange) continue;
+            topOf[id] = topCache.size();
+            for (int p : heapTop({{node.lo, node.hi, -1}}, TopK)) topCache.push_back({sev[p], p});
+        }
+    }
+
+    // Area id of an exact (case-insensitive) name, or -1
+    int find(string_view name) const {
+        string q = fold(name);
+        Range r = prefixRange(q);
+        if (r.lo < r.hi && length(r.lo) == (int)q.size()) return ids[r.lo];
+        return -1;
+    }
+
+    // Up to n area ids starting with prefix, most severe first
+    vector<int> complete(string_view prefix, int n) const {
+        Range r = prefixRange(fold(prefix));
+        vector<Range> ranges;
+        if (r.lo < r.hi) ranges.push_back(r);
+        return top(ranges, n);
+    }
+
+    // Like complete(), but the prefix may be one edit (insert, delete,
+    // substitute) away from the start of the name
+    vector<int> completeFuzzy(string_view prefix, int n) const {
+        string q = fold(prefix);
+        if (ids.empty()) return vector<int>();
+        vector<Walk> walks;
+        fuzzy(0, nodes[0].begin, q, 0, false, walks);
+        vector<Range> ranges;
+        exactAll(walks, q, ranges);
+
+        // Trie ranges are nested or disjoint: keep the outermost ones
+        sort(ranges.begin(), ranges.end(), [](const Range& a, const Range& b) {
+            return a.lo != b.lo ? a.lo < b.lo : a.hi > b.hi;
+        });
+        vector<Range> outer;
+        for (auto& r : ranges)
+            if (outer.empty() || r.lo >= outer.back().hi) outer.push_back(r);
+        return top(outer, n);
+    }
+
+    int names() const { return ids.size(); }
+
+    size_t bytes() const {
+        return chars.size() + offset.size() * sizeof(int) + ids.size() * sizeof(int)
+             + nodes.size() * (sizeof(Node) + 2) + sev.size() * sizeof(float) + tree.size() * sizeof(int)
+             + topCache.size() * sizeof(Ranked) + topOf.size() * sizeof(int);
+    }
+
+    static string fold(string_view s) {
+        string out(s);
+        for (auto& c : out) c = tolower((unsigned char)c);
+        return out;
+    }
+
+private:
+    // Radix tree node: the names [lo, hi) share the label, which is the
+    // characters [begin, end) of any of them. Children are contiguous
+    // and sorted by their first character. 32 bytes and aligned, so a
+    // visit is one cache line.
+    struct alignas(32) Node {
+        int lo = 0, hi = 0;
+        int begin = 0, end = 0;
+        int firstChild = 0, children = 0;
+        uint32_t next = 0;          // charBit() of each child's first character
+        unsigned char head[4] = {}; // label's first characters, zero padded
+    };
+
+    // A range of sorted positions and the node it came from
+    struct Range { int lo, hi, node; };
 
-    getline(file, line); // skip header
+    // An exact walk of q[i..] from depth d of node id. When from >= 0 the
+    // walk is at the end of node from and id is not yet looked up.
+    struct Walk { int id, d, i, from; };
 
-    while (getline(file, line)) {
-        stringstream ss(line);
-        string area, temp;
+    static constexpr int TopK = 10, SmallRange = 32;
 
-        PollutionData data;
+    // A sorted position with its severity, so ranking candidates does not
+    // go back to sev[] for each one
+    struct Ranked {
+        float s;
+        int pos;
+        bool operator<(const Ranked& o) const { return s != o.s ? s > o.s : pos < o.pos; }
+    };
 
-        getline(ss, area, ',');
-        getline(ss, temp, ','); data.airAQI = stoi(temp);
-        getline(ss, temp, ','); data.waterPollution = stoi(temp);
-        getline(ss, temp, ','); data.landQuality = stoi(temp);
-        getline(ss, data.floodRisk, ',');
-        getline(ss, data.industrialRisk, ',');
+    vector<int> ids;            // sorted position -> area id
+    vector<int> offset;         // sorted position -> start in chars
+    string chars;
+    vector<Node> nodes;
+    // node -> its label's first two characters (0 for the second of a
+    // one-character label), so a parent can sift its children in one
+    // cache line instead of touching each child's node
+    vector<array<unsigned char, 2>> lead;
+    vector<float> sev;
+    vector<int> tree;
+    vector<Ranked> topCache;    // TopK per cached node, best first
+    vector<int> topOf;          // node -> start of its TopK in topCache, or -1
+    int size = 1;
+
+    int length(int pos) const { return offset[pos + 1] - offset[pos]; }
+    char at(int pos, int depth) const { return chars[offset[pos] + depth]; }
+
+    int better(int a, int b) const {
+        if (a < 0) return b;
+        if (b < 0) return a;
+        return sev[b] > sev[a] ? b : a;
+    }
+
+    void buildNode(int id, int lo, int hi, int depth) {
+        // Label runs to the longest common prefix of the first and last name
+        int end = depth, limit = min(length(lo), length(hi - 1));
+        while (end < limit && at(lo, end) == at(hi - 1, end)) end++;
+
+        // Names ending here sort first and have no child
+        int first = lo;
+        while (first < hi && length(first) == end) first++;
+
+        vector<Range> parts;
+        for (int i = first; i < hi; ) {
+            char c = at(i, end);
+            int j = i + 1;
+            // Children are usually short runs; gallop, then binary search
+            int step = 1;
+            while (j < hi && at(j, end) == c) { j = min(hi, j + step); step *= 2; }
+            int a = max(i + 1, j - step / 2), b = j;
+            while (a < b) {
+                int m = (a + b) / 2;
+                if (at(m, end) == c) a = m + 1; else b = m;
+            }
+            parts.push_back({i, a, -1});
+            i = a;
+        }
+
+        Node& node = nodes[id];
+        node = {lo, hi, depth, end, (int)nodes.size(), (int)parts.size(), 0, {}};
+        for (int k = 0; k < 4 && depth + k < end; k++) node.head[k] = at(lo, depth + k);
+        for (auto& p : parts) node.next |= charBit(at(p.lo, end));
+        lead[id][0] = node.head[0];
+        lead[id][1] = end - depth > 1 ? node.head[1] : 0;
+        int firstChild = nodes.size();
+        nodes.resize(nodes.size() + parts.size());
+        lead.resize(nodes.size());
+        for (size_t k = 0; k < parts.size(); k++)
+            buildNode(firstChild + k, parts[k].lo, parts[k].hi, end);
+    }
+
+    // Filter bit of a folded character: one per letter, shared ones for
+    // the bytes between. Bits follow byte order, so a letter child's
+    // index is at least the count of lower bits set in the parent's mask.
+    static uint32_t charBit(char ch) {
+        unsigned char c = ch;
+        if (c < '0') return 1u << 0;
+        if (c <= '9') return 1u << 1;
+        if (c < 'a') return 1u << 2;
+        if (c <= 'z') return 1u << (3 + c - 'a');
+        return 1u << (c < 0x80 ? 29 : c < 0xc0 ? 30 : 31);
+    }
+
+    // False when no name under (node, depth d) can have q[j] at depth d,
+    // judged from the node alone: its head bytes inside the label, its
+    // children's first characters at the end of it. Lets the fuzzy walk
+    // skip an edit branch without visiting the nodes below.
+    bool mayContinue(const Node& node, int d, const string& q, int j) const {
+        if (j == (int)q.size()) return true;
+        if (d == node.end) return node.next & charBit(q[j]);
+        if (d < node.begin + 4) return node.head[d - node.begin] == (unsigned char)q[j];
+        return true;
+    }
+
+    // Where the search for the child starting with c begins, or -1 when
+    // there is none. Children with lower first characters number at least
+    // the lower bits set in next, and exactly that when no bit below is
+    // shared, so child() usually stops at this node.
+    int childSlot(const Node& node, char c) const {
+        uint32_t bit = charBit(c);
+        if (!(node.next & bit)) return -1;
+        return node.firstChild + __builtin_popcount(node.next & (bit - 1));
+    }
+
+    // Child starting with c, or -1
+    int child(const Node& node, char c) const {
+        int m = childSlot(node, c);
+        if (m < 0) return -1;
+        for (int end = node.firstChild + node.children; m < end; m++) {
+            if (nodes[m].head[0] == (unsigned char)c) return m;
+            if (nodes[m].head[0] > (unsigned char)c) break;
+        }
+        return -1;
+    }
+
+    Range prefixRange(const string& q) const {
+        if (ids.empty()) return {0, 0, -1};
+        return exactFrom(0, 0, q, 0);
+    }
+
+    // Matches q[i..] against the rest of the node's label from depth d,
+    // advancing both up to the label's end or q's
+    bool matchLabel(const Node& node, int& d, const string& q, int& i) const {
+        int len = q.size();
+        // The first label characters are in the node, so most
+        // mismatches are found without touching the names
+        for (; d < node.end && d < node.begin + 4 && i < len; d++, i++)
+            if (node.head[d - node.begin] != (unsigned char)q[i]) return false;
+        if (d < node.end && i < len) {
+            int k = min(node.end - d, len - i);
+            if (memcmp(&chars[offset[node.lo] + d], &q[i], k) != 0) return false;
+            d += k;
+            i += k;
+        }
+        return true;
+    }
+
+    // Range of names that continue (node id, depth d) with exactly q[i..]
+    Range exactFrom(int id, int d, const string& q, int i) const {
+        int len = q.size();
+        while (true) {
+            const Node& node = nodes[id];
+            if (!matchLabel(node, d, q, i)) return {0, 0, -1};
+            if (i == len) return {node.lo, node.hi, id};
+            id = child(node, q[i]);
+            if (id < 0) return {0, 0, -1};
+        }
+    }
 
-        pollutionDB[toLower(area)] = data;
+    // exactFrom() for many walks at once. Each round moves every walk one
+    // node down and prefetches the child it goes to next, so the walks'
+    // cache misses overlap instead of queueing one behind another.
+    void exactAll(vector<Walk>& walks, const string& q, vector<Range>& out) const {
+        int len = q.size();
+        while (!walks.empty()) {
+            size_t live = 0;
+            for (Walk w : walks) {
+                if (w.from >= 0 && (w.id = child(nodes[w.from], q[w.i])) < 0) continue;
+                const Node& node = nodes[w.id];
+                if (!matchLabel(node, w.d, q, w.i)) continue;
+                if (w.i == len) { out.push_back({node.lo, node.hi, w.id}); continue; }
+                int m = childSlot(node, q[w.i]);
+                if (m < 0) continue;
+                __builtin_prefetch(&nodes[m]);
+                walks[live++] = {m, w.d, w.i, w.id};
+            }
+            walks.resize(live);
+        }
     }
+
+    // Walks the tree at (node id, depth d) against q[i..] allowing one
+    // edit; once it is spent the rest is an exact walk, left in out for
+    // exactAll()
+    void fuzzy(int id, int d, const string& q, int i, bool edited, vector<Walk>& out) const {
+        if (edited || i == (int)q.size()) {
+            out.push_back({id, d, i, -1});
+            return;
+        }
+        const Node& node = nodes[id];
+        if (mayContinue(node, d, q, i + 1))
+            fuzzy(id, d, q, i + 1, true, out);                          // extra char in q
+        if (d < node.end) { fuzzyChar(id, d, q, i, out); return; }
+        // Deletion was tried once above for all children. A child goes on
+        // only if its first character matches q[i] or its second could
+        // match after a substitution (q[i+1]) or an insertion (q[i])
+        unsigned char a = q[i], b = i + 1 < (int)q.size() ? q[i + 1] : 0;
+        for (int c = node.firstChild; c < node.firstChild + node.children; c++) {
+            unsigned char second = lead[c][1];
+            if (lead[c][0] == a || !b || !second || second == a || second == b)
+                fuzzyChar(c, d, q, i, out);
+        }
+    }
+
+    // Name character at depth d of node id against q[i], no edit spent yet
+    void fuzzyChar(int id, int d, const string& q, int i, vector<Walk>& out) const {
+        const Node& node = nodes[id];
+        char c = d < node.begin + 4 ? node.head[d - node.begin] : at(node.lo, d);
+        if (c == q[i]) {
+            fuzzy(id, d + 1, q, i + 1, false, out);
+        } else if (mayContinue(node, d + 1, q, i + 1)) {
+            fuzzy(id, d + 1, q, i + 1, true, out);                      // substitution
+        }
+        if (mayContinue(node, d + 1, q, i))
+            fuzzy(id, d + 1, q, i, true, out);                          // char missing from q
+    }
+
+    // Argmax severity over sorted positions [lo, hi)
+    int argmax(int lo, int hi) const {
+        int best = -1;
+        for (lo += size, hi += size; lo < hi; lo /= 2, hi /= 2) {
+            if (lo & 1) best = better(best, tree[lo++]);
+            if (hi & 1) best = better(best, tree[--hi]);
+        }
+        return best;
+    }
+
+    // Top n area ids over the ranges: cached lists and scans when
+    // n <= TopK, the segment tree otherwise
+    vector<int> top(const vector<Range>& ranges, int n) const {
+        vector<int> out;
+        if (n > TopK) {
+            for (int p : heapTop(ranges, n)) out.push_back(ids[p]);
+            return out;
+        }
+        // Ask for every range's list or severities first, so the misses
+        // overlap as in exactAll()
+        for (auto& r : ranges) {
+            if (r.hi - r.lo <= SmallRange) __builtin_prefetch(&sev[r.lo]);
+            else if (r.node >= 0 && topOf[r.node] >= 0) __builtin_prefetch(&topCache[topOf[r.node]]);
+        }
+        vector<Ranked> cand;
+        for (auto& r : ranges) {
+            if (r.hi - r.lo <= SmallRange) {
+                for (int p = r.lo; p < r.hi; p++) cand.push_back({sev[p], p});
+            } else if (r.node >= 0 && topOf[r.node] >= 0) {
+                const Ranked* best = &topCache[topOf[r.node]];
+                cand.insert(cand.end(), best, best + min(n, TopK));
+            } else {
+                for (int p : heapTop({r}, n)) cand.push_back({sev[p], p});
+            }
+        }
+        if ((int)cand.size() > n) {
+            partial_sort(cand.begin(), cand.begin() + n, cand.end());
+            cand.resize(n);
+        } else {
+            sort(cand.begin(), cand.end());
+        }
+        for (auto& c : cand) out.push_back(ids[c.pos]);
+        return out;
+    }
+
+    // Top n sorted positions over the ranges, best-first on the segment tree
+    vector<int> heapTop(const vector<Range>& ranges, int n) const {
+        struct Item { float s; int pos, lo, hi; };
+        auto lower = [](const Item& a, const Item& b) { return a.s < b.s; };
+        priority_queue<Item, vector<Item>, decltype(lower)> heap(lower);
+        auto add = [&](int lo, int hi) {
+            if (lo >= hi) return;
+            int m = argmax(lo, hi);
+            heap.push({sev[m], m, lo, hi});
+        };
+        for (auto& r : ranges) add(r.lo, r.hi);
+
+        vector<int> out;
+        while (!heap.empty() && (int)out.size() < n) {
+            Item it = heap.top();
+            heap.pop();
+            out.push_back(it.pos);
+            add(it.lo, it.pos);
+            add(it.pos + 1, it.hi);
+        }
+        return out;
+    }
+};
+
+// About 1 per alert threshold reached (AQI 150, water 50, land 50, High risks)
+float severity(const PollutionData& d) {
+    return d.airAQI / 150.0f + d.waterPollution / 50.0f + (100 - d.landQuality) / 50.0f
+         + (d.floodRisk == "High") + (d.industrialRisk == "High");
 }
 
-// Display pollution information
-void displayInfo(const string& area) {
-    string key = toLower(area);
+// Everything a lookup reads. Built by one CSV load and never changed
+// afterwards, so any number of threads can read it at once. Names and
+// risk levels are interned in the table's own arena rather than the
+// process-wide one, so a reload never writes to what readers of the
+// previous table are using.
+struct AreaTable {
+    StringInterner strings;
+    vector<int> byName;                     // interned lowercased name -> area id, -1 if none
+    vector<string_view> names;              // CSV order, stored in strings
+    string lowered;                         // add()'s scratch key
+    vector<PollutionData> data;
+    vector<float> severity;
+    AreaIndex index;
+
+    // Column copy for the compiled alert rules in app_rules.txt; the two
+    // risk columns hold codes into riskLevels
+    vector<float> colAQI, colWater, colLand, colFlood, colIndustrial;
+    vector<string> riskLevels;
+    RuleEngine alertRules;
+    bool haveRules = false;
+
+    float riskCode(string_view level) {
+        for (size_t i = 0; i < riskLevels.size(); i++)
+            if (riskLevels[i] == level)
+                return i;
+        riskLevels.push_back(string(level));
+        return riskLevels.size() - 1;
+    }
+
+    // Area id of a lowercased name, or -1
+    int find(const string& key) const {
+        uint32_t id = strings.find(key);
+        return id < byName.size() ? byName[id] : -1;
+    }
+
+    // The name and risk levels may point into a CSV row; they are copied
+    // into the arena. A repeated name maps to its last row.
+    void add(string_view name, PollutionData d) {
+        d.row = names.size();
+        d.floodRisk = strings.keep(d.floodRisk);
+        d.industrialRisk = strings.keep(d.industrialRisk);
+        colAQI.push_back(d.airAQI);
+        colWater.push_back(d.waterPollution);
+        colLand.push_back(d.landQuality);
+        colFlood.push_back(riskCode(d.floodRisk));
+        colIndustrial.push_back(riskCode(d.industrialRisk));
+
+        lowered.assign(name.data(), name.size());
+        transform(lowered.begin(), lowered.end(), lowered.begin(), ::tolower);
+        uint32_t key = strings.intern(lowered);
+        if (key >= byName.size()) byName.resize(key + 1, -1);
+        byName[key] = d.row;
+        names.push_back(strings.store(name));
+        severity.push_back(::severity(d));
+        data.push_back(d);
+    }
 
-    if (pollutionDB.find(key) == pollutionDB.end()) {
-        cout << "\n❌ Area not found in database.\n";
+    // Alert thresholds from a rule file when present, else the built-in ones
+    bool finish(const string& rulesFile) {
+        index.build(names, severity);
+        if (access(rulesFile.c_str(), R_OK) != 0) return true;
+        alertRules.addColumn("airAQI");
+        alertRules.addColumn("waterPollution");
+        alertRules.addColumn("landQuality");
+        alertRules.addColumn("floodRisk", riskLevels);
+        alertRules.addColumn("industrialRisk", riskLevels);
+        string error;
+        if (!alertRules.load(rulesFile, error)) {
+            cerr << rulesFile << ": " << error << endl;
+            return false;
+        }
+        haveRules = true;
+        return true;
+    }
+};
+
+// Load CSV data into a table
+bool loadCSV(const string& filename, AreaTable& table) {
+    MappedCSV file(filename);
+    CSVRow row;
+
+    if (!file.isOpen()) {
+        cerr << "Error opening file: " << filename << endl;
+        return false;
+    }
+
+    {
+        StageTimer timer(StageParse);
+        file.skipLine(); // skip header
+        size_t expected = file.estimateRows();
+        table.names.reserve(expected);
+        table.data.reserve(expected);
+
+        while (file.nextRow(row)) {
+            PollutionData data;
+
+            data.airAQI = row.toInt(1);
+            data.waterPollution = row.toInt(2);
+            data.landQuality = row.toInt(3);
+            data.floodRisk = row[4];
+            data.industrialRisk = row[5];
+
+            table.add(row[0], data);
+        }
+        timer.addItems(table.names.size());
+    }
+    return table.finish("app_rules.txt");
+}
+
+// Display pollution information
+void displayInfo(const AreaTable& table, string_view area, ostream& out) {
+    StageTimer timer(StageSearch, 1, true);
+    int id = table.find(toLower(string(area)));
+    if (id < 0) {
+        out << "\n❌ Area not found in database.\n";
+        vector<int> close = table.index.completeFuzzy(area, 3);
+        if (!close.empty()) {
+            out << "Did you mean: ";
+            for (size_t i = 0; i < close.size(); i++)
+                out << (i ? ", " : "") << table.names[close[i]];
+            out << "?\n";
+        }
         return;
     }
 
-    PollutionData d = pollutionDB[key];
+    const PollutionData& d = table.data[id];
+
+    out << "\n📍 Area: " << area << endl;
+    out << "---------------------------------\n";
+    out << "🌫 Air Quality Index: " << d.airAQI << endl;
+    out << "💧 Water Pollution Index: " << d.waterPollution << endl;
+    out << "🌱 Land Quality Index: " << d.landQuality << endl;
+    out << "🌊 Flood Risk: " << d.floodRisk << endl;
+    out << "🏭 Industrial Risk: " << d.industrialRisk << endl;
 
-    cout << "\n📍 Area: " << area << endl;
-    cout << "---------------------------------\n";
-    cout << "🌫 Air Quality Index: " << d.airAQI << endl;
-    cout << "💧 Water Pollution Index: " << d.waterPollution << endl;
-    cout << "🌱 Land Quality Index: " << d.landQuality << endl;
-    cout << "🌊 Flood Risk: " << d.floodRisk << endl;
-    cout << "🏭 Industrial Risk: " << d.industrialRisk << endl;
+    out << "\n🔔 Alerts & Suggestions:\n";
 
-    cout << "\n🔔 Alerts & Suggestions:\n";
+    if (table.haveRules) {
+        // Rules see only this area's row
+        int r = d.row;
+        vector<RuleHit> hits;
+        table.alertRules.evaluate({&table.colAQI[r], &table.colWater[r], &table.colLand[r],
+                                   &table.colFlood[r], &table.colIndustrial[r]}, 1, {}, hits);
+        for (auto& h : hits)
+            out << table.alertRules.format(h, {}) << "\n";
+        return;
+    }
 
     if (d.airAQI > 150)
-        cout << "⚠ High air pollution – Wear masks & reduce outdoor activity.\n";
+        out << "⚠ High air pollution – Wear masks & reduce outdoor activity.\n";
 
     if (d.waterPollution > 50)
-        cout << "⚠ Water not safe for drinking – Treatment required.\n";
+        out << "⚠ Water not safe for drinking – Treatment required.\n";
 
     if (d.landQuality < 50)
-        cout << "⚠ Soil degradation detected – Avoid agriculture.\n";
+        out << "⚠ Soil degradation detected – Avoid agriculture.\n";
 
     if (d.floodRisk == "High")
-        cout << "🚨 Flood alert – Stay cautious near water bodies.\n";
+        out << "🚨 Flood alert – Stay cautious near water bodies.\n";
 
     if (d.industrialRisk == "High")
-        cout << "🚨 Industrial pollution alert – Authorities notified.\n";
+        out << "🚨 Industrial pollution alert – Authorities notified.\n";
+}
+
+// Synthetic city-scale name set: syllable names with locality suffixes
+vector<string> syntheticAreas(int n, uint32_t seed) {
+    static const char* syl[] = {"ban", "ga", "lo", "re", "ya", "la", "han", "ka", "ma", "ra",
+                                "nag", "pu", "ko", "ra", "man", "ga", "la", "vi", "jay", "in",
+                                "di", "ra", "che", "nna", "hal", "li", "sa", "dha", "shi", "va"};
+    static const char* suffix[] = {"Nagar", "Layout", "Halli", "Pura", "Road", "Colony",
+                                   "Extension", "Block", "Phase", "Main", "Cross", "Market"};
+    auto rnd = [&]() { seed = seed * 1664525u + 1013904223u; return seed >> 8; };
+    unordered_map<string, int> seen;
+    vector<string> out;
+    while ((int)out.size() < n) {
+        string name;
+        int k = 2 + rnd() % 3;
+        for (int i = 0; i < k; i++) name += syl[rnd() % 30];
+        name[0] = toupper(name[0]);
+        name += string(" ") + suffix[rnd() % 12];
+        if (rnd() % 2) name += " " + to_string(1 + rnd() % 400);
+        if (seen.emplace(name, 0).second) out.push_back(name);
+    }
+    return out;
+}
+
+// p50 / p99 / max of per-query latencies in microseconds
+string latencySummary(vector<double>& us) {
+    sort(us.begin(), us.end());
+    double sum = 0;
+    for (double x : us) sum += x;
+    return "p50_us=" + to_string(us[us.size() / 2]) + " p99_us=" + to_string(us[us.size() * 99 / 100])
+         + " max_us=" + to_string(us.back()) + " mean_us=" + to_string(sum / us.size());
 }
 
-int main() {
-    loadCSV("city_pollution_data.csv");
+void benchmarkSearch(int n, int queries) {
+    vector<string> names = syntheticAreas(n, 7);
+    vector<float> sev(n);
+    uint32_t seed = 11;
+    auto rnd = [&]() { seed = seed * 1664525u + 1013904223u; return seed >> 8; };
+    for (int i = 0; i < n; i++) sev[i] = (rnd() % 1000) / 100.0f;
+
+    AreaIndex index;
+    vector<string_view> views(names.begin(), names.end());
+    auto t0 = chrono::steady_clock::now();
+    index.build(views, sev);
+    double buildMs = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+
+    // Prefixes of real names in random case, and the same with one typo
+    vector<string> prefixes, typos;
+    for (int q = 0; q < queries; q++) {
+        const string& name = names[rnd() % n];
+        string p = name.substr(0, 1 + rnd() % min<size_t>(10, name.size()));
+        for (auto& c : p) if (rnd() % 4 == 0) c = toupper(c);
+        prefixes.push_back(p);
+        string t = name.substr(0, min<size_t>(name.size(), 4 + rnd() % 7));
+        int at = rnd() % t.size();
+        switch (rnd() % 3) {
+            case 0: t[at] = 'a' + rnd() % 26; break;
+            case 1: t.erase(at, 1); break;
+            default: t.insert(at, 1, 'a' + rnd() % 26); break;
+        }
+        typos.push_back(t);
+    }
+
+    long long results = 0;
+    auto timed = [&](const vector<string>& qs, auto query) {
+        vector<double> us(qs.size());
+        for (size_t q = 0; q < qs.size(); q++) {
+            auto a = chrono::steady_clock::now();
+            results += query(qs[q]).size();
+            us[q] = chrono::duration<double, micro>(chrono::steady_clock::now() - a).count();
+        }
+        return latencySummary(us);
+    };
+    string exact = timed(prefixes, [&](const string& q) { return index.complete(q, 10); });
+    string fuzzy = timed(typos, [&](const string& q) { return index.completeFuzzy(q, 10); });
+    string lookup = timed(vector<string>(names.begin(), names.begin() + min(n, queries)),
+                          [&](const string& q) { return vector<int>(1, index.find(q)); });
+
+    // What the string-matching version costs: fold and compare every name
+    int scans = 20;
+    t0 = chrono::steady_clock::now();
+    for (int q = 0; q < scans; q++) {
+        string p = toLower(prefixes[q]);
+        vector<int> hit;
+        for (int i = 0; i < n; i++)
+            if (toLower(names[i]).compare(0, p.size(), p) == 0) hit.push_back(i);
+        results += hit.size();
+    }
+    double scanUs = chrono::duration<double, micro>(chrono::steady_clock::now() - t0).count() / scans;
+
+    cout << "bench=app_search names=" << n << " queries=" << queries
+         << " build_ms=" << buildMs << " index_bytes=" << index.bytes() << "\n"
+         << "bench=app_search_complete top=10 " << exact << "\n"
+         << "bench=app_search_fuzzy top=10 " << fuzzy << "\n"
+         << "bench=app_search_find " << lookup << "\n"
+         << "bench=app_search_linear_scan mean_us=" << scanUs << " results=" << results << endl;
+}
+
+// Times loading and querying a city_pollution_data.csv of any size
+// (Benchmarks/gen_data writes them). Lookups and completions use the
+// file's own names; completion runs at most 100k prefix queries.
+void benchmarkAlgorithms(const string& csv) {
+    const int completeCap = 100000;
+    AreaTable table;
+    bool ok = true;
+    double ms = timeMs([&] { ok = loadCSV(csv, table); });
+    if (!ok) return;
+    int n = table.names.size();
+    reportAlgorithm("app", "loadCSV", n, ms);
+    if (n == 0) return;
+
+    {
+        QuietCout quiet;
+        ms = timeMs([&] { for (auto& name : table.names) displayInfo(table, name, cout); });
+    }
+    reportAlgorithm("app", "displayInfo", n, ms);
+
+    // The name lookup alone: lowercase into a reused key, then the
+    // interner probe, as displayInfo does before it formats anything
+    string key;
+    long long found = 0;
+    ms = timeMs([&] {
+        for (auto& name : table.names) {
+            key.assign(name.data(), name.size());
+            transform(key.begin(), key.end(), key.begin(), ::tolower);
+            found += table.find(key) >= 0;
+        }
+    });
+    reportAlgorithm("app", "AreaTable::find", n, ms);
+    if (found != n) cerr << "AreaTable::find missed " << n - found << " names\n";
+
+    int queries = min(n, completeCap);
+    long long results = 0;
+    ms = timeMs([&] {
+        for (int q = 0; q < queries; q++)
+            results += table.index.complete(table.names[q].substr(0, 3), 10).size();
+    });
+    reportAlgorithm("app", "AreaIndex::complete", queries, ms, n);
+    reportMetricsOverhead("app");
+}
+
+// ---------------- Server mode ----------------
+
+// Read-copy-update of the live table. A reader publishes the current
+// epoch in its own slot while it uses the table (two stores, no lock,
+// never waits); a writer swaps the pointer, bumps the epoch and waits
+// until every busy slot shows the new epoch before handing the old
+// table back to be freed.
+class TableRCU {
+public:
+    static const int MaxReaders = 1024;
+
+    explicit TableRCU(const AreaTable* initial) : current(initial) {}
+
+    // One slot per reader thread, held for the thread's lifetime
+    int registerReader() {
+        lock_guard<mutex> lock(slotLock);
+        if (freeSlots.empty()) return used < MaxReaders ? used++ : -1;
+        int s = freeSlots.back();
+        freeSlots.pop_back();
+        return s;
+    }
+
+    void unregisterReader(int slot) {
+        lock_guard<mutex> lock(slotLock);
+        freeSlots.push_back(slot);
+    }
+
+    const AreaTable* read(int slot) {
+        slots[slot].epoch.store(epoch.load());
+        return current.load();
+    }
+
+    void done(int slot) { slots[slot].epoch.store(0); }
+
+    // Installs t and returns the previous table once no reader can hold it
+    const AreaTable* publish(const AreaTable* t) {
+        lock_guard<mutex> lock(writeLock);
+        const AreaTable* old = current.exchange(t);
+        uint64_t e = epoch.fetch_add(1) + 1;
+        int n = used;
+        for (int i = 0; i < n; i++) {
+            uint64_t seen;
+            while ((seen = slots[i].epoch.load()) != 0 && seen < e)
+                this_thread::yield();
+        }
+        swaps++;
+        return old;
+    }
+
+    const AreaTable* get() const { return current.load(); }
+    long long swapCount() const { return swaps; }
+
+private:
+    struct alignas(64) Slot { atomic<uint64_t> epoch{0}; };
+
+    atomic<const AreaTable*> current;
+    atomic<uint64_t> epoch{1};
+    Slot slots[MaxReaders];
+    mutex slotLock, writeLock;
+    vector<int> freeSlots;
+    atomic<int> used{0};
+    atomic<long long> swaps{0};
+};
+
+// One request line in, one framed response out: "<bytes>\n<payload>".
+//   GET <area>                 the same report as the interactive app
+//   COMPLETE <n> <prefix>      up to n areas, "name\tseverity" per line
+string answer(const AreaTable& table, const string& line) {
+    ostringstream out;
+    if (line.compare(0, 4, "GET ") == 0) {
+        displayInfo(table, line.substr(4), out);
+    } else if (line.compare(0, 9, "COMPLETE ") == 0) {
+        size_t sp = line.find(' ', 9);
+        int n = atoi(line.c_str() + 9);
+        string prefix = sp == string::npos ? "" : line.substr(sp + 1);
+        StageTimer timer(StageSearch, 1, true);
+        vector<int> hits = table.index.complete(prefix, n);
+        if (hits.empty()) hits = table.index.completeFuzzy(prefix, n);
+        for (int id : hits)
+            out << table.names[id] << "\t" << table.severity[id] << "\n";
+    } else {
+        out << "ERROR unknown request\n";
+    }
+    string body = out.str();
+    return to_string(body.size()) + "\n" + body;
+}
+
+bool writeAll(int fd, const string& s) {
+    for (size_t done = 0; done < s.size(); ) {
+        ssize_t k = write(fd, s.data() + done, s.size() - done);
+        if (k <= 0) return false;
+        done += k;
+    }
+    return true;
+}
+
+// Serves one connection until the client hangs up. The table is pinned
+// only while a request is answered, never while waiting for input.
+void serveClient(TableRCU& rcu, int fd) {
+    int slot = rcu.registerReader();
+    if (slot < 0) { close(fd); return; }
+    string buf;
+    char chunk[4096];
+    while (true) {
+        size_t nl;
+        while ((nl = buf.find('\n')) == string::npos) {
+            ssize_t k = read(fd, chunk, sizeof(chunk));
+            if (k <= 0) { rcu.unregisterReader(slot); close(fd); return; }
+            buf.append(chunk, k);
+        }
+        string line = buf.substr(0, nl);
+        buf.erase(0, nl + 1);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        const AreaTable* table = rcu.read(slot);
+        string reply = answer(*table, line);
+        rcu.done(slot);
+        if (!writeAll(fd, reply)) break;
+    }
+    rcu.unregisterReader(slot);
+    close(fd);
+}
+
+int listenUnix(const string& path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (fd < 0 || path.size() >= sizeof(addr.sun_path)) return -1;
+    strcpy(addr.sun_path, path.c_str());
+    unlink(path.c_str());
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 128) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int connectUnix(const string& path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path.c_str());
+    if (fd >= 0 && connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) { close(fd); return -1; }
+    return fd;
+}
+
+// One thread per connection, detached unless the caller collects them in
+// workers to join before its TableRCU goes away. Returns once accept()
+// fails, e.g. after shutdown() on the listener.
+void acceptLoop(TableRCU& rcu, int listener, vector<thread>* workers = nullptr) {
+    while (true) {
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        thread worker(serveClient, ref(rcu), fd);
+        if (workers) workers->push_back(move(worker));
+        else worker.detach();
+    }
+}
+
+// Nanosecond mtime, so two saves within the same second both reload
+timespec modifiedAt(const string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? st.st_mtim : timespec{0, 0};
+}
+
+// Serves lookups on a Unix socket; the CSV is reloaded in the background
+// when its modification time changes and swapped in without stopping
+// the readers
+int serve(const string& csv, const string& path) {
+    AreaTable* first = new AreaTable;
+    if (!loadCSV(csv, *first)) return 1;
+    TableRCU rcu(first);
+
+    int listener = listenUnix(path);
+    if (listener < 0) {
+        cerr << "Cannot listen on " << path << endl;
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    cout << "Serving " << first->names.size() << " areas on " << path << endl;
+
+    thread([&rcu, csv]() {
+        timespec seen = modifiedAt(csv);
+        while (true) {
+            this_thread::sleep_for(chrono::seconds(1));
+            timespec now = modifiedAt(csv);
+            if (now.tv_sec == seen.tv_sec && now.tv_nsec == seen.tv_nsec) continue;
+            seen = now;
+            AreaTable* fresh = new AreaTable;
+            if (!loadCSV(csv, *fresh)) { delete fresh; continue; }
+            delete rcu.publish(fresh);
+            cout << "Reloaded " << fresh->names.size() << " areas" << endl;
+        }
+    }).detach();
+
+    acceptLoop(rcu, listener);
+    return 0;
+}
+
+// Reads one framed response
+bool readReply(int fd, string& buf, string& body) {
+    char chunk[4096];
+    size_t nl;
+    while ((nl = buf.find('\n')) == string::npos) {
+        ssize_t k = read(fd, chunk, sizeof(chunk));
+        if (k <= 0) return false;
+        buf.append(chunk, k);
+    }
+    size_t len = atol(buf.c_str());
+    while (buf.size() < nl + 1 + len) {
+        ssize_t k = read(fd, chunk, sizeof(chunk));
+        if (k <= 0) return false;
+        buf.append(chunk, k);
+    }
+    body = buf.substr(nl + 1, len);
+    buf.erase(0, nl + 1 + len);
+    return true;
+}
+
+AreaTable* syntheticTable(const vector<string>& names, uint32_t seed) {
+    static const char* risk[] = {"Low", "Medium", "High"};
+    AreaTable* t = new AreaTable;
+    for (auto& name : names) {
+        seed = seed * 1664525u + 1013904223u;
+        PollutionData d;
+        d.airAQI = 30 + (seed >> 8) % 250;
+        d.waterPollution = (seed >> 12) % 100;
+        d.landQuality = 20 + (seed >> 16) % 80;
+        d.floodRisk = risk[(seed >> 20) % 3];
+        d.industrialRisk = risk[(seed >> 24) % 3];
+        t->add(name, d);
+    }
+    t->finish("app_rules.txt");
+    return t;
+}
+
+// Load generator: an in-process server over synthetic areas, two table
+// versions swapped every 50 ms, and client threads each on their own
+// connection sending 90% GET / 10% COMPLETE as fast as answers arrive
+void benchmarkServer(int areas, const vector<int>& threadCounts, double seconds) {
+    vector<string> names = syntheticAreas(areas, 7);
+    const AreaTable* tables[2] = {syntheticTable(names, 1), syntheticTable(names, 2)};
+    TableRCU rcu(tables[0]);
+
+    string path = "/tmp/app_bench_" + to_string(getpid()) + ".sock";
+    int listener = listenUnix(path);
+    if (listener < 0) {
+        cerr << "Cannot listen on " << path << endl;
+        delete tables[0];
+        delete tables[1];
+        return;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    vector<thread> workers;
+    thread acceptor(acceptLoop, ref(rcu), listener, &workers);
+
+    atomic<bool> swapping{true};
+    thread swapper([&]() {
+        for (int v = 1; swapping; v ^= 1) {
+            this_thread::sleep_for(chrono::milliseconds(50));
+            rcu.publish(tables[v]);
+        }
+    });
+
+    for (int threads : threadCounts) {
+        vector<vector<double>> lat(threads);
+        vector<long long> failures(threads, 0);
+        long long swaps0 = rcu.swapCount();
+        atomic<bool> stop{false};
+        vector<thread> clients;
+        auto t0 = chrono::steady_clock::now();
+        for (int c = 0; c < threads; c++) {
+            clients.emplace_back([&, c]() {
+                int fd = connectUnix(path);
+                if (fd < 0) { failures[c]++; return; }
+                uint32_t seed = 100 + c;
+                string buf, body;
+                while (!stop) {
+                    seed = seed * 1664525u + 1013904223u;
+                    const string& name = names[(seed >> 8) % names.size()];
+                    string req = (seed >> 4) % 10 == 0 ? "COMPLETE 10 " + name.substr(0, 3) + "\n" : "GET " + name + "\n";
+                    auto a = chrono::steady_clock::now();
+                    if (!writeAll(fd, req) || !readReply(fd, buf, body) || body.empty()) { failures[c]++; break; }
+                    lat[c].push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - a).count());
+                }
+                close(fd);
+            });
+        }
+        this_thread::sleep_for(chrono::duration<double>(seconds));
+        stop = true;
+        for (auto& t : clients) t.join();
+        double elapsed = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+        vector<double> all;
+        long long failed = 0;
+        for (int c = 0; c < threads; c++) {
+            all.insert(all.end(), lat[c].begin(), lat[c].end());
+            failed += failures[c];
+        }
+        if (all.empty()) { cerr << "No requests completed" << endl; break; }
+        size_t requests = all.size();
+        cout << "bench=app_server areas=" << areas << " threads=" << threads
+             << " requests=" << requests << " req_per_s=" << requests / elapsed
+             << " " << latencySummary(all)
+             << " swaps=" << rcu.swapCount() - swaps0 << " failed=" << failed << endl;
+    }
+
+    swapping = false;
+    swapper.join();
+    // Every client has hung up by now, so once accept() is woken the
+    // connection threads are all on their way out; join them before rcu
+    // and the tables go
+    shutdown(listener, SHUT_RDWR);
+    acceptor.join();
+    for (auto& t : workers) t.join();
+    close(listener);
+    unlink(path.c_str());
+    delete tables[0];
+    delete tables[1];
+}
+
+/*
+ Usage:
+   app                      interactive lookup of one area
+   app complete <prefix> [n]
+                            top-n areas starting with prefix (one typo allowed
+                            when nothing matches exactly), most polluted first
+   app serve [socket]       answer GET / COMPLETE requests on a Unix socket
+                            (default /tmp/pollution_app.sock), reloading
+                            city_pollution_data.csv when it changes
+   app bench-search [names] [queries]
+                            prefix index latency over synthetic area names
+   app bench-server [areas] [seconds] [threads...]
+                            server throughput and latency per client thread count
+   app bench-algorithms <csv>
+                            time loading, lookups and completion on <csv>
+
+ Any mode also exports per-stage counters and latency histograms when
+ METRICS_OUT=<file|unix:path> is set (see common/metrics.h); with
+ METRICS_INTERVAL=<sec> the server refreshes it while running.
+*/
+int main(int argc, char* argv[]) {
+    metricsExportAtExit("app");
+    string mode = argc > 1 ? argv[1] : "";
+
+    if (mode == "bench-search") {
+        benchmarkSearch(argc > 2 ? atoi(argv[2]) : 1000000, argc > 3 ? atoi(argv[3]) : 200000);
+        return 0;
+    }
+    if (mode == "bench-server") {
+        vector<int> threads;
+        for (int i = 4; i < argc; i++) threads.push_back(atoi(argv[i]));
+        if (threads.empty()) threads = {1, 2, 4, 8};
+        benchmarkServer(argc > 2 ? atoi(argv[2]) : 100000, threads, argc > 3 ? atof(argv[3]) : 2);
+        return 0;
+    }
+    if (mode == "bench-algorithms" && argc > 2) {
+        benchmarkAlgorithms(argv[2]);
+        return 0;
+    }
+    if (mode == "serve")
+        return serve("city_pollution_data.csv", argc > 2 ? argv[2] : "/tmp/pollution_app.sock");
+
+    AreaTable table;
+    if (!loadCSV("city_pollution_data.csv", table))
+        return 1;
+
+    if (mode == "complete" && argc > 2) {
+        int n = argc > 3 ? atoi(argv[3]) : 5;
+        vector<int> hits = table.index.complete(argv[2], n);
+        if (hits.empty()) hits = table.index.completeFuzzy(argv[2], n);
+        for (int id : hits)
+            cout << table.names[id] << " (severity " << table.severity[id] << ")\n";
+        return 0;
+    }
+    if (!mode.empty()) {
+        cerr << "Usage: app [complete <prefix> [n] | serve [socket] | bench-search [names] [queries]\n"
+                "           | bench-server [areas] [seconds] [threads...] | bench-algorithms <csv>]\n";
+        return 1;
+    }
 
     cout << "🌍 Smart City Pollution Monitoring System\n";
     cout << "-----------------------------------------\n";
@@ -100,7 +1142,7 @@ int main() {
     cout << "Enter your area name: ";
     getline(cin, area);
 
-    displayInfo(area);
+    displayInfo(table, area, cout);
 
     return 0;
 }
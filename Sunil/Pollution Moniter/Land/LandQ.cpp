@@ -1,10 +1,17 @@
 #include <bits/stdc++.h>
+#include "../../common/mapped_csv.h"
+#include "../../common/column_snapshot.h"
+#include "../../common/rolling_stats.h"
+#include "../../common/rule_engine.h"
+#include "../../common/bench_timer.h"
+#include "../../common/metrics.h"
+#include "../../common/intern.h"
 using namespace std;
 
 // Structure to store subzone information
 struct Subzone {
-    string zone;
-    string name;
+    ZoneId zone;    // interned names (intern.h), copied into queues as ids
+    ZoneId name;
     double pollution;
     double soilToxicity;
     double moisture;
@@ -25,6 +32,7 @@ struct ComparePriority {
 // Bellman-Ford for spike detection in pollution or toxicity
 bool bellmanFord(vector<vector<double>>& graph, vector<Subzone>& subzones, int start) {
     int n = subzones.size();
+    StageTimer timer(StageSearch, n);
     vector<double> dist(n, 1e9);
     dist[start] = 0;
     
@@ -52,6 +60,7 @@ bool bellmanFord(vector<vector<double>>& graph, vector<Subzone>& subzones, int s
 // Dijkstra for shortest path for waste collection
 vector<int> dijkstra(vector<vector<double>>& graph, int start) {
     int n = graph.size();
+    StageTimer timer(StageSearch, n);
     vector<double> dist(n, 1e9);
     vector<int> parent(n, -1);
     dist[start] = 0;
@@ -76,64 +85,1037 @@ vector<int> dijkstra(vector<vector<double>>& graph, int start) {
     return parent;
 }
 
+// Road network between subzones in CSR form: the roads leaving subzone u
+// are to[start[u]] .. to[start[u+1]-1] with lengths in length[]
+struct RoadNetwork {
+    int n = 0;
+    vector<int> start, to;
+    vector<double> length;
+
+    size_t bytes() const {
+        return start.size()*sizeof(int) + to.size()*sizeof(int) + length.size()*sizeof(double);
+    }
+};
+
+struct Road {
+    int from, to;
+    double length;
+};
+
+// Two-way roads, counting sort by source subzone
+RoadNetwork buildRoadNetwork(int n, const vector<Road>& roads){
+    RoadNetwork g;
+    g.n = n;
+    g.start.assign(n+1, 0);
+    for(auto &r: roads){ g.start[r.from+1]++; g.start[r.to+1]++; }
+    for(int i=0;i<n;i++) g.start[i+1] += g.start[i];
+    g.to.resize(g.start[n]);
+    g.length.resize(g.start[n]);
+    vector<int> fill(g.start.begin(), g.start.end()-1);
+    for(auto &r: roads){
+        int k = fill[r.from]++;
+        g.to[k] = r.to; g.length[k] = r.length;
+        k = fill[r.to]++;
+        g.to[k] = r.from; g.length[k] = r.length;
+    }
+    return g;
+}
+
+// Edge list file: From,To,Distance with subzone names; unknown names are skipped
+RoadNetwork loadRoadNetwork(const string& filename, const vector<Subzone>& subzones){
+    NameIndex index;
+    for(auto &sz: subzones) index.add(sz.name, sz.index);
+
+    MappedCSV file(filename);
+    CSVRow row;
+    vector<Road> roads;
+    if(file.isOpen()){
+        file.skipLine(); // skip header
+        while(file.nextRow(row)){
+            int a = index.find(row[0]), b = index.find(row[1]);
+            if(a < 0 || b < 0) continue;
+            roads.push_back({a, b, row.toDouble(2)});
+        }
+    }
+    return buildRoadNetwork(subzones.size(), roads);
+}
+
+struct ShortestPaths {
+    vector<double> dist;    // 1e9 = unreachable, as in dijkstra()
+    vector<int> parent;
+};
+
+// Binary-heap Dijkstra over the CSR roads, O((V+E) log V)
+ShortestPaths dijkstraCSR(const RoadNetwork& g, int start){
+    StageTimer timer(StageSearch, g.n);
+    ShortestPaths sp;
+    sp.dist.assign(g.n, 1e9);
+    sp.parent.assign(g.n, -1);
+    priority_queue<pair<double,int>, vector<pair<double,int>>, greater<pair<double,int>>> pq;
+    sp.dist[start] = 0;
+    pq.push({0, start});
+
+    while(!pq.empty()){
+        auto [d, u] = pq.top(); pq.pop();
+        if(d > sp.dist[u]) continue; // stale entry
+        for(int k=g.start[u];k<g.start[u+1];k++){
+            int v = g.to[k];
+            double nd = d + g.length[k];
+            if(nd < sp.dist[v]){
+                sp.dist[v] = nd;
+                sp.parent[v] = u;
+                pq.push({nd, v});
+            }
+        }
+    }
+    return sp;
+}
+
+// Subzones from start to v along the parent pointers; empty if unreachable
+vector<int> pathTo(const ShortestPaths& sp, int v){
+    vector<int> path;
+    if(sp.dist[v] >= 1e9) return path;
+    for(int cur=v; cur!=-1; cur=sp.parent[cur]) path.push_back(cur);
+    reverse(path.begin(), path.end());
+    return path;
+}
+
 // Compute Land Quality
 double computeLandQuality(double pollution, double soilTox, double heavyMetal){
     return 100 - (0.5*pollution + 0.3*soilTox + 0.2*heavyMetal);
 }
 
-int main() {
-    ifstream file("land_pollution_data.csv");
-    string line;
+// Read subzones from CSV
+vector<Subzone> readCSV(const string& filename) {
+    MappedCSV file(filename);
+    CSVRow row;
     vector<Subzone> subzones;
     
-    getline(file, line); // skip header
+    if(!file.isOpen()){
+        cerr << "Error opening file: " << filename << endl;
+        exit(1);
+    }
+    StageTimer timer(StageParse);
+    file.skipLine(); // skip header
     int index = 0;
+    subzones.reserve(file.estimateRows());
     
-    // Read CSV data
-    while(getline(file, line)){
-        stringstream ss(line);
-        string zone, name;
-        double pollution, soil, moisture, heavy;
-        getline(ss, zone, ',');
-        getline(ss, name, ',');
-        ss >> pollution;
-        ss.ignore();
-        ss >> soil;
-        ss.ignore();
-        ss >> moisture;
-        ss.ignore();
-        ss >> heavy;
-        ss.ignore();
+    while(file.nextRow(row)){
         Subzone sz;
-        sz.zone = zone;
-        sz.name = name;
-        sz.pollution = pollution;
-        sz.soilToxicity = soil;
-        sz.moisture = moisture;
-        sz.heavyMetal = heavy;
-        sz.landQuality = computeLandQuality(pollution, soil, heavy);
+        sz.zone = ZoneId(row[0]);
+        sz.name = ZoneId(row[1]);
+        sz.pollution = row.toDouble(2);
+        sz.soilToxicity = row.toDouble(3);
+        sz.moisture = row.toDouble(4);
+        sz.heavyMetal = row.toDouble(5);
+        sz.landQuality = computeLandQuality(sz.pollution, sz.soilToxicity, sz.heavyMetal);
         sz.index = index++;
         subzones.push_back(sz);
     }
-    
-    // Build adjacency matrix for distances (example, replace with actual distances)
-    int n = subzones.size();
-    vector<vector<double>> graph(n, vector<double>(n, 1e9));
+    timer.addItems(subzones.size());
+    return subzones;
+}
+
+// Columnar snapshot: zone, name (dictionary) + the four readings (float64)
+bool writeSnapshot(const vector<Subzone>& subzones, const string& filename) {
+    vector<string> zone, name;
+    vector<double> pollution, soil, moisture, heavy;
+    for(auto &sz: subzones){
+        zone.push_back(sz.zone.str());
+        name.push_back(sz.name.str());
+        pollution.push_back(sz.pollution);
+        soil.push_back(sz.soilToxicity);
+        moisture.push_back(sz.moisture);
+        heavy.push_back(sz.heavyMetal);
+    }
+    SnapshotWriter w(subzones.size());
+    w.addStrings("zone", zone);
+    w.addStrings("name", name);
+    w.addFloat64("pollution", pollution);
+    w.addFloat64("soilToxicity", soil);
+    w.addFloat64("moisture", moisture);
+    w.addFloat64("heavyMetal", heavy);
+    return w.write(filename);
+}
+
+bool readSnapshot(const string& filename, vector<Subzone>& subzones) {
+    MappedSnapshot snap;
+    if(!snap.open(filename)) return false;
+    DictColumn zone = snap.dictColumn("zone");
+    DictColumn name = snap.dictColumn("name");
+    const double* pollution = snap.float64Column("pollution");
+    const double* soil = snap.float64Column("soilToxicity");
+    const double* moisture = snap.float64Column("moisture");
+    const double* heavy = snap.float64Column("heavyMetal");
+    if(!zone.codes || !name.codes || !pollution || !soil || !moisture || !heavy) return false;
+
+    StageTimer timer(StageParse, snap.rows());
+    // Each dictionary entry is interned once; rows copy the ids
+    vector<ZoneId> zoneIds(zone.count), nameIds(name.count);
+    for(uint32_t c=0;c<zone.count;c++) zoneIds[c] = ZoneId(zone.value(c));
+    for(uint32_t c=0;c<name.count;c++) nameIds[c] = ZoneId(name.value(c));
+    subzones.resize(snap.rows());
+    for(size_t i=0;i<snap.rows();i++){
+        Subzone& sz = subzones[i];
+        sz.zone = zoneIds[zone.codes[i]];
+        sz.name = nameIds[name.codes[i]];
+        sz.pollution = pollution[i];
+        sz.soilToxicity = soil[i];
+        sz.moisture = moisture[i];
+        sz.heavyMetal = heavy[i];
+        sz.landQuality = computeLandQuality(sz.pollution, sz.soilToxicity, sz.heavyMetal);
+        sz.index = (int)i;
+    }
+    return true;
+}
+
+// Use <csv>.snap when it is newer than the CSV
+vector<Subzone> loadSubzones(const string& filename) {
+    vector<Subzone> subzones;
+    if(snapshotIsFresh(filename + ".snap", filename) && readSnapshot(filename + ".snap", subzones))
+        return subzones;
+    return readCSV(filename);
+}
+
+// Rolling per-subzone statistics for the readings that drive land quality
+struct LandSpikeMonitor {
+    SpikeDetector pollution, soilToxicity, heavyMetal;
+    LandSpikeMonitor(int n) : pollution(n), soilToxicity(n), heavyMetal(n) {}
+};
+
+string spikeReason(int flags){
+    string r;
+    if(flags & SpikeZScore) r += " z-score";
+    if(flags & SpikeEwma) r += " above-EWMA";
+    if(flags & SpikeRate) r += " rate";
+    return r;
+}
+
+void reportSpike(const Subzone& sz, const char* what, SpikeDetector& d, double t, int flags){
+    cout << "SPIKE: " << sz.zone << "/" << sz.name << " " << what << " " << d.last(sz.index)
+         << " at t=" << t << " (mean " << d.mean(sz.index) << ", sd " << d.stddev(sz.index) << ")"
+         << spikeReason(flags) << endl;
+}
+
+// Readings file: Subzone,Time,PollutionLevel,SoilToxicity,Moisture,HeavyMetalIndex
+// (time in seconds), subzones matched by name
+void detectSpikes(const vector<Subzone>& subzones, const string& filename){
+    NameIndex index;
+    for(auto &sz: subzones) index.add(sz.name, sz.index);
+
+    MappedCSV file(filename);
+    CSVRow row;
+    if(!file.isOpen()){
+        cerr << "Error opening file: " << filename << endl;
+        exit(1);
+    }
+    file.skipLine(); // skip header
+
+    LandSpikeMonitor monitor(subzones.size());
+    long long readings = 0, unknown = 0, spikes = 0;
+    StageTimer timer(StageAlerts);
+    cout << "Streaming spike detection:" << endl;
+    while(file.nextRow(row)){
+        int s = index.find(row[0]);
+        if(s < 0){ unknown++; continue; }
+        const Subzone& sz = subzones[s];
+        double t = row.toDouble(1);
+        readings++;
+
+        int pf = monitor.pollution.add(sz.index, t, row.toFloat(2));
+        int sf = monitor.soilToxicity.add(sz.index, t, row.toFloat(3));
+        int hf = monitor.heavyMetal.add(sz.index, t, row.toFloat(5));
+        if(pf){ spikes++; reportSpike(sz, "pollution", monitor.pollution, t, pf); }
+        if(sf){ spikes++; reportSpike(sz, "soil toxicity", monitor.soilToxicity, t, sf); }
+        if(hf){ spikes++; reportSpike(sz, "heavy metal", monitor.heavyMetal, t, hf); }
+    }
+    timer.addItems(readings);
+    cout << readings << " readings, " << spikes << " spikes";
+    if(unknown) cout << ", " << unknown << " readings for unknown subzones skipped";
+    cout << endl;
+}
+
+// n subzones reporting at 1 Hz for `seconds`, three quantities each
+void benchmarkSpikes(int n, int seconds){
+    vector<float> base(n);
+    uint32_t seed = 5;
     for(int i=0;i<n;i++){
-        for(int j=0;j<n;j++){
-            if(i==j) graph[i][j] = 0;
-            else graph[i][j] = 1; // placeholder distance, replace with actual
+        seed = seed*1664525u + 1013904223u;
+        base[i] = 10 + seed%70;
+    }
+
+    LandSpikeMonitor monitor(n);
+    long long spikes = 0;
+    double worstTickMs = 0;
+    auto t0 = chrono::steady_clock::now();
+    for(int t=0;t<seconds;t++){
+        auto tick = chrono::steady_clock::now();
+        for(int i=0;i<n;i++){
+            seed = seed*1664525u + 1013904223u;
+            float noise = (int)(seed>>20)%200/100.0f - 1.0f;
+            float pol = base[i] + noise;
+            if(seed%10000 == 0) pol *= 3;
+            spikes += monitor.pollution.add(i, t, pol) != 0;
+            spikes += monitor.soilToxicity.add(i, t, base[i]*0.6f + noise) != 0;
+            spikes += monitor.heavyMetal.add(i, t, base[i]*0.4f + noise) != 0;
         }
+        worstTickMs = max(worstTickMs, chrono::duration<double,milli>(chrono::steady_clock::now()-tick).count());
     }
-    
-    // Detect sudden spikes using Bellman-Ford
-    bool spikeDetected = bellmanFord(graph, subzones, 0);
-    if(spikeDetected) cout << "⚠️ Spike detected in pollution or soil toxicity!" << endl;
+    double sec = chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+    long long readings = (long long)n*seconds;
+
+    cout << "bench=land_spikes subzones=" << n
+         << " seconds=" << seconds
+         << " readings=" << readings
+         << " total_s=" << sec
+         << " readings_per_s=" << readings/sec
+         << " ns_per_reading=" << sec*1e9/readings
+         << " worst_tick_ms=" << worstTickMs
+         << " bytes_per_subzone=" << 3*monitor.pollution.bytesPerStream()
+         << " spikes=" << spikes << endl;
+}
+
+// Synthetic district: n collection points on a jittered grid, each joined
+// to its right and lower neighbours and to every other diagonal
+vector<Road> generateRoads(int n, uint32_t seed){
+    int side = max(1, (int)ceil(sqrt((double)n)));
+    vector<Road> roads;
+    auto len = [&](){
+        seed = seed*1664525u + 1013904223u;
+        return 0.5 + (seed>>8)%1500/1000.0;
+    };
+    for(int v=0;v<n;v++){
+        int x = v%side, y = v/side;
+        if(x+1<side && v+1<n) roads.push_back({v, v+1, len()});
+        if(v+side<n) roads.push_back({v, v+side, len()});
+        if((x+y)%2==0 && x+1<side && v+side+1<n) roads.push_back({v, v+side+1, 1.4*len()});
+    }
+    return roads;
+}
+
+void benchmarkRouting(const vector<int>& sizes){
+    for(int n: sizes){
+        vector<Road> roads = generateRoads(n, 3);
+
+        auto t0 = chrono::steady_clock::now();
+        RoadNetwork g = buildRoadNetwork(n, roads);
+        double buildMs = chrono::duration<double,milli>(chrono::steady_clock::now()-t0).count();
+
+        t0 = chrono::steady_clock::now();
+        ShortestPaths sp = dijkstraCSR(g, 0);
+        double sparseMs = chrono::duration<double,milli>(chrono::steady_clock::now()-t0).count();
+        double farthest = 0;
+        for(double d: sp.dist) if(d < 1e9) farthest = max(farthest, d);
+
+        // The n x n matrix is only built where it fits comfortably in RAM
+        double denseBytes = (double)n*n*sizeof(double);
+        string denseMs = "skipped", match = "n/a";
+        if(n <= 5000){
+            vector<vector<double>> graph(n, vector<double>(n, 1e9));
+            for(int i=0;i<n;i++) graph[i][i] = 0;
+            for(auto &r: roads) graph[r.from][r.to] = graph[r.to][r.from] = r.length;
+            t0 = chrono::steady_clock::now();
+            vector<int> parent = dijkstra(graph, 0);
+            denseMs = to_string(chrono::duration<double,milli>(chrono::steady_clock::now()-t0).count());
+            bool same = true;
+            for(int v=0;v<n && same;v++){
+                double d = 0;
+                for(int cur=v; parent[cur]!=-1; cur=parent[cur]) d += graph[parent[cur]][cur];
+                same = fabs(d - sp.dist[v]) < 1e-6;
+            }
+            match = same ? "yes" : "no";
+        }
+
+        cout << "bench=land_routing subzones=" << n
+             << " roads=" << roads.size()
+             << " csr_bytes=" << g.bytes()
+             << " csr_build_ms=" << buildMs
+             << " dijkstra_csr_ms=" << sparseMs
+             << " farthest=" << farthest
+             << " dense_matrix_bytes=" << denseBytes
+             << " dijkstra_dense_ms=" << denseMs
+             << " same_distances=" << match << endl;
+    }
+}
+
+// ---------------- Multi-truck waste collection routing ----------------
+
+// Road distances between collection stops. Every stop keeps its k
+// nearest stops (bounded Dijkstra) and the depot distance of every stop
+// is known. Road nodes also carry distances to a few landmarks, giving
+// a cheap lower bound |d(L,a) - d(L,b)| on any pair (triangle
+// inequality). All of it is shared and read-only once built.
+struct StopNeighbours {
+    int stops = 0, k = 0;
+    vector<int> nearest;        // stops*k stop ids, -1 padded
+    vector<double> nearestDist;
+    vector<double> fromDepot;
+    int landmarks = 0;
+    vector<float> landmarkDist; // node*landmarks + l
+};
+
+// Farthest-first landmarks from the depot; roads are two-way so one
+// search per landmark gives both directions
+void buildLandmarks(const RoadNetwork& g, int depot, int count, StopNeighbours& nb){
+    nb.landmarks = count;
+    nb.landmarkDist.assign((size_t)g.n*count, 0);
+    vector<double> nearestLandmark = dijkstraCSR(g, depot).dist;
+    for(int l=0;l<count;l++){
+        int far = depot;
+        for(int v=0;v<g.n;v++)
+            if(nearestLandmark[v] < 1e9 && nearestLandmark[v] > nearestLandmark[far]) far = v;
+        ShortestPaths sp = dijkstraCSR(g, far);
+        for(int v=0;v<g.n;v++){
+            nb.landmarkDist[(size_t)v*count+l] = sp.dist[v] < 1e9 ? sp.dist[v] : 0;
+            if(l == 0) nearestLandmark[v] = sp.dist[v];
+            else nearestLandmark[v] = min(nearestLandmark[v], sp.dist[v]);
+        }
+    }
+}
+
+// A* with the landmark bound over a reusable, stamp-cleared workspace:
+// bounded searches for the neighbour lists and early-exit point-to-point
+// queries with a cache for the pairs the neighbour lists do not cover.
+// One per thread.
+class RoadDistance {
+public:
+    RoadDistance(const RoadNetwork& g, const vector<int>& stopNode, const StopNeighbours* nb)
+        : g(g), stopNode(stopNode), nb(nb), dist(g.n, 0), seen(g.n, 0), stamp(0) {}
+
+    // The k nearest stops of stop s (nodeStop maps road node -> stop or -1)
+    void nearestStops(int s, int k, const vector<int>& nodeStop, int* outStop, double* outDist){
+        int found = 0;
+        begin(stopNode[s]);
+        while(!pq.empty() && found < k){
+            auto [d, u] = pq.top(); pq.pop();
+            if(d > dist[u]) continue;
+            int t = nodeStop[u];
+            if(t >= 0 && t != s){ outStop[found] = t; outDist[found] = d; found++; }
+            relax(u, d);
+        }
+        for(;found<k;found++){ outStop[found] = -1; outDist[found] = 1e9; }
+    }
+
+    double between(int a, int b){
+        if(a == b) return 0;
+        for(int i=0;i<nb->k;i++){
+            if(nb->nearest[a*nb->k+i] == b) return nb->nearestDist[a*nb->k+i];
+            if(nb->nearest[b*nb->k+i] == a) return nb->nearestDist[b*nb->k+i];
+        }
+        uint64_t key = a < b ? (uint64_t)a<<32 | b : (uint64_t)b<<32 | a;
+        auto it = cache.find(key);
+        if(it != cache.end()) return it->second;
+
+        double result = 1e9;
+        int target = stopNode[b];
+        begin(stopNode[a], lowerBound(stopNode[a], target));
+        while(!pq.empty()){
+            auto [f, u] = pq.top(); pq.pop();
+            double d = dist[u];
+            if(f > d + lowerBound(u, target) + 1e-9) continue; // stale entry
+            if(u == target){ result = d; break; }
+            for(int e=g.start[u];e<g.start[u+1];e++){
+                int v = g.to[e];
+                double nd = d + g.length[e];
+                if(seen[v] != stamp || nd < dist[v]){
+                    seen[v] = stamp; dist[v] = nd;
+                    pq.push({nd + lowerBound(v, target), v});
+                }
+            }
+        }
+        cache[key] = result;
+        return result;
+    }
+
+    // Lower bound on the road distance between two road nodes
+    double lowerBound(int u, int v) const {
+        const float* a = &nb->landmarkDist[(size_t)u*nb->landmarks];
+        const float* b = &nb->landmarkDist[(size_t)v*nb->landmarks];
+        float best = 0;
+        for(int l=0;l<nb->landmarks;l++) best = max(best, fabs(a[l]-b[l]));
+        return best;
+    }
+
+    size_t searches() const { return cache.size(); }
+
+private:
+    const RoadNetwork& g;
+    const vector<int>& stopNode;
+    const StopNeighbours* nb;
+    vector<double> dist;
+    vector<int> seen;
+    int stamp;
+    priority_queue<pair<double,int>, vector<pair<double,int>>, greater<pair<double,int>>> pq;
+    unordered_map<uint64_t,double> cache;
+
+    void begin(int src, double key = 0){
+        stamp++;
+        pq = decltype(pq)();
+        seen[src] = stamp; dist[src] = 0;
+        pq.push({key, src});
+    }
+    void relax(int u, double d){
+        for(int e=g.start[u];e<g.start[u+1];e++){
+            int v = g.to[e];
+            double nd = d + g.length[e];
+            if(seen[v] != stamp || nd < dist[v]){
+                seen[v] = stamp; dist[v] = nd;
+                pq.push({nd, v});
+            }
+        }
+    }
+};
+
+// Runs fn(thread, item) for items [0, n) on `threads` threads
+template<class F> void parallelFor(int n, int threads, F fn){
+    if(threads <= 1){ for(int i=0;i<n;i++) fn(0, i); return; }
+    atomic<int> nextItem(0);
+    vector<thread> pool;
+    for(int t=0;t<threads;t++)
+        pool.emplace_back([&, t](){
+            for(int i; (i = nextItem++) < n; ) fn(t, i);
+        });
+    for(auto &th: pool) th.join();
+}
+
+struct FleetPlan {
+    vector<vector<int>> routes;     // stop ids per truck, depot at both ends implied
+    vector<double> load;
+    vector<int> unserved;
+    double cost = 0;
+};
+
+class WasteRouter {
+public:
+    WasteRouter(const RoadNetwork& g, int depot, const vector<int>& stopNode,
+                const vector<double>& demand, int threads, int k = 24)
+        : stopNode(stopNode), demand(demand), threadCount(max(threads, 1)),
+          routeOf(stopNode.size(), -1), pos(stopNode.size(), 0), legAfter(stopNode.size(), 0) {
+        int m = stopNode.size();
+        nb.stops = m; nb.k = k;
+        nb.nearest.resize((size_t)m*k);
+        nb.nearestDist.resize((size_t)m*k);
+        ShortestPaths sp = dijkstraCSR(g, depot);
+        nb.fromDepot.resize(m);
+        for(int s=0;s<m;s++) nb.fromDepot[s] = sp.dist[stopNode[s]];
+
+        buildLandmarks(g, depot, 16, nb);
+
+        vector<int> nodeStop(g.n, -1);
+        for(int s=0;s<m;s++) nodeStop[stopNode[s]] = s;
+        for(int t=0;t<threadCount;t++) oracle.emplace_back(new RoadDistance(g, stopNode, &nb));
+        parallelFor(m, threadCount, [&](int t, int s){
+            oracle[t]->nearestStops(s, k, nodeStop, &nb.nearest[(size_t)s*k], &nb.nearestDist[(size_t)s*k]);
+        });
+    }
+
+    // Greedy construction: trucks leave one after another; each starts at
+    // the most urgent stop still waiting and then keeps driving to the
+    // nearest waiting stop that fits, falling back to the next most
+    // urgent one when no near stop fits, until it is full
+    FleetPlan construct(const vector<int>& priorityOrder, int trucks, double capacity){
+        FleetPlan plan;
+        int m = stopNode.size();
+        vector<char> done(m, 0);
+        size_t cursor = 0;
+        for(int t=0;t<trucks;t++){
+            vector<int> route;
+            double load = 0;
+            int cur = -1;
+            while(true){
+                int best = -1;
+                if(cur >= 0)
+                    for(int i=0;i<nb.k;i++){
+                        int c = nb.nearest[cur*nb.k+i];
+                        if(c >= 0 && !done[c] && load + demand[c] <= capacity){ best = c; break; }
+                    }
+                if(best < 0){
+                    while(cursor < priorityOrder.size() && done[priorityOrder[cursor]]) cursor++;
+                    for(size_t i=cursor;i<priorityOrder.size();i++){
+                        int c = priorityOrder[i];
+                        if(!done[c] && load + demand[c] <= capacity){ best = c; break; }
+                    }
+                }
+                if(best < 0) break;
+                done[best] = 1;
+                load += demand[best];
+                route.push_back(best);
+                cur = best;
+            }
+            plan.routes.push_back(route);
+            plan.load.push_back(load);
+        }
+        for(int s=0;s<m;s++) if(!done[s]) plan.unserved.push_back(s);
+        for(size_t r=0;r<plan.routes.size();r++) index(plan.routes[r], r, *oracle[0]);
+        plan.cost = totalCost(plan);
+        return plan;
+    }
+
+    // One round of local search: 2-opt and or-opt inside every route in
+    // parallel (routes are independent), then a serial pass relocating
+    // single stops between trucks with spare capacity. Returns the gain.
+    double improve(FleetPlan& plan, double capacity){
+        double before = plan.cost;
+        parallelFor(plan.routes.size(), threadCount, [&](int t, int r){
+            RoadDistance& od = *oracle[t];
+            while(twoOpt(plan.routes[r], od) | orOpt(plan.routes[r], od)) {}
+        });
+        relocate(plan, capacity, *oracle[0]);
+        plan.cost = totalCost(plan);
+        return before - plan.cost;
+    }
+
+    // Roads are two-way, so a route can be driven either way at the same
+    // cost: drive it so that its most urgent stop comes in the first half
+    void orient(FleetPlan& plan, const vector<int>& priorityOrder){
+        vector<int> rank(stopNode.size());
+        for(size_t i=0;i<priorityOrder.size();i++) rank[priorityOrder[i]] = i;
+        for(size_t r=0;r<plan.routes.size();r++){
+            vector<int>& route = plan.routes[r];
+            if(route.empty()) continue;
+            size_t urgent = 0;
+            for(size_t i=1;i<route.size();i++) if(rank[route[i]] < rank[route[urgent]]) urgent = i;
+            if(2*urgent >= route.size()){
+                reverse(route.begin(), route.end());
+                index(route, r, *oracle[0]);
+            }
+        }
+    }
+
+    double routeCost(const vector<int>& route, RoadDistance& od) const {
+        double c = 0;
+        for(int i=-1;i<(int)route.size();i++) c += leg(route, i, i+1, od);
+        return c;
+    }
+    double totalCost(const FleetPlan& plan){
+        double c = 0;
+        for(auto &r: plan.routes) c += routeCost(r, *oracle[0]);
+        return c;
+    }
+
+    // Point-to-point searches run so far (pairs outside the neighbour lists)
+    size_t extraSearches() const {
+        size_t n = 0;
+        for(auto &o: oracle) n += o->searches();
+        return n;
+    }
+
+private:
+    const vector<int>& stopNode;
+    const vector<double>& demand;
+    int threadCount;
+    StopNeighbours nb;
+    vector<unique_ptr<RoadDistance>> oracle;
+    vector<int> routeOf, pos;   // truck and position of every stop
+    vector<double> legAfter;    // distance from a stop to the next one (or the depot)
+
+    void index(const vector<int>& route, int r, RoadDistance& od){
+        for(int s: route) routeOf[s] = r;
+        reindex(route, od);
+    }
+    // 2-opt and or-opt keep every stop on its truck, so they only refresh
+    // pos/legAfter of their own route's stops: while routes are improved in
+    // parallel routeOf is read-only and no two threads touch the same entry
+    void reindex(const vector<int>& route, RoadDistance& od){
+        for(size_t i=0;i<route.size();i++){
+            pos[route[i]] = i;
+            legAfter[route[i]] = between(route[i], at(route, i+1), od);
+        }
+    }
+
+    // Stop at position i of a route; -1 and size() stand for the depot
+    static int at(const vector<int>& route, int i){
+        return i < 0 || i >= (int)route.size() ? -1 : route[i];
+    }
+    double between(int a, int b, RoadDistance& od) const {
+        if(a < 0 && b < 0) return 0;
+        if(a < 0) return nb.fromDepot[b];
+        if(b < 0) return nb.fromDepot[a];
+        return od.between(a, b);
+    }
+    double leg(const vector<int>& route, int i, int j, RoadDistance& od) const {
+        return between(at(route, i), at(route, j), od);
+    }
+    // leg(route, i, i+1) from the cached route legs
+    double next(const vector<int>& route, int i) const {
+        if(i < 0) return route.empty() ? 0 : nb.fromDepot[route[0]];
+        return legAfter[route[i]];
+    }
+    // Same as between() but never searches: exact when known, else the landmark bound
+    double lower(int a, int b, RoadDistance& od) const {
+        if(a < 0 || b < 0) return between(a, b, od);
+        return od.lowerBound(stopNode[a], stopNode[b]);
+    }
+
+    // 2-opt restricted to neighbour lists: for the edge leaving position i,
+    // try linking stop i to a near stop c further along the same route and
+    // reversing everything in between
+    bool twoOpt(vector<int>& route, RoadDistance& od){
+        bool improved = false;
+        int r = routeOf[route.empty() ? 0 : route[0]];
+        for(int i=0;i+1<(int)route.size();i++){
+            int a = route[i];
+            for(int q=0;q<nb.k;q++){
+                int c = nb.nearest[a*nb.k+q];
+                if(c < 0) break;
+                if(routeOf[c] != r || pos[c] <= i+1) continue;
+                int j = pos[c];
+                double known = nb.nearestDist[a*nb.k+q] - next(route, i) - next(route, j);
+                if(known + lower(route[i+1], at(route, j+1), od) >= -1e-9) continue;
+                if(known + leg(route, i+1, j+1, od) < -1e-9){
+                    reverse(route.begin()+i+1, route.begin()+j+1);
+                    reindex(route, od);
+                    improved = true;
+                    break;
+                }
+            }
+        }
+        return improved;
+    }
+
+    // or-opt: move a run of 1-3 stops so that it follows a stop c that is
+    // near the run's first stop
+    bool orOpt(vector<int>& route, RoadDistance& od){
+        bool improved = false;
+        int r = routeOf[route.empty() ? 0 : route[0]];
+        for(int len=1;len<=3;len++)
+            for(int i=0;i+len<=(int)route.size();i++){
+                int first = route[i];
+                // Upper bound on what taking the run out saves; exact only when needed
+                double cut = next(route, i-1) + next(route, i+len-1);
+                double maxGain = cut - lower(at(route, i-1), at(route, i+len), od);
+                double removeGain = -1;
+                for(int q=0;q<nb.k;q++){
+                    int c = nb.nearest[first*nb.k+q];
+                    if(c < 0) break;
+                    if(routeOf[c] != r) continue;
+                    int j = pos[c];
+                    if(j >= i-1 && j < i+len) continue;
+                    double known = nb.nearestDist[first*nb.k+q] - next(route, j);
+                    if(known + lower(route[i+len-1], at(route, j+1), od) - maxGain >= -1e-9) continue;
+                    if(removeGain < 0) removeGain = cut - leg(route, i-1, i+len, od);
+                    double add = known + between(route[i+len-1], at(route, j+1), od);
+                    if(add - removeGain < -1e-9){
+                        vector<int> seg(route.begin()+i, route.begin()+i+len);
+                        route.erase(route.begin()+i, route.begin()+i+len);
+                        int dest = j < i ? j+1 : j+1-len;
+                        route.insert(route.begin()+dest, seg.begin(), seg.end());
+                        reindex(route, od);
+                        improved = true;
+                        break;
+                    }
+                }
+            }
+        return improved;
+    }
+
+    // Move single stops next to a near stop on another truck when that
+    // truck has room and the fleet distance drops
+    void relocate(FleetPlan& plan, double capacity, RoadDistance& od){
+        for(size_t r=0;r<plan.routes.size();r++){
+            vector<int>& from = plan.routes[r];
+            for(int i=0;i<(int)from.size();i++){
+                int s = from[i];
+                double cut = next(from, i-1) + next(from, i);
+                double maxGain = cut - lower(at(from, i-1), at(from, i+1), od);
+                double removeGain = -1;
+                for(int q=0;q<nb.k;q++){
+                    int c = nb.nearest[s*nb.k+q];
+                    if(c < 0) break;
+                    int r2 = routeOf[c];
+                    if(r2 < 0 || r2 == (int)r || plan.load[r2] + demand[s] > capacity) continue;
+                    vector<int>& to = plan.routes[r2];
+                    int j = pos[c];
+                    double known = nb.nearestDist[s*nb.k+q] - next(to, j);
+                    if(known + lower(s, at(to, j+1), od) - maxGain >= -1e-9) continue;
+                    if(removeGain < 0) removeGain = cut - leg(from, i-1, i+1, od);
+                    double add = known + between(s, at(to, j+1), od);
+                    if(add - removeGain < -1e-9){
+                        from.erase(from.begin()+i);
+                        to.insert(to.begin()+j+1, s);
+                        plan.load[r] -= demand[s];
+                        plan.load[r2] += demand[s];
+                        index(from, r, od); index(to, r2, od);
+                        i--;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+};
+
+// Local search rounds until a round gains under 0.1% or the time budget
+// (measured from t0) is spent
+void solveFleet(WasteRouter& router, FleetPlan& plan, double capacity, double budgetMs,
+                chrono::steady_clock::time_point t0, bool report){
+    for(int round=1;;round++){
+        double before = plan.cost;
+        double gain = router.improve(plan, capacity);
+        double ms = chrono::duration<double,milli>(chrono::steady_clock::now()-t0).count();
+        if(report)
+            cout << "bench=land_vrp_round round=" << round << " ms=" << ms << " cost=" << plan.cost << endl;
+        if(gain < before*0.001 || ms > budgetMs) break;
+    }
+}
+
+void planCollection(const vector<Subzone>& subzones, const RoadNetwork& roads, int trucks, double capacity){
+    int n = subzones.size();
+    vector<int> stopNode(n);
+    vector<double> demand(n);
+    for(int i=0;i<n;i++){ stopNode[i] = i; demand[i] = subzones[i].pollution/10; }
+
+    // Same urgency order as the waste collection priority list
+    priority_queue<Subzone, vector<Subzone>, ComparePriority> pq(subzones.begin(), subzones.end());
+    vector<int> order;
+    while(!pq.empty()){ order.push_back(pq.top().index); pq.pop(); }
+
+    WasteRouter router(roads, 0, stopNode, demand, thread::hardware_concurrency());
+    FleetPlan plan = router.construct(order, trucks, capacity);
+    double initial = plan.cost;
+    solveFleet(router, plan, capacity, 1000, chrono::steady_clock::now(), false);
+    router.orient(plan, order);
+
+    cout << "Collection plan (" << trucks << " trucks, capacity " << capacity << "):" << endl;
+    for(size_t t=0;t<plan.routes.size();t++){
+        if(plan.routes[t].empty()) continue;
+        cout << "Truck " << t+1 << " | Load: " << plan.load[t] << " | Depot";
+        for(int s: plan.routes[t]) cout << " -> " << subzones[s].name;
+        cout << " -> Depot" << endl;
+    }
+    for(int s: plan.unserved) cout << "Unserved: " << subzones[s].name << endl;
+    cout << "Total distance: " << plan.cost << " (greedy start " << initial << ")" << endl;
+}
+
+void benchmarkFleet(int stops, int trucks, double budgetMs){
+    int nodes = 4*stops;
+    RoadNetwork g = buildRoadNetwork(nodes, generateRoads(nodes, 21));
+
+    // Stops are a random subset of the road nodes, depot in the middle
+    vector<int> perm(nodes);
+    iota(perm.begin(), perm.end(), 0);
+    mt19937 rng(8);
+    shuffle(perm.begin(), perm.end(), rng);
+    vector<int> stopNode(perm.begin(), perm.begin()+stops);
+    vector<double> demand(stops);
+    double total = 0;
+    for(auto &d: demand){ d = 1 + rng()%5; total += d; }
+    double capacity = ceil(total/trucks*1.05);
+    vector<int> order(stops);
+    iota(order.begin(), order.end(), 0);
+    shuffle(order.begin(), order.end(), rng);
+    int threads = max(1u, thread::hardware_concurrency());
+
+    auto t0 = chrono::steady_clock::now();
+    clock_t c0 = clock();
+    WasteRouter router(g, nodes/2, stopNode, demand, threads);
+    double neighbourMs = chrono::duration<double,milli>(chrono::steady_clock::now()-t0).count();
+    FleetPlan plan = router.construct(order, trucks, capacity);
+    double constructMs = chrono::duration<double,milli>(chrono::steady_clock::now()-t0).count();
+    double initial = plan.cost;
+    cout << "bench=land_vrp_round round=0 ms=" << constructMs << " cost=" << initial << endl;
+    solveFleet(router, plan, capacity, budgetMs, t0, true);
+    router.orient(plan, order);
+    double totalMs = chrono::duration<double,milli>(chrono::steady_clock::now()-t0).count();
+    double cpuMs = 1000.0*(clock()-c0)/CLOCKS_PER_SEC;
+
+    cout << "bench=land_vrp stops=" << stops
+         << " trucks=" << trucks
+         << " capacity=" << capacity
+         << " threads=" << threads
+         << " neighbour_ms=" << neighbourMs
+         << " construct_ms=" << constructMs - neighbourMs
+         << " total_ms=" << totalMs
+         << " cpu_ms=" << cpuMs
+         << " greedy_cost=" << initial
+         << " final_cost=" << plan.cost
+         << " improvement_pct=" << 100*(initial-plan.cost)/initial
+         << " unserved=" << plan.unserved.size()
+         << " extra_searches=" << router.extraSearches() << endl;
+}
+
+// ---------------- Alert rules ----------------
+
+// Threshold alerts from a rule file (see land_rules.txt), compiled once and
+// run over the subzone readings as columns. Subzones are regrouped so every
+// zone is one contiguous run (zones in first-seen order) and one rule group.
+void landAlerts(const vector<Subzone>& subzones, const string& rulesFile){
+    RuleEngine rules;
+    rules.addColumn("pollution");
+    rules.addColumn("soilToxicity");
+    rules.addColumn("moisture");
+    rules.addColumn("heavyMetal");
+    rules.addColumn("landQuality");
+    string error;
+    if(!rules.load(rulesFile, error)){
+        cerr << rulesFile << ": " << error << endl;
+        return;
+    }
+
+    unordered_map<uint32_t,int> zoneId;
+    vector<vector<int>> members;
+    for(int i=0;i<(int)subzones.size();i++){
+        auto it = zoneId.emplace(subzones[i].zone.index(), members.size()).first;
+        if(it->second == (int)members.size()) members.emplace_back();
+        members[it->second].push_back(i);
+    }
+
+    vector<int> order;
+    vector<RuleGroup> groups;
+    for(auto &m: members){
+        groups.push_back({subzones[m[0]].zone.str(), order.size(), order.size() + m.size()});
+        order.insert(order.end(), m.begin(), m.end());
+    }
+    vector<vector<float>> cols(5);
+    for(int i: order){
+        const Subzone &sz = subzones[i];
+        cols[0].push_back(sz.pollution);
+        cols[1].push_back(sz.soilToxicity);
+        cols[2].push_back(sz.moisture);
+        cols[3].push_back(sz.heavyMetal);
+        cols[4].push_back(sz.landQuality);
+    }
+
+    vector<RuleHit> hits;
+    rules.evaluate({cols[0].data(), cols[1].data(), cols[2].data(), cols[3].data(), cols[4].data()},
+                   order.size(), groups, hits);
+    cout << "Land alerts (" << rules.size() << " rules, " << hits.size() << " hits):" << endl;
+    for(auto &h: hits)
+        cout << rules.format(h, groups, h.row >= 0 ? subzones[order[h.row]].name.str() : "") << endl;
+}
+
+// ---------------- Algorithm benchmark ----------------
+
+// Times each step of the one-shot analysis on a land_pol_data.csv of any
+// size (Benchmarks/gen_data writes them). bellmanFord runs over the
+// placeholder all-ones matrix from main(), O(n^3); the dense dijkstra
+// over the generateRoads network as an n x n matrix, O(n^2) memory.
+// Both run on a prefix; dijkstraCSR on the whole file.
+void benchmarkAlgorithms(const string& filename){
+    const int bellmanCap = 400, denseCap = 3000;
+    vector<Subzone> subzones;
+    double ms = timeMs([&]{ subzones = readCSV(filename); });
+    int n = subzones.size();
+    reportAlgorithm("land", "readCSV", n, ms);
+    if(n == 0) return;
+
+    ms = timeMs([&]{
+        priority_queue<Subzone, vector<Subzone>, ComparePriority> pq;
+        for(auto &sz: subzones) pq.push(sz);
+        while(!pq.empty()) pq.pop();
+    });
+    reportAlgorithm("land", "wasteCollectionQueue", n, ms);
+
+    int small = min(n, bellmanCap);
+    vector<Subzone> prefix(subzones.begin(), subzones.begin() + small);
+    vector<vector<double>> ones(small, vector<double>(small, 1));
+    for(int i=0;i<small;i++) ones[i][i] = 0;
+    ms = timeMs([&]{ bellmanFord(ones, prefix, 0); });
+    reportAlgorithm("land", "bellmanFord", small, ms, n);
+
+    small = min(n, denseCap);
+    vector<Road> roads = generateRoads(small, 3);
+    vector<vector<double>> graph(small, vector<double>(small, 1e9));
+    for(int i=0;i<small;i++) graph[i][i] = 0;
+    for(auto &r: roads) graph[r.from][r.to] = graph[r.to][r.from] = r.length;
+    ms = timeMs([&]{ dijkstra(graph, 0); });
+    reportAlgorithm("land", "dijkstra", small, ms, n);
+
+    roads = generateRoads(n, 3);
+    RoadNetwork g;
+    ms = timeMs([&]{ g = buildRoadNetwork(n, roads); });
+    reportAlgorithm("land", "buildRoadNetwork", n, ms);
+    ms = timeMs([&]{ dijkstraCSR(g, 0); });
+    reportAlgorithm("land", "dijkstraCSR", n, ms);
+    reportMetricsOverhead("land");
+}
+
+/*
+ Usage:
+   LandQ                 analysis of land_pol_data.csv (or its fresh .snap)
+   LandQ snapshot [csv]  write <csv>.snap for fast startup
+   LandQ spikes <readings.csv>
+                         sliding-window spike detection over a readings stream
+   LandQ bench-spikes [subzones] [seconds]
+                         spike detector throughput at 1 Hz per subzone
+   LandQ bench-routing [subzones...]
+                         sparse CSR Dijkstra vs dense matrix (default 1k 10k 100k)
+   LandQ plan [trucks] [capacity]
+                         multi-truck collection routes over land_roads.csv
+   LandQ bench-vrp [stops] [trucks] [budget_ms]
+                         fleet routing quality vs time (default 5000 stops, 50 trucks, 1000 ms)
+   LandQ alerts [rules]  threshold alerts from a rule file (default land_rules.txt)
+   LandQ bench-algorithms <csv>
+                         time every analysis algorithm on <csv>
+
+ Any mode also exports per-stage counters and latency histograms when
+ METRICS_OUT=<file|unix:path> is set (see common/metrics.h).
+*/
+int main(int argc, char* argv[]) {
+    metricsExportAtExit("land");
+    string mode = argc > 1 ? argv[1] : "";
+    if(mode == "snapshot"){
+        string csv = argc > 2 ? argv[2] : "land_pol_data.csv";
+        vector<Subzone> subzones = readCSV(csv);
+        if(!writeSnapshot(subzones, csv + ".snap")){
+            cerr << "Error writing " << csv << ".snap" << endl;
+            return 1;
+        }
+        cout << "Wrote " << subzones.size() << " subzones to " << csv << ".snap" << endl;
+        return 0;
+    }
+    if(mode == "spikes" && argc > 2){
+        detectSpikes(loadSubzones("land_pol_data.csv"), argv[2]);
+        return 0;
+    }
+    if(mode == "bench-spikes"){
+        benchmarkSpikes(argc > 2 ? atoi(argv[2]) : 100000, argc > 3 ? atoi(argv[3]) : 60);
+        return 0;
+    }
+    if(mode == "bench-routing"){
+        vector<int> sizes;
+        for(int i=2;i<argc;i++) sizes.push_back(atoi(argv[i]));
+        if(sizes.empty()) sizes = {1000, 10000, 100000};
+        benchmarkRouting(sizes);
+        return 0;
+    }
+    if(mode == "plan"){
+        vector<Subzone> subzones = loadSubzones("land_pol_data.csv");
+        planCollection(subzones, loadRoadNetwork("land_roads.csv", subzones),
+                       argc > 2 ? atoi(argv[2]) : 4, argc > 3 ? atof(argv[3]) : 30);
+        return 0;
+    }
+    if(mode == "bench-vrp"){
+        benchmarkFleet(argc > 2 ? atoi(argv[2]) : 5000, argc > 3 ? atoi(argv[3]) : 50, argc > 4 ? atof(argv[4]) : 1000);
+        return 0;
+    }
+    if(mode == "alerts"){
+        landAlerts(loadSubzones("land_pol_data.csv"), argc > 2 ? argv[2] : "land_rules.txt");
+        return 0;
+    }
+    if(mode == "bench-algorithms" && argc > 2){
+        benchmarkAlgorithms(argv[2]);
+        return 0;
+    }
+    if(!mode.empty()){
+        cerr << "Usage: LandQ [snapshot [csv] | spikes <readings.csv> | bench-spikes [subzones] [seconds]"
+                " | bench-routing [subzones...] | plan [trucks] [capacity] | bench-vrp [stops] [trucks] [budget_ms]"
+                " | alerts [rules] | bench-algorithms <csv>]" << endl;
+        return 1;
+    }
+
+    vector<Subzone> subzones = loadSubzones("land_pol_data.csv");
+    int n = subzones.size();
+    // Spikes are found by the streaming detector ("spikes <readings.csv>");
+    // the Bellman-Ford check over a placeholder matrix is only benchmarked
     
     // Use priority queue to select subzones for waste collection
     priority_queue<Subzone, vector<Subzone>, ComparePriority> pq;
-    for(auto &sz: subzones){
-        pq.push(sz);
+    {
+        StageTimer timer(StageSort, subzones.size());
+        for(auto &sz: subzones){
+            pq.push(sz);
+        }
     }
     
     cout << "\nWaste Collection Priority:\n";
@@ -144,17 +1126,23 @@ int main() {
              << " | Pollution: " << sz.pollution << endl;
     }
     
-    // Compute shortest path from depot (index 0) using Dijkstra
-    vector<int> parent = dijkstra(graph, 0);
+    // Shortest paths from the depot (index 0) over the road network in
+    // land_roads.csv; without it every subzone is one unit from every other
+    RoadNetwork roads;
+    if(access("land_roads.csv", R_OK) == 0) roads = loadRoadNetwork("land_roads.csv", subzones);
+    else {
+        vector<Road> all;
+        for(int i=0;i<n;i++)
+            for(int j=i+1;j<n;j++) all.push_back({i, j, 1});
+        roads = buildRoadNetwork(n, all);
+    }
+    ShortestPaths sp = dijkstraCSR(roads, 0);
     cout << "\nShortest paths from Depot:\n";
     for(int i=0;i<n;i++){
-        cout << subzones[i].name << " <- ";
-        int cur = i;
-        while(parent[cur] != -1){
-            cout << subzones[parent[cur]].name << " <- ";
-            cur = parent[cur];
-        }
-        cout << "Depot" << endl;
+        vector<int> path = pathTo(sp, i);
+        if(path.empty()){ cout << subzones[i].name << " unreachable" << endl; continue; }
+        for(int k=path.size()-1;k>=0;k--) cout << subzones[path[k]].name << " <- ";
+        cout << "Depot (" << sp.dist[i] << ")" << endl;
     }
     
     return 0;
@@ -1,18 +1,42 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <fstream>
-#include <sstream>
 #include <queue>
+#include <unordered_map>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include "../../common/mapped_csv.h"
+#include "../../common/column_snapshot.h"
+#include "../../common/rolling_stats.h"
+#include "../../common/rule_engine.h"
+#include "../../common/bench_timer.h"
+#include "../../common/metrics.h"
+#include "../../common/intern.h"
 using namespace std;
 
 /* ===================== DATA STRUCTURES ===================== */
 
+// Names are interned (intern.h): a record is 20 bytes and copying one
+// into a heap or a per-zone vector never allocates.
 struct SubZone {
-    string zone;
-    string name;
+    ZoneId zone;
+    ZoneId name;
     float waterLevel;
     float pollution;
+    ZoneId basin;       // optional 5th CSV column; one river when absent
+};
+
+// Non-owning view of a contiguous run of subzones (one zone)
+struct SubZoneSpan {
+    SubZone* first = nullptr;
+    size_t count = 0;
+
+    SubZone* begin() const { return first; }
+    SubZone* end() const { return first + count; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    SubZone& operator[](size_t i) const { return first[i]; }
 };
 
 struct Edge {
@@ -20,8 +44,8 @@ struct Edge {
 };
 
 struct ZonePriority {
-    string zone;
-    string subzone;
+    ZoneId zone;
+    ZoneId subzone;
     float score;
 
     bool operator<(const ZonePriority& other) const {
@@ -33,36 +57,206 @@ struct ZonePriority {
 
 vector<SubZone> readCSV(string filename) {
     vector<SubZone> data;
-    ifstream file(filename);
-    string line;
+    MappedCSV file(filename);
+    CSVRow row;
 
-    getline(file, line); // skip header
+    if (!file.isOpen()) {
+        cerr << "Error opening file: " << filename << endl;
+        exit(1);
+    }
 
-    while (getline(file, line)) {
-        stringstream ss(line);
-        string zone, sub, wl, pol;
+    StageTimer timer(StageParse);
+    file.skipLine(); // skip header
 
-        getline(ss, zone, ',');
-        getline(ss, sub, ',');
-        getline(ss, wl, ',');
-        getline(ss, pol, ',');
+    data.reserve(file.estimateRows());
+    while (file.nextRow(row))
+        data.push_back({ZoneId(row[0]), ZoneId(row[1]), row.toFloat(2), row.toFloat(3), ZoneId(row[4])});
 
-        data.push_back({zone, sub, stof(wl), stof(pol)});
-    }
+    timer.addItems(data.size());
     return data;
 }
 
+/* ===================== COLUMNAR SNAPSHOT ===================== */
+
+// water_zones_data.csv as columns: zone, subzone, basin (dictionary), waterLevel, pollution (float32)
+bool writeSnapshot(vector<SubZone>& data, string filename) {
+    vector<string> zone, sub, basin;
+    vector<float> level, pol;
+    for (auto& z : data) {
+        zone.push_back(z.zone.str());
+        sub.push_back(z.name.str());
+        basin.push_back(z.basin.str());
+        level.push_back(z.waterLevel);
+        pol.push_back(z.pollution);
+    }
+    SnapshotWriter w(data.size());
+    w.addStrings("zone", zone);
+    w.addStrings("basin", basin);
+    w.addStrings("subzone", sub);
+    w.addFloat32("waterLevel", level);
+    w.addFloat32("pollution", pol);
+    return w.write(filename);
+}
+
+bool readSnapshot(string filename, vector<SubZone>& data) {
+    MappedSnapshot snap;
+    if (!snap.open(filename)) return false;
+    DictColumn zone = snap.dictColumn("zone");
+    DictColumn sub = snap.dictColumn("subzone");
+    DictColumn basin = snap.dictColumn("basin");    // absent in older snapshots
+    const float* level = snap.float32Column("waterLevel");
+    const float* pol = snap.float32Column("pollution");
+    if (!zone.codes || !sub.codes || !level || !pol) return false;
+
+    StageTimer timer(StageParse, snap.rows());
+    // Intern each dictionary entry once; rows then only copy ids
+    auto ids = [](const DictColumn& d) {
+        vector<ZoneId> v(d.count);
+        for (uint32_t c = 0; c < d.count; c++) v[c] = ZoneId(d.value(c));
+        return v;
+    };
+    vector<ZoneId> zoneIds = ids(zone), subIds = ids(sub), basinIds = basin.codes ? ids(basin) : vector<ZoneId>();
+    data.clear();
+    data.reserve(snap.rows());
+    for (size_t i = 0; i < snap.rows(); i++)
+        data.push_back({zoneIds[zone.codes[i]], subIds[sub.codes[i]], level[i], pol[i],
+                        basin.codes ? basinIds[basin.codes[i]] : ZoneId()});
+    return true;
+}
+
+// Uses <csv>.snap when it is newer than the CSV
+vector<SubZone> loadZones(string filename) {
+    vector<SubZone> data;
+    if (snapshotIsFresh(filename + ".snap", filename) && readSnapshot(filename + ".snap", data))
+        return data;
+    return readCSV(filename);
+}
+
 vector<SubZone> getZone(vector<SubZone>& all, string zoneName) {
     vector<SubZone> z;
+    uint32_t id = nameTable().find(zoneName);
+    if (id == StringInterner::None) return z;
     for (auto& s : all)
-        if (s.zone == zoneName)
+        if (s.zone.index() == id)
             z.push_back(s);
     return z;
 }
 
+/* ===================== ZONE INDEX ===================== */
+
+// Basin -> zone -> subzone hierarchy built once at load. build() reorders
+// the subzones so every zone is one contiguous run (basins and zones keep
+// the order they first appear in, subzones keep file order), and numbers
+// basins and zones densely; rule checks then get spans, not copies. The
+// names are already interned, so lookups key on their ids.
+class ZoneIndex {
+public:
+    void build(vector<SubZone>& data) {
+        basinNames.clear(); zoneNames.clear(); zoneBasin.clear();
+        basinIds.clear(); zoneIds.clear();
+
+        // Zone id per subzone, in first-seen order within each basin
+        vector<vector<int>> basinZones;
+        vector<int> zoneOf(data.size());
+        for (size_t i = 0; i < data.size(); i++) {
+            int b = intern(basinIds, basinNames, data[i].basin);
+            if (b == (int)basinZones.size()) basinZones.emplace_back();
+            uint64_t k = key(data[i].basin.index(), data[i].zone.index());
+            auto it = zoneIds.find(k);
+            if (it == zoneIds.end()) {
+                it = zoneIds.emplace(k, zoneNames.size()).first;
+                zoneNames.push_back(data[i].zone);
+                zoneBasin.push_back(b);
+                basinZones[b].push_back(it->second);
+            }
+            zoneOf[i] = it->second;
+        }
+
+        // Renumber zones so each basin's zones are consecutive
+        vector<int> renum(zoneNames.size());
+        vector<ZoneId> names;
+        basinStart.assign(1, 0);
+        for (auto& zs : basinZones) {
+            for (int z : zs) { renum[z] = names.size(); names.push_back(zoneNames[z]); }
+            basinStart.push_back(names.size());
+        }
+        for (auto& kv : zoneIds) kv.second = renum[kv.second];
+        for (size_t z = 0; z < zoneBasin.size(); z++) zoneBasin[z] = 0;
+        for (size_t b = 0; b + 1 < basinStart.size(); b++)
+            for (int z = basinStart[b]; z < basinStart[b + 1]; z++) zoneBasin[z] = b;
+        zoneNames.swap(names);
+
+        // Counting sort of the subzones by zone
+        zoneStart.assign(zoneNames.size() + 1, 0);
+        for (int& z : zoneOf) { z = renum[z]; zoneStart[z + 1]++; }
+        for (size_t z = 0; z < zoneNames.size(); z++) zoneStart[z + 1] += zoneStart[z];
+        vector<int> fill(zoneStart.begin(), zoneStart.end() - 1);
+        vector<SubZone> sorted(data.size());
+        for (size_t i = 0; i < data.size(); i++) sorted[fill[zoneOf[i]]++] = move(data[i]);
+        data.swap(sorted);
+        base = data.data();
+    }
+
+    int basins() const { return basinNames.size(); }
+    int zones() const { return zoneNames.size(); }
+
+    // Memory held by the index: vector capacities, plus one bucket pointer
+    // per bucket and one node (next pointer + entry) per zone in zoneIds
+    size_t bytes() const {
+        size_t b = (basinNames.capacity() + zoneNames.capacity()) * sizeof(ZoneId)
+                 + (zoneBasin.capacity() + basinStart.capacity() + zoneStart.capacity()
+                    + basinIds.capacity()) * sizeof(int);
+        return b + zoneIds.bucket_count() * sizeof(void*)
+                 + zoneIds.size() * (sizeof(void*) + sizeof(pair<const uint64_t, int>));
+    }
+    ZoneId basinName(int b) const { return basinNames[b]; }
+    ZoneId zoneName(int z) const { return zoneNames[z]; }
+    int basinOf(int z) const { return zoneBasin[z]; }
+
+    // Zone ids of basin b are basinZonesBegin(b) .. basinZonesEnd(b)-1
+    int basinZonesBegin(int b) const { return basinStart[b]; }
+    int basinZonesEnd(int b) const { return basinStart[b + 1]; }
+
+    int findBasin(const string& basin) const {
+        uint32_t b = nameTable().find(basin);
+        return b < basinIds.size() ? basinIds[b] : -1;
+    }
+    int findZone(const string& zone, const string& basin = "") const {
+        uint32_t z = nameTable().find(zone), b = nameTable().find(basin);
+        if (z == StringInterner::None || b == StringInterner::None) return -1;
+        auto it = zoneIds.find(key(b, z));
+        return it == zoneIds.end() ? -1 : it->second;
+    }
+
+    SubZoneSpan span(int z) const {
+        if (z < 0) return SubZoneSpan();
+        return {base + zoneStart[z], (size_t)(zoneStart[z + 1] - zoneStart[z])};
+    }
+    SubZoneSpan span(const string& zone, const string& basin = "") const { return span(findZone(zone, basin)); }
+
+private:
+    SubZone* base = nullptr;
+    vector<ZoneId> basinNames, zoneNames;
+    vector<int> zoneBasin, basinStart, zoneStart;
+    vector<int> basinIds;                   // name id -> basin, -1 if none
+    unordered_map<uint64_t, int> zoneIds;   // (basin, zone) name ids -> zone
+
+    static uint64_t key(uint32_t basin, uint32_t zone) { return (uint64_t)basin << 32 | zone; }
+
+    static int intern(vector<int>& ids, vector<ZoneId>& names, ZoneId s) {
+        if (s.index() >= ids.size()) ids.resize(s.index() + 1, -1);
+        if (ids[s.index()] < 0) {
+            ids[s.index()] = names.size();
+            names.push_back(s);
+        }
+        return ids[s.index()];
+    }
+};
+
 /* ===================== BELLMAN–FORD (SPIKE DETECTION) ===================== */
 
 bool bellmanFordSpike(int V, vector<Edge>& edges) {
+    StageTimer timer(StageSearch, V);
     vector<int> dist(V, 0);
 
     for (int i = 1; i <= V - 1; i++)
@@ -77,109 +271,1138 @@ bool bellmanFordSpike(int V, vector<Edge>& edges) {
     return false;
 }
 
+/* ===================== STREAMING SPIKE DETECTION ===================== */
+
+// Per-subzone rolling statistics for water level and pollution. Water
+// level is also checked for rate of change: a fast rise upstream is a
+// flood warning even while the level is still inside its usual range.
+struct WaterSpikeMonitor {
+    SpikeDetector level, pollution;
+
+    WaterSpikeMonitor(int subzones)
+        : level(subzones, levelConfig()), pollution(subzones, pollutionConfig()) {}
+
+    static SpikeConfig levelConfig() {
+        SpikeConfig c;
+        c.rateLimit = 2.0;  // level units per second
+        return c;
+    }
+    static SpikeConfig pollutionConfig() {
+        return SpikeConfig();
+    }
+};
+
+string spikeReason(int flags) {
+    string r;
+    if (flags & SpikeZScore) r += " z-score";
+    if (flags & SpikeEwma) r += " above-EWMA";
+    if (flags & SpikeRate) r += " rate";
+    return r;
+}
+
+// Readings file: SubZone,Time,WaterLevel,Pollution (time in seconds).
+// Subzones are matched by name against the zone data.
+void detectSpikes(vector<SubZone>& allData, string filename) {
+    NameIndex index;
+    for (size_t i = 0; i < allData.size(); i++)
+        index.add(allData[i].name, i);
+
+    MappedCSV file(filename);
+    CSVRow row;
+    if (!file.isOpen()) {
+        cerr << "Error opening file: " << filename << endl;
+        exit(1);
+    }
+    file.skipLine(); // skip header
+
+    WaterSpikeMonitor monitor(allData.size());
+    long long readings = 0, unknown = 0, spikes = 0;
+    StageTimer timer(StageAlerts);
+
+    cout << "=== STREAMING SPIKE DETECTION ===\n";
+    while (file.nextRow(row)) {
+        int s = index.find(row[0]);
+        if (s < 0) { unknown++; continue; }
+        double t = row.toDouble(1);
+        readings++;
+
+        int lf = monitor.level.add(s, t, row.toFloat(2));
+        int pf = monitor.pollution.add(s, t, row.toFloat(3));
+        if (lf) {
+            spikes++;
+            cout << "SPIKE: " << allData[s].zone << "/" << allData[s].name
+                 << " water level " << monitor.level.last(s) << " at t=" << t
+                 << " (mean " << monitor.level.mean(s) << ", rate " << monitor.level.rate(s) << "/s)"
+                 << spikeReason(lf) << "\n";
+        }
+        if (pf) {
+            spikes++;
+            cout << "SPIKE: " << allData[s].zone << "/" << allData[s].name
+                 << " pollution " << monitor.pollution.last(s) << " at t=" << t
+                 << " (mean " << monitor.pollution.mean(s) << ", sd " << monitor.pollution.stddev(s) << ")"
+                 << spikeReason(pf) << "\n";
+        }
+    }
+    timer.addItems(readings);
+    cout << readings << " readings, " << spikes << " spikes";
+    if (unknown) cout << ", " << unknown << " readings for unknown subzones skipped";
+    cout << "\n";
+}
+
+// n subzones reporting at 1 Hz for `seconds`; one reading in ~10k is a spike
+void benchmarkSpikes(int n, int seconds) {
+    vector<float> baseLevel(n), basePol(n);
+    uint32_t seed = 11;
+    for (int i = 0; i < n; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        baseLevel[i] = 40 + seed % 50;
+        basePol[i] = 10 + (seed >> 8) % 60;
+    }
+
+    WaterSpikeMonitor monitor(n);
+    long long spikes = 0;
+    double worstTickMs = 0;
+    auto t0 = chrono::steady_clock::now();
+    for (int t = 0; t < seconds; t++) {
+        auto tick = chrono::steady_clock::now();
+        for (int i = 0; i < n; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            float noise = (int)(seed >> 20) % 200 / 100.0f - 1.0f;
+            float pol = basePol[i] + noise;
+            if (seed % 10000 == 0) pol *= 3;
+            spikes += monitor.level.add(i, t, baseLevel[i] + noise) != 0;
+            spikes += monitor.pollution.add(i, t, pol) != 0;
+        }
+        worstTickMs = max(worstTickMs, chrono::duration<double, milli>(chrono::steady_clock::now() - tick).count());
+    }
+    double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    long long readings = (long long)n * seconds;
+
+    cout << "bench=water_spikes subzones=" << n
+         << " seconds=" << seconds
+         << " readings=" << readings
+         << " total_s=" << sec
+         << " readings_per_s=" << readings / sec
+         << " ns_per_reading=" << sec * 1e9 / readings
+         << " worst_tick_ms=" << worstTickMs
+         << " bytes_per_subzone=" << monitor.level.bytesPerStream() + monitor.pollution.bytesPerStream()
+         << " spikes=" << spikes << endl;
+}
+
 /* ===================== FLOOD DETECTION ===================== */
 
-void floodCheck(vector<SubZone>& upstream) {
+bool floodRisk(SubZoneSpan upstream) {
     int flooded = 0;
     for (auto& z : upstream)
         if (z.waterLevel > 80)
             flooded++;
+    return flooded >= 3;
+}
 
-    if (flooded >= 3)
+void floodCheck(SubZoneSpan upstream) {
+    StageTimer timer(StageAlerts, upstream.size());
+    if (floodRisk(upstream))
         cout << "FLOOD ALERT: Upstream water rising rapidly\n";
 }
 
 /* ===================== DAM CONTROL ===================== */
 
-void damControl(vector<SubZone>& dam) {
+bool damPolluted(SubZoneSpan dam) {
+    if (dam.empty()) return false;
     float avg = 0;
     for (auto& z : dam)
         avg += z.pollution;
     avg /= dam.size();
+    return avg > 30;
+}
 
-    if (avg > 30)
+void damControl(SubZoneSpan dam) {
+    StageTimer timer(StageAlerts, dam.size());
+    if (damPolluted(dam))
         cout << "DAM ALERT: Water polluted, releasing water to refresh reservoir\n";
 }
 
 /* ===================== INDUSTRIAL ALERT ===================== */
 
-void industrialAlert(vector<SubZone>& downstream2) {
-    for (auto& z : downstream2) {
-        if (z.pollution > 60) {
-            cout << "INDUSTRIAL ALERT: Pollution spike at " << z.name << "\n";
-            return;
-        }
-    }
+// First subzone over the industrial limit, or nullptr
+const SubZone* industrialSpike(SubZoneSpan downstream2) {
+    for (auto& z : downstream2)
+        if (z.pollution > 60)
+            return &z;
+    return nullptr;
+}
+
+void industrialAlert(SubZoneSpan downstream2) {
+    StageTimer timer(StageAlerts, downstream2.size());
+    if (const SubZone* z = industrialSpike(downstream2))
+        cout << "INDUSTRIAL ALERT: Pollution spike at " << z->name << "\n";
 }
 
 /* ===================== FISHING ADVISORY ===================== */
 
-void fishingCheck(vector<SubZone>& downstream1) {
+bool fishingSafe(SubZoneSpan downstream1) {
     int safe = 0;
     for (auto& z : downstream1)
         if (z.pollution < 40)
             safe++;
+    return safe >= 3;
+}
 
-    if (safe >= 3)
+void fishingCheck(SubZoneSpan downstream1) {
+    StageTimer timer(StageAlerts, downstream1.size());
+    if (fishingSafe(downstream1))
         cout << "Fishing Allowed in Downstream-1\n";
     else
         cout << "Fishing Banned in Downstream-1\n";
 }
 
+/* ===================== FLOOD PROPAGATION (RIVER DAG) ===================== */
+
+// One river link: water leaving reach `from` reaches `to` after `lag`
+// timesteps. attenuation scales the level anomaly that travels down,
+// share is the fraction of `from`'s outflow taking this link (branches
+// split it), decay is the pollutant lost on the way.
+struct RiverLink {
+    int from, to, lag;
+    float attenuation, share, decay;
+};
+
+struct FloodForecast {
+    int floodIn;        // steps until level >= flood limit, 0 = now, -1 = not within horizon
+    int pollutionIn;    // same for the pollution limit
+};
+
+// Linear routing over a DAG of reaches, evaluated in topological order.
+// Every reach has a gauge reading (level, pollution); its first level is
+// taken as normal. Per step:
+//   anomaly[r] = (level[r] - normal[r]) + sum over links u->r of
+//                attenuation * anomaly[u] as of (t - lag)
+//   pollution[r] = mix of its own reading and the arriving upstream
+//                  pollution, weighted by share and reduced by decay
+// step() is incremental: a reach is recomputed only when its reading
+// changed or an upstream value it depends on changed `lag` steps ago.
+// Changes are scheduled on a timing wheel (lag > 0) or a heap keyed by
+// topological rank (lag 0), and each reach keeps only the values it
+// changed to within the last maxLag steps.
+class RiverModel {
+public:
+    bool build(int reaches, const vector<RiverLink>& links) {
+        n = reaches;
+        maxLag = 0;
+        for (auto& l : links) {
+            if (l.from < 0 || l.from >= n || l.to < 0 || l.to >= n || l.lag < 0) return false;
+            maxLag = max(maxLag, l.lag);
+        }
+        W = maxLag + 1;
+
+        // Incoming links grouped by target, outgoing by source
+        inStart.assign(n + 1, 0);
+        outStart.assign(n + 1, 0);
+        for (auto& l : links) { inStart[l.to + 1]++; outStart[l.from + 1]++; }
+        for (int r = 0; r < n; r++) { inStart[r + 1] += inStart[r]; outStart[r + 1] += outStart[r]; }
+        in.resize(links.size());
+        out.resize(links.size());
+        vector<int> fi(inStart.begin(), inStart.end() - 1), fo(outStart.begin(), outStart.end() - 1);
+        inShare.assign(n, 0);
+        for (auto& l : links) {
+            in[fi[l.to]++] = {l.from, l.lag, l.attenuation, l.share * (1 - l.decay)};
+            out[fo[l.from]++] = {l.to, l.lag};
+            inShare[l.to] += l.share;
+        }
+
+        // Kahn's algorithm; a cycle leaves reaches unordered
+        vector<int> indeg(n);
+        for (auto& l : links) indeg[l.to]++;
+        order.clear();
+        for (int r = 0; r < n; r++) if (indeg[r] == 0) order.push_back(r);
+        for (size_t i = 0; i < order.size(); i++)
+            for (int k = outStart[order[i]]; k < outStart[order[i] + 1]; k++)
+                if (--indeg[out[k].reach] == 0) order.push_back(out[k].reach);
+        if ((int)order.size() != n) return false;
+        rank.resize(n);
+        for (int i = 0; i < n; i++) rank[order[i]] = i;
+
+        obsLevel.assign(n, 0); obsPollution.assign(n, 0);
+        normal.assign(n, 0); trendLevel.assign(n, 0); trendPollution.assign(n, 0);
+        sensed.assign(n, 0);
+        floodLimit.assign(n, 80); pollutionLimit.assign(n, 60);
+        hist.assign((size_t)n * W, {INT_MIN, 0, 0});
+        head.assign(n, 0);
+        queuedAt.assign(n, -1);
+        wheel.assign(W, vector<int>());
+        t = -1;
+        return true;
+    }
+
+    void setLimits(int r, float flood, float pollution) { floodLimit[r] = flood; pollutionLimit[r] = pollution; }
+
+    // Reading of reach r for the next step
+    void setReading(int r, float level, float pollution) {
+        if (!sensed[r]) {
+            sensed[r] = 1;
+            normal[r] = level;
+        } else {
+            // Per-step trend, smoothed so one noisy reading does not swing the forecast
+            trendLevel[r] += TrendAlpha * (level - obsLevel[r] - trendLevel[r]);
+            trendPollution[r] += TrendAlpha * (pollution - obsPollution[r] - trendPollution[r]);
+            if (level == obsLevel[r] && pollution == obsPollution[r]) return;
+        }
+        obsLevel[r] = level;
+        obsPollution[r] = pollution;
+        schedule(r, t + 1);
+    }
+
+    // Advances one timestep; returns how many reaches were recomputed
+    int step() {
+        t++;
+        if (t == 0) { full(); return n; }
+        for (int r : wheel[t % W]) push(r);
+        wheel[t % W].clear();
+
+        int done = 0;
+        while (!ready.empty()) {
+            int r = order[ready.top()];
+            ready.pop();
+            done++;
+            if (compute(r))
+                for (int k = outStart[r]; k < outStart[r + 1]; k++) schedule(out[k].reach, t + out[k].lag);
+        }
+        return done;
+    }
+
+    // Baseline: every reach recomputed in topological order
+    int fullStep() {
+        t++;
+        full();
+        return n;
+    }
+
+    float level(int r) const { return normal[r] + latest(r).anomaly; }
+    float pollution(int r) const { return latest(r).pollution; }
+    int reaches() const { return n; }
+    int now() const { return t; }
+
+    // Steps until each reach crosses its limits, assuming every reading
+    // keeps its smoothed per-step trend. Water already in transit is read
+    // from the reach histories; O(horizon * (reaches + links)).
+    vector<FloodForecast> forecast(int horizon) const {
+        vector<FloodForecast> f(n, {-1, -1});
+        vector<Value> rows((size_t)W * n);
+        auto at = [&](int u, int h) -> Value {
+            return h <= 0 ? valueAt(u, t + h) : rows[(size_t)(h % W) * n + u];
+        };
+        for (int r = 0; r < n; r++) {
+            Value v = latest(r);
+            if (normal[r] + v.anomaly >= floodLimit[r]) f[r].floodIn = 0;
+            if (v.pollution >= pollutionLimit[r]) f[r].pollutionIn = 0;
+        }
+        for (int h = 1; h <= horizon; h++) {
+            for (int r : order) {
+                Value v = mix(r, obsLevel[r] + h * trendLevel[r], obsPollution[r] + h * trendPollution[r],
+                              [&](int u, int lag) { return at(u, h - lag); });
+                rows[(size_t)(h % W) * n + r] = v;
+                if (f[r].floodIn < 0 && normal[r] + v.anomaly >= floodLimit[r]) f[r].floodIn = h;
+                if (f[r].pollutionIn < 0 && v.pollution >= pollutionLimit[r]) f[r].pollutionIn = h;
+            }
+        }
+        return f;
+    }
+
+    size_t bytes() const {
+        return (size_t)n * (sizeof(Value) * W + 4 * sizeof(int) + 10 * sizeof(float) + 1)
+             + in.size() * (sizeof(InLink) + sizeof(OutLink));
+    }
+
+private:
+    struct InLink { int reach, lag; float attenuation, pollutionGain; };
+    struct OutLink { int reach, lag; };
+    struct Value { int step; float anomaly, pollution; };
+
+    // Changes smaller than this stop propagating
+    static constexpr float Epsilon = 1e-3f;
+    static constexpr float TrendAlpha = 0.3f;
+
+    int n = 0, maxLag = 0, W = 1, t = -1;
+    vector<int> inStart, outStart, order, rank, head, queuedAt;
+    vector<InLink> in;
+    vector<OutLink> out;
+    vector<float> inShare, obsLevel, obsPollution, normal, trendLevel, trendPollution, floodLimit, pollutionLimit;
+    vector<char> sensed;
+    vector<Value> hist;                  // W most recent changes per reach
+    vector<vector<int>> wheel;           // reaches due at step s live in wheel[s % W]
+    priority_queue<int, vector<int>, greater<int>> ready;   // topological ranks due now
+
+    template <class Upstream>
+    Value mix(int r, float level, float pol, Upstream upstream) const {
+        float anomaly = sensed[r] ? level - normal[r] : 0;
+        float weight = (sensed[r] ? 1 : 0) + inShare[r];
+        float load = sensed[r] ? pol : 0;
+        for (int k = inStart[r]; k < inStart[r + 1]; k++) {
+            Value u = upstream(in[k].reach, in[k].lag);
+            anomaly += in[k].attenuation * u.anomaly;
+            load += in[k].pollutionGain * u.pollution;
+        }
+        return {t, anomaly, weight > 0 ? load / weight : 0};
+    }
+
+    const Value& latest(int r) const { return hist[(size_t)r * W + head[r]]; }
+
+    // Value of reach r as of step s (s >= t - maxLag)
+    Value valueAt(int r, int s) const {
+        for (int i = 0, k = head[r]; i < W; i++, k = k == 0 ? W - 1 : k - 1) {
+            const Value& v = hist[(size_t)r * W + k];
+            if (v.step <= s) return v;
+        }
+        return {s, 0, 0};
+    }
+
+    // Recomputes r for step t; true when the change is worth propagating
+    bool compute(int r) {
+        Value v = mix(r, obsLevel[r], obsPollution[r], [&](int u, int lag) { return valueAt(u, t - lag); });
+        const Value& old = latest(r);
+        bool changed = fabs(v.anomaly - old.anomaly) > Epsilon || fabs(v.pollution - old.pollution) > Epsilon;
+        if (!changed && old.step != INT_MIN) return false;
+        if (old.step != t) head[r] = head[r] + 1 == W ? 0 : head[r] + 1;
+        hist[(size_t)r * W + head[r]] = v;
+        return true;
+    }
+
+    void full() {
+        while (!ready.empty()) ready.pop();
+        for (auto& w : wheel) w.clear();
+        for (int r : order) compute(r);
+    }
+
+    void push(int r) {
+        if (queuedAt[r] == t) return;
+        queuedAt[r] = t;
+        ready.push(rank[r]);
+    }
+
+    void schedule(int r, int s) {
+        if (s <= t) push(r);
+        else wheel[s % W].push_back(r);
+    }
+};
+
+// Reaches are the subzones of allData; links come from a CSV with
+// columns From,To,Lag,Attenuation,Share,Decay (subzone names, lag in
+// readings steps)
+bool loadRiver(const vector<SubZone>& allData, string filename, RiverModel& model) {
+    NameIndex index;
+    for (size_t i = 0; i < allData.size(); i++)
+        index.add(allData[i].name, i);
+
+    MappedCSV file(filename);
+    CSVRow row;
+    if (!file.isOpen()) {
+        cerr << "Error opening file: " << filename << endl;
+        return false;
+    }
+    file.skipLine(); // skip header
+
+    vector<RiverLink> links;
+    while (file.nextRow(row)) {
+        int a = index.find(row[0]), b = index.find(row[1]);
+        if (a < 0 || b < 0) {
+            cerr << filename << ": unknown subzone in link " << row.str(0) << " -> " << row.str(1) << "\n";
+            return false;
+        }
+        links.push_back({a, b, row.toInt(2), row.toFloat(3), row.toFloat(4), row.toFloat(5)});
+    }
+    if (!model.build(allData.size(), links)) {
+        cerr << filename << ": links must form a DAG with non-negative lags\n";
+        return false;
+    }
+    return true;
+}
+
+// Replays a readings file (SubZone,Time,WaterLevel,Pollution; one step
+// per distinct time) through the river model and prints each
+// downstream subzone's state and time-to-threshold
+void floodForecast(vector<SubZone>& allData, string readings, int horizon) {
+    RiverModel model;
+    if (!loadRiver(allData, "water_river.csv", model)) exit(1);
+    NameIndex index;
+    for (size_t i = 0; i < allData.size(); i++) {
+        index.add(allData[i].name, i);
+        model.setReading(i, allData[i].waterLevel, allData[i].pollution);
+    }
+    model.step();
+
+    MappedCSV file(readings);
+    CSVRow row;
+    if (!file.isOpen()) {
+        cerr << "Error opening file: " << readings << endl;
+        exit(1);
+    }
+    file.skipLine(); // skip header
+
+    long long recomputed = 0;
+    int steps = 0;
+    bool pending = false;
+    double stepTime = 0;
+    while (file.nextRow(row)) {
+        int s = index.find(row[0]);
+        if (s < 0) continue;
+        double time = row.toDouble(1);
+        if (pending && time != stepTime) { recomputed += model.step(); steps++; }
+        stepTime = time;
+        pending = true;
+        model.setReading(s, row.toFloat(2), row.toFloat(3));
+    }
+    if (pending) { recomputed += model.step(); steps++; }
+
+    vector<FloodForecast> f = model.forecast(horizon);
+    cout << "=== FLOOD PROPAGATION FORECAST (" << steps << " steps, "
+         << recomputed << " reach updates, horizon " << horizon << ") ===\n";
+    for (size_t i = 0; i < allData.size(); i++) {
+        if (allData[i].zone == "Upstream") continue;
+        cout << allData[i].zone << "/" << allData[i].name
+             << " level " << model.level(i) << ", pollution " << model.pollution(i);
+        if (f[i].floodIn == 0) cout << ", FLOODING";
+        else if (f[i].floodIn > 0) cout << ", flood level in " << f[i].floodIn << " steps";
+        if (f[i].pollutionIn == 0) cout << ", OVER POLLUTION LIMIT";
+        else if (f[i].pollutionIn > 0) cout << ", pollution limit in " << f[i].pollutionIn << " steps";
+        cout << "\n";
+    }
+}
+
+/* ===================== COMPILED RULES ===================== */
+
+// The hand-written checks above, as data: water_rules.txt is compiled
+// once and run over the subzones as columns, one group per zone
+RuleEngine waterRuleEngine() {
+    RuleEngine rules;
+    rules.addColumn("waterLevel");
+    rules.addColumn("pollution");
+    return rules;
+}
+
+struct ZoneColumns {
+    vector<float> waterLevel, pollution;
+    vector<RuleGroup> groups;
+
+    vector<const float*> cols() const { return {waterLevel.data(), pollution.data()}; }
+};
+
+// data must already be grouped by ZoneIndex::build
+ZoneColumns zoneColumns(const vector<SubZone>& data, const ZoneIndex& index) {
+    ZoneColumns c;
+    c.waterLevel.reserve(data.size());
+    c.pollution.reserve(data.size());
+    for (auto& z : data) {
+        c.waterLevel.push_back(z.waterLevel);
+        c.pollution.push_back(z.pollution);
+    }
+    for (int z = 0; z < index.zones(); z++) {
+        SubZoneSpan s = index.span(z);
+        size_t b = s.begin() - data.data();
+        ZoneId basin = index.basinName(index.basinOf(z));
+        string zone = index.zoneName(z).str();
+        c.groups.push_back({basin.empty() ? zone : basin.str() + "/" + zone, b, b + s.size()});
+    }
+    return c;
+}
+
+void runRules(const RuleEngine& rules, const vector<SubZone>& data, const ZoneIndex& index) {
+    ZoneColumns c = zoneColumns(data, index);
+    vector<RuleHit> hits;
+    rules.evaluate(c.cols(), data.size(), c.groups, hits);
+    for (auto& h : hits)
+        cout << rules.format(h, c.groups, h.row >= 0 ? data[h.row].name.str() : "") << "\n";
+}
+
 /* ===================== PRIORITY QUEUE (HEAP) ===================== */
 
+float actionScore(const SubZone& z) {
+    float score = z.pollution * 2;
+
+    if (z.waterLevel > 80)
+        score += 50; // flood priority
+
+    return score;
+}
+
 priority_queue<ZonePriority> buildPriorityQueue(vector<SubZone>& allData) {
+    StageTimer timer(StageSort, allData.size());
     priority_queue<ZonePriority> pq;
 
-    for (auto& z : allData) {
-        float score = z.pollution * 2;
+    for (auto& z : allData)
+        pq.push({z.zone, z.name, actionScore(z)});
 
-        if (z.waterLevel > 80)
-            score += 50; // flood priority
+    return pq;
+}
 
-        pq.push({z.zone, z.name, score});
+// Indexed 4-ary max-heap of subzone ids (positions in allData) by action
+// score. Scores change in place in O(log4 n) as readings arrive; the heap
+// holds ints only and is never drained, so the dashboard can peek the top
+// K at any time. Equal scores keep the lower id first.
+class ActionQueue {
+public:
+    void build(const vector<float>& scores) {
+        int n = scores.size();
+        StageTimer timer(StageSort, n);
+        key = scores;
+        heap.resize(n);
+        pos.resize(n);
+        for (int i = 0; i < n; i++) { heap[i] = i; pos[i] = i; }
+        if (n < 2) return; // (n - 2) / D rounds to 0, not -1, for n == 0
+        for (int i = (n - 2) / D; i >= 0; i--) siftDown(i);
     }
-    return pq;
+
+    // Raises or lowers the score of subzone id; id == size() adds a new one
+    void update(int id, float score) {
+        if (id == (int)key.size()) {
+            key.push_back(score);
+            heap.push_back(id);
+            pos.push_back(heap.size() - 1);
+            siftUp(pos[id]);
+            return;
+        }
+        float old = key[id];
+        key[id] = score;
+        if (score > old) siftUp(pos[id]);
+        else if (score < old) siftDown(pos[id]);
+    }
+
+    int top() const { return heap.empty() ? -1 : heap[0]; }
+    float score(int id) const { return key[id]; }
+    int size() const { return heap.size(); }
+
+    // Highest k ids without touching the heap: best-first walk from the
+    // root over a small frontier, O(k log k)
+    vector<int> topK(int k) const {
+        vector<int> out;
+        if (heap.empty() || k <= 0) return out;
+        auto lower = [this](int a, int b) { return above(heap[b], heap[a]); };
+        priority_queue<int, vector<int>, decltype(lower)> frontier(lower);
+        frontier.push(0);
+        while (!frontier.empty() && (int)out.size() < k) {
+            int slot = frontier.top();
+            frontier.pop();
+            out.push_back(heap[slot]);
+            for (int c = D * slot + 1; c <= D * slot + D && c < (int)heap.size(); c++)
+                frontier.push(c);
+        }
+        return out;
+    }
+
+private:
+    static const int D = 4;
+    vector<int> heap, pos;
+    vector<float> key;
+
+    bool above(int a, int b) const { return key[a] > key[b] || (key[a] == key[b] && a < b); }
+    void place(int slot, int id) { heap[slot] = id; pos[id] = slot; }
+
+    void siftUp(int i) {
+        int x = heap[i];
+        while (i > 0) {
+            int parent = (i - 1) / D;
+            if (!above(x, heap[parent])) break;
+            place(i, heap[parent]);
+            i = parent;
+        }
+        place(i, x);
+    }
+    void siftDown(int i) {
+        int n = heap.size(), x = heap[i];
+        for (;;) {
+            int first = D * i + 1;
+            if (first >= n) break;
+            int best = first;
+            for (int c = first + 1; c < first + D && c < n; c++)
+                if (above(heap[c], heap[best])) best = c;
+            if (!above(heap[best], x)) break;
+            place(i, heap[best]);
+            i = best;
+        }
+        place(i, x);
+    }
+};
+
+ActionQueue buildActionQueue(vector<SubZone>& allData) {
+    vector<float> scores;
+    {
+        StageTimer timer(StageQuality, allData.size());
+        scores.reserve(allData.size());
+        for (auto& z : allData)
+            scores.push_back(actionScore(z));
+    }
+    ActionQueue q;
+    q.build(scores);
+    return q;
 }
 
-void processPriorities(priority_queue<ZonePriority>& pq) {
+void processPriorities(vector<SubZone>& allData, const ActionQueue& q) {
     cout << "\n--- PRIORITY ACTION ORDER (Heap Based) ---\n";
-    while (!pq.empty()) {
-        auto top = pq.top();
-        pq.pop();
-        cout << "Zone: " << top.zone
-             << ", SubZone: " << top.subzone
-             << ", Priority Score: " << top.score << endl;
+    for (int id : q.topK(q.size())) {
+        cout << "Zone: " << allData[id].zone
+             << ", SubZone: " << allData[id].name
+             << ", Priority Score: " << q.score(id) << endl;
     }
 }
 
+// n subzones, `updates` score changes at random subzones, a top-10 peek
+// every 1000 updates; baseline rebuilds the string priority_queue
+void benchmarkActionQueue(int n, int updates) {
+    vector<SubZone> data(n);
+    uint32_t seed = 3;
+    for (int i = 0; i < n; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        data[i] = {ZoneId("Basin" + to_string(i % 64)), ZoneId("S" + to_string(i)), (float)(40 + seed % 60), (float)((seed >> 8) % 100), ZoneId()};
+    }
+
+    auto t0 = chrono::steady_clock::now();
+    ActionQueue q = buildActionQueue(data);
+    double buildMs = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+
+    long long checksum = 0;
+    t0 = chrono::steady_clock::now();
+    for (int u = 0; n > 0 && u < updates; u++) { // no subzones, nothing to update
+        seed = seed * 1664525u + 1013904223u;
+        int id = seed % n;
+        data[id].pollution = (seed >> 12) % 100;
+        q.update(id, actionScore(data[id]));
+        if (u % 1000 == 999) checksum += q.topK(10)[0];
+    }
+    double updSec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    t0 = chrono::steady_clock::now();
+    vector<int> top = q.topK(10);
+    double peekUs = chrono::duration<double, micro>(chrono::steady_clock::now() - t0).count();
+
+    // What one refresh cost before: rebuild the record heap, drain for the top 10
+    t0 = chrono::steady_clock::now();
+    priority_queue<ZonePriority> pq = buildPriorityQueue(data);
+    for (int i = 0; i < 10 && !pq.empty(); i++) pq.pop();
+    double rebuildMs = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+
+    cout << "bench=water_priority subzones=" << n
+         << " updates=" << updates
+         << " build_ms=" << buildMs
+         << " ns_per_update=" << updSec * 1e9 / updates
+         << " updates_per_s=" << updates / updSec
+         << " top10_peek_us=" << peekUs
+         << " rebuild_pq_ms=" << rebuildMs
+         << " heap_bytes=" << (size_t)n * (2 * sizeof(int) + sizeof(float));
+    if (!top.empty()) cout << " top=" << data[top[0]].name << ":" << q.score(top[0]);
+    cout << " checksum=" << checksum << endl;
+}
+
+// National-scale river network: basins x zones x subzones, with the
+// subzone readings interleaved across zones as they arrive from the field
+void benchmarkZones(int basins, int zonesPerBasin, int subPerZone) {
+    int nz = basins * zonesPerBasin;
+    size_t n = (size_t)nz * subPerZone;
+    vector<SubZone> data(n);
+    uint32_t seed = 5;
+    for (size_t i = 0; i < n; i++) {
+        int z = i % nz;
+        seed = seed * 1664525u + 1013904223u;
+        data[i] = {ZoneId("B" + to_string(z / zonesPerBasin) + "-Z" + to_string(z % zonesPerBasin)),
+                   ZoneId("S" + to_string(i)), (float)(40 + seed % 60), (float)((seed >> 8) % 100),
+                   ZoneId("B" + to_string(z / zonesPerBasin))};
+    }
+
+    auto t0 = chrono::steady_clock::now();
+    ZoneIndex index;
+    index.build(data);
+    double buildMs = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+
+    // Every rule on every zone through spans
+    long long hits = 0;
+    t0 = chrono::steady_clock::now();
+    for (int z = 0; z < index.zones(); z++) {
+        SubZoneSpan s = index.span(z);
+        hits += floodRisk(s) + damPolluted(s) + (industrialSpike(s) != nullptr) + fishingSafe(s);
+    }
+    double sweepMs = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+
+    // Name lookups as the rule checks receive them
+    int lookups = 100000;
+    size_t found = 0;
+    vector<string> names;
+    for (int i = 0; i < lookups; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        int z = seed % nz;
+        names.push_back("B" + to_string(z / zonesPerBasin) + "-Z" + to_string(z % zonesPerBasin));
+    }
+    t0 = chrono::steady_clock::now();
+    for (int i = 0; i < lookups; i++)
+        found += index.span(names[i], "B" + names[i].substr(1, names[i].find('-') - 1)).size();
+    double lookupNs = chrono::duration<double, nano>(chrono::steady_clock::now() - t0).count() / lookups;
+
+    // Old path: one linear getZone per zone, timed on a sample and scaled up
+    int sample = min(nz, 20);
+    long long oldHits = 0;
+    t0 = chrono::steady_clock::now();
+    for (int k = 0; k < sample; k++) {
+        vector<SubZone> zone = getZone(data, index.zoneName((long long)k * nz / sample).str());
+        SubZoneSpan s{zone.data(), zone.size()};
+        oldHits += floodRisk(s) + damPolluted(s) + (industrialSpike(s) != nullptr) + fishingSafe(s);
+    }
+    double oldPerZoneMs = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count() / sample;
+
+    cout << "bench=water_zones basins=" << basins
+         << " zones=" << nz
+         << " subzones=" << n
+         << " build_ms=" << buildMs
+         << " sweep_ms=" << sweepMs
+         << " lookup_ns=" << lookupNs
+         << " getzone_ms_per_zone=" << oldPerZoneMs
+         << " getzone_sweep_est_s=" << oldPerZoneMs * nz / 1000
+         << " index_bytes=" << index.bytes()
+         << " hits=" << hits
+         << " sample_hits=" << oldHits
+         << " found=" << found << endl;
+}
+
+// Rules x readings per second: the four built-in checks on every zone,
+// hand-written and compiled, then a large generated rule set
+void benchmarkRules(int n, int nz, int nRules) {
+    vector<SubZone> data(n);
+    uint32_t seed = 9;
+    for (int i = 0; i < n; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        data[i] = {ZoneId("Z" + to_string(i % nz)), ZoneId("S" + to_string(i)), (float)(40 + seed % 60), (float)((seed >> 8) % 100), ZoneId()};
+    }
+    ZoneIndex index;
+    index.build(data);
+    ZoneColumns c = zoneColumns(data, index);
+
+    long long handHits = 0;
+    auto t0 = chrono::steady_clock::now();
+    for (int z = 0; z < index.zones(); z++) {
+        SubZoneSpan s = index.span(z);
+        handHits += floodRisk(s) + damPolluted(s) + (industrialSpike(s) != nullptr) + fishingSafe(s);
+    }
+    double handSec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    RuleEngine rules = waterRuleEngine();
+    string error;
+    rules.compile("flood each count(waterLevel > 80) >= 3 : f\n"
+                  "dam each avg(pollution) > 30 : d\n"
+                  "industrial each any(pollution > 60) : i\n"
+                  "fishing each count(pollution < 40) >= 3 : s\n", error);
+    vector<RuleHit> hits;
+    t0 = chrono::steady_clock::now();
+    rules.evaluate(c.cols(), n, c.groups, hits);
+    double ruleSec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    cout << "bench=water_rules_builtin subzones=" << n
+         << " zones=" << nz
+         << " rules=4"
+         << " hand_ms=" << handSec * 1e3
+         << " compiled_ms=" << ruleSec * 1e3
+         << " hand_rule_readings_per_s=" << 4.0 * n / handSec
+         << " compiled_rule_readings_per_s=" << 4.0 * n / ruleSec
+         << " hand_hits=" << handHits
+         << " compiled_hits=" << hits.size() << endl;
+
+    // Generated rule set: per-zone aggregates and network-wide row rules
+    static const char* aggs[] = {"count(waterLevel > %g) >= 3", "avg(pollution) > %g",
+                                 "any(pollution > %g)", "max(waterLevel) >= %g"};
+    static const char* ops[] = {">", ">=", "<", "<="};
+    string text;
+    long long scanned = 0;
+    char buf[96];
+    for (int r = 0; r < nRules; r++) {
+        seed = seed * 1664525u + 1013904223u;
+        int kind = seed % 5;
+        float t = 20 + (seed >> 8) % 80;
+        if (kind == 4) {
+            // 1 in 5 rules looks at every subzone, and is tight enough to hit rarely
+            int op = (seed >> 16) % 4;
+            snprintf(buf, sizeof(buf), "%s %g", ops[op], op < 2 ? 99.5f : 0.5f);
+            text += "r" + to_string(r) + " * pollution " + buf + " : {row}\n";
+            scanned += n;
+        } else {
+            int z = (seed >> 12) % nz;
+            snprintf(buf, sizeof(buf), aggs[kind], t);
+            text += "r" + to_string(r) + " Z" + to_string(z) + " " + buf + " : {group}\n";
+            scanned += index.span("Z" + to_string(z)).size();
+        }
+    }
+    t0 = chrono::steady_clock::now();
+    bool ok = rules.compile(text, error);
+    double compileMs = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+    if (!ok) { cerr << error << "\n"; return; }
+
+    hits.clear();
+    t0 = chrono::steady_clock::now();
+    rules.evaluate(c.cols(), n, c.groups, hits);
+    double evalSec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    cout << "bench=water_rules_generated subzones=" << n
+         << " zones=" << nz
+         << " rules=" << rules.size()
+         << " compile_ms=" << compileMs
+         << " eval_ms=" << evalSec * 1e3
+         << " rule_readings=" << scanned
+         << " rule_readings_per_s=" << scanned / evalSec
+         << " hits=" << hits.size() << endl;
+}
+
+// Synthetic river network: every reach drains into one of the next few
+// reaches (tributaries joining), 5% also feed a second one (distributaries).
+// Each step a fraction of the gauges report a new level; the incremental
+// model is checked against a full recompute fed the same readings.
+void benchmarkFlood(int n, int steps, double changedPct) {
+    vector<RiverLink> links;
+    uint32_t seed = 13;
+    auto rnd = [&]() { seed = seed * 1664525u + 1013904223u; return seed >> 8; };
+    for (int r = 0; r + 1 < n; r++) {
+        int to = min(n - 1, r + 1 + (int)(rnd() % 8));
+        links.push_back({r, to, (int)(rnd() % 4), 0.8f, 1.0f, 0.02f});
+        if (rnd() % 20 == 0 && to + 1 < n) {
+            links.back().share = 0.7f;
+            links.push_back({r, to + 1, 1 + (int)(rnd() % 3), 0.5f, 0.3f, 0.02f});
+        }
+    }
+
+    RiverModel inc, full;
+    auto t0 = chrono::steady_clock::now();
+    inc.build(n, links);
+    double buildMs = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+    full.build(n, links);
+
+    vector<float> level(n), pol(n);
+    for (int r = 0; r < n; r++) {
+        level[r] = 40 + rnd() % 30;
+        pol[r] = 10 + rnd() % 40;
+        inc.setReading(r, level[r], pol[r]);
+        full.setReading(r, level[r], pol[r]);
+    }
+    inc.step();
+    full.fullStep();
+
+    int changed = max(1, (int)(n * changedPct / 100));
+    long long recomputed = 0;
+    double incSec = 0, fullSec = 0;
+    for (int s = 0; s < steps; s++) {
+        for (int c = 0; c < changed; c++) {
+            int r = rnd() % n;
+            level[r] += (int)(rnd() % 5) - 2;
+            pol[r] += (int)(rnd() % 5) - 2;
+            inc.setReading(r, level[r], pol[r]);
+            full.setReading(r, level[r], pol[r]);
+        }
+        t0 = chrono::steady_clock::now();
+        recomputed += inc.step();
+        incSec += chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        t0 = chrono::steady_clock::now();
+        full.fullStep();
+        fullSec += chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    }
+
+    double maxDiff = 0;
+    for (int r = 0; r < n; r++)
+        maxDiff = max(maxDiff, (double)fabs(inc.level(r) - full.level(r)));
+
+    int horizon = 30;
+    t0 = chrono::steady_clock::now();
+    vector<FloodForecast> f = inc.forecast(horizon);
+    double forecastMs = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+    int atRisk = 0;
+    for (auto& x : f) atRisk += x.floodIn >= 0;
+
+    cout << "bench=water_flood reaches=" << n
+         << " links=" << links.size()
+         << " steps=" << steps
+         << " changed_per_step=" << changed
+         << " build_ms=" << buildMs
+         << " incremental_us_per_step=" << incSec * 1e6 / steps
+         << " full_us_per_step=" << fullSec * 1e6 / steps
+         << " speedup=" << fullSec / incSec
+         << " reaches_recomputed_per_step=" << (double)recomputed / steps
+         << " max_level_diff=" << maxDiff
+         << " forecast_ms=" << forecastMs
+         << " horizon=" << horizon
+         << " at_risk=" << atRisk
+         << " model_bytes=" << inc.bytes() << endl;
+}
+
+/* ===================== ALGORITHM BENCHMARK ===================== */
+
+// Times each step of the one-shot analysis on a water_zones_data.csv of
+// any size (Benchmarks/gen_data writes them). Spike edges chain the
+// subzones in file order, weighted by the pollution change, as the
+// upstream edges do; bellmanFordSpike is O(V * E) and runs on a prefix.
+void benchmarkAlgorithms(string filename) {
+    const int spikeCap = 20000;
+    vector<SubZone> data;
+    double ms = timeMs([&] { data = readCSV(filename); });
+    int n = data.size();
+    reportAlgorithm("water", "readCSV", n, ms);
+    if (n == 0)
+        return;
+
+    ZoneIndex zones;
+    ms = timeMs([&] { zones.build(data); });
+    reportAlgorithm("water", "ZoneIndex::build", n, ms);
+
+    // The greedy decisions on their own: every threshold check on every
+    // zone, without the alert output
+    long long hits = 0;
+    ms = timeMs([&] {
+        for (int z = 0; z < zones.zones(); z++) {
+            SubZoneSpan s = zones.span(z);
+            hits += floodRisk(s) + damPolluted(s) + (industrialSpike(s) != nullptr) + fishingSafe(s);
+        }
+    });
+    volatile long long sink = hits;
+    (void)sink;
+    reportAlgorithm("water", "thresholdChecks", n, ms);
+
+    ms = timeMs([&] { priority_queue<ZonePriority> pq = buildPriorityQueue(data); });
+    reportAlgorithm("water", "buildPriorityQueue", n, ms);
+
+    ActionQueue actions;
+    ms = timeMs([&] { actions = buildActionQueue(data); });
+    reportAlgorithm("water", "buildActionQueue", n, ms);
+
+    {
+        QuietCout quiet;
+        ms = timeMs([&] { processPriorities(data, actions); });
+    }
+    reportAlgorithm("water", "processPriorities", n, ms);
+
+    int small = min(n, spikeCap);
+    vector<Edge> edges;
+    for (int i = 0; i < small; i++) {
+        int next = (i + 1) % small;
+        edges.push_back({i, next, (int)(data[i].pollution - data[next].pollution)});
+    }
+    ms = timeMs([&] { bellmanFordSpike(small, edges); });
+    reportAlgorithm("water", "bellmanFordSpike", small, ms, n);
+    reportMetricsOverhead("water");
+}
+
 /* ===================== MAIN ===================== */
 
-int main() {
+/*
+ Usage:
+   waterQ                 analysis of water_zones_data.csv (or its fresh .snap)
+   waterQ snapshot [csv]  write <csv>.snap for fast startup
+   waterQ spikes <readings.csv>
+                          sliding-window spike detection over a readings stream
+   waterQ flood <readings.csv> [horizon]
+                          river propagation over water_river.csv with time-to-threshold
+   waterQ bench-flood [reaches] [steps] [changed%]
+                          incremental river propagation vs full recompute
+   waterQ bench-spikes [subzones] [seconds]
+                          spike detector throughput at 1 Hz per subzone
+   waterQ bench-priority [subzones] [updates]
+                          indexed action queue updates and top-K peeks
+   waterQ bench-zones [basins] [zones] [subzones]
+                          zone index build, rule sweep and lookups vs getZone
+   waterQ bench-rules [subzones] [zones] [rules]
+                          compiled rules vs the hand-written checks
+   waterQ bench-algorithms <csv>
+                          time every analysis algorithm on <csv>
 
-    vector<SubZone> allData = readCSV("water_zones_data.csv");
+ Any mode also exports per-stage counters and latency histograms when
+ METRICS_OUT=<file|unix:path> is set (see common/metrics.h).
+*/
+int main(int argc, char* argv[]) {
+    metricsExportAtExit("water");
+    string mode = argc > 1 ? argv[1] : "";
 
-    vector<SubZone> upstream     = getZone(allData, "Upstream");
-    vector<SubZone> dam          = getZone(allData, "Dam");
-    vector<SubZone> downstream1  = getZone(allData, "Downstream1");
-    vector<SubZone> downstream2  = getZone(allData, "Downstream2");
+    if (mode == "snapshot") {
+        string csv = argc > 2 ? argv[2] : "water_zones_data.csv";
+        vector<SubZone> data = readCSV(csv);
+        if (!writeSnapshot(data, csv + ".snap")) {
+            cerr << "Error writing " << csv << ".snap\n";
+            return 1;
+        }
+        cout << "Wrote " << data.size() << " subzones to " << csv << ".snap\n";
+        return 0;
+    }
+    if (mode == "spikes" && argc > 2) {
+        vector<SubZone> allData = loadZones("water_zones_data.csv");
+        detectSpikes(allData, argv[2]);
+        return 0;
+    }
+    if (mode == "flood" && argc > 2) {
+        vector<SubZone> allData = loadZones("water_zones_data.csv");
+        floodForecast(allData, argv[2], argc > 3 ? atoi(argv[3]) : 30);
+        return 0;
+    }
+    if (mode == "bench-flood") {
+        benchmarkFlood(argc > 2 ? atoi(argv[2]) : 100000, argc > 3 ? atoi(argv[3]) : 200,
+                       argc > 4 ? atof(argv[4]) : 0.1);
+        return 0;
+    }
+    if (mode == "bench-spikes") {
+        benchmarkSpikes(argc > 2 ? atoi(argv[2]) : 100000, argc > 3 ? atoi(argv[3]) : 60);
+        return 0;
+    }
+    if (mode == "bench-priority") {
+        benchmarkActionQueue(argc > 2 ? atoi(argv[2]) : 1000000, argc > 3 ? atoi(argv[3]) : 10000000);
+        return 0;
+    }
+    if (mode == "bench-zones") {
+        benchmarkZones(argc > 2 ? atoi(argv[2]) : 500, argc > 3 ? atoi(argv[3]) : 40,
+                       argc > 4 ? atoi(argv[4]) : 50);
+        return 0;
+    }
+    if (mode == "bench-rules") {
+        benchmarkRules(argc > 2 ? atoi(argv[2]) : 1000000, argc > 3 ? atoi(argv[3]) : 20000,
+                       argc > 4 ? atoi(argv[4]) : 2000);
+        return 0;
+    }
+    if (mode == "bench-algorithms" && argc > 2) {
+        benchmarkAlgorithms(argv[2]);
+        return 0;
+    }
+    if (!mode.empty()) {
+        cerr << "Usage: waterQ [snapshot [csv] | spikes <readings.csv> | flood <readings.csv> [horizon]\n"
+                "              | bench-flood [reaches] [steps] [changed%] | bench-spikes [subzones] [seconds]\n"
+                "              | bench-priority [subzones] [updates] | bench-zones [basins] [zones] [subzones]\n"
+                "              | bench-rules [subzones] [zones] [rules] | bench-algorithms <csv>]\n";
+        return 1;
+    }
+
+    vector<SubZone> allData = loadZones("water_zones_data.csv");
+    ZoneIndex zones;
+    zones.build(allData);
+
+    SubZoneSpan upstream     = zones.span("Upstream");
+    SubZoneSpan dam          = zones.span("Dam");
+    SubZoneSpan downstream1  = zones.span("Downstream1");
+    SubZoneSpan downstream2  = zones.span("Downstream2");
 
     vector<Edge> upstreamEdges = {
         {0,1,-5}, {1,2,-6}, {2,3,-8}, {3,4,-7}, {4,1,-10}
     };
 
+    // Rules from water_rules.txt when present, else the built-in checks
+    RuleEngine rules = waterRuleEngine();
+    bool useRules = access("water_rules.txt", R_OK) == 0;
+    string error;
+    if (useRules && !rules.load("water_rules.txt", error)) {
+        cerr << "water_rules.txt: " << error << "\n";
+        return 1;
+    }
+
     cout << "=== SMART WATER POLLUTION MONITORING SYSTEM ===\n\n";
 
     if (bellmanFordSpike(5, upstreamEdges))
         cout << "Sudden Spike Detected in Upstream Subzones\n";
 
-    floodCheck(upstream);
-    damControl(dam);
-    industrialAlert(downstream2);
-    fishingCheck(downstream1);
+    if (useRules)
+        runRules(rules, allData, zones);
+    else {
+        floodCheck(upstream);
+        damControl(dam);
+        industrialAlert(downstream2);
+        fishingCheck(downstream1);
+    }
 
-    auto pq = buildPriorityQueue(allData);
-    processPriorities(pq);
+    ActionQueue actions = buildActionQueue(allData);
+    processPriorities(allData, actions);
 
     return 0;
 }
@@ -2,10 +2,20 @@
 #include <vector>
 #include <queue>
 #include <climits>
-#include <fstream>
-#include <sstream>
 #include <string>
 #include <algorithm>
+#include <unordered_map>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <cmath>
+#include "../common/mapped_csv.h"
+#include "../common/bench_timer.h"
+#include "../common/metrics.h"
 
 using namespace std;
 
@@ -13,6 +23,8 @@ using namespace std;
 #define NEIGHBORS 4
 #define MAX_GREEN 60
 #define MIN_GREEN 15
+#define LOST_TIME 4            // amber + all-red per phase, seconds
+#define SATURATION_FLOW 0.5    // vehicles per second of green per approach
 
 struct Signal {
     int id;
@@ -37,9 +49,422 @@ vector<int> dijkstra(vector<vector<int> >& graph, int src);
 void heapify(vector<Signal>& s, int n, int i);
 void heapSort(vector<Signal>& s);
 void initGraph(vector<vector<int> >& graph);
+int computeGreenTime(int vehicles, int adjustedLoad);
 
+/* City-wide network (CSR): signals of junction j are
+   signals[signalStart[j] .. signalStart[j+1]), its neighbours are
+   neighborIds[neighborStart[j] .. neighborStart[j+1]). Junctions are
+   stored by dense index; junctionIds maps back to the CSV id. */
+struct JunctionNetwork {
+    vector<int> junctionIds;
+    vector<int> signalStart;
+    vector<Signal> signals;
+    vector<int> totalVehicles;
+    vector<int> neighborStart;
+    vector<int> neighborIds;
+
+    int size() const { return (int)junctionIds.size(); }
+};
+
+void loadNetworkCSV(const string& signalFile, const string& linkFile, JunctionNetwork& net);
+void buildNetwork(JunctionNetwork& net, vector<pair<int,Signal> >& rows,
+                  vector<pair<int,int> >& links);
+void generateNetwork(JunctionNetwork& net, int junctions, unsigned seed);
+bool optimizeJunction(JunctionNetwork& net, int j, const vector<int>& loads);
+int runNetworkCycle(JunctionNetwork& net);
+void displayNetwork(const JunctionNetwork& net, int limit);
+void benchmarkNetwork();
+
+/* Parallel cycle over a JunctionNetwork. Junctions are cut into chunks of
+   roughly equal signal work; each thread owns a contiguous run of chunks
+   and steals from the back of other threads' runs when it is done.
+   Neighbour loads are double-buffered: a cycle reads the loads published
+   by the previous cycle and writes its own into the other buffer, so
+   junctions never wait on each other. */
+class ParallelCycleScheduler {
+public:
+    ParallelCycleScheduler(JunctionNetwork& net, int threads);
+    ~ParallelCycleScheduler();
+
+    int runCycle();                     // returns emergency junctions
+    long long steals() const { return stealCount.load(); }
+
+private:
+    struct WorkRange {
+        atomic<uint64_t> range;         // head in high 32 bits, tail in low 32
+        char pad[64 - sizeof(atomic<uint64_t>)];
+    };
+
+    JunctionNetwork& net;
+    int threadCount;
+    vector<int> chunkStart;             // chunk c = junctions [chunkStart[c], chunkStart[c+1])
+    vector<int> ownerStart;             // thread t owns chunks [ownerStart[t], ownerStart[t+1])
+    vector<WorkRange> work;
+    vector<int> loads[2];
+    int front;
+
+    vector<thread> workers;
+    mutex lock;
+    condition_variable startCv, doneCv;
+    long long generation;
+    int running;
+    bool stopping;
+    atomic<int> emergencies;
+    atomic<long long> stealCount;
+
+    void workerLoop(int t);
+    void runShare(int t);
+    bool popOwn(int t, int& chunk);
+    bool stealFrom(int victim, int& chunk);
+    void processChunk(int chunk);
+};
+
+void benchmarkParallelCycle(int maxThreads);
+
+/* Weighted road graph (CSR) for emergency corridors. Edge e runs from
+   junction u to edgeTo[e] in edgeTime[e] seconds; edgeSignal[e] is the
+   approach signal at edgeTo[e] serving traffic that arrives over e.
+   Coordinates (metres) feed the A* heuristic. */
+struct RoadGraph {
+    vector<int> nodeIds;
+    vector<double> x, y;
+    vector<int> edgeStart;
+    vector<int> edgeTo;
+    vector<float> edgeTime;
+    vector<int> edgeSignal;
+    double maxSpeed;            // fastest edge, metres per second
+
+    // ALT landmarks: for node v, landmarkTimes[(v * landmarks + k) * 2]
+    // is the travel time from landmark k and [.. + 1] the time to it
+    int landmarks;
+    vector<float> landmarkTimes;
+
+    int size() const { return (int)nodeIds.size(); }
+};
+
+struct EmergencyRequest {
+    int vehicle;
+    int source;                 // dense road node index
+    int target;
+};
+
+struct CorridorStep {
+    int junction;               // dense road node index
+    int signal;                 // approach signal to hold green, -1 at the source
+    float arrival;              // seconds after dispatch
+};
+
+struct Corridor {
+    int vehicle;
+    bool reachable;
+    float travelTime;
+    vector<CorridorStep> steps;
+};
+
+/* A* search on a binary heap. The heuristic is the larger of straight-
+   line distance / maxSpeed and the ALT landmark bound (triangle
+   inequality on precomputed landmark travel times), both admissible.
+   The workspace is reset lazily through a visit stamp, so a query only
+   touches the part of the graph it explores. One planner per thread. */
+class CorridorPlanner {
+public:
+    explicit CorridorPlanner(const RoadGraph& graph);
+    Corridor plan(const EmergencyRequest& request);
+    int lastSettled() const { return settled; }
+
+private:
+    struct NodeState {
+        float dist;
+        int parentEdge;
+        unsigned stamp;         // == currentStamp when valid for this query
+        bool closed;
+    };
+
+    const RoadGraph& g;
+    vector<NodeState> state;
+    unsigned currentStamp;
+    vector<pair<float,int> > heap;
+    int settled;
+    int target;
+    vector<float> targetFrom, targetTo;
+
+    float heuristic(int v) const;
+    NodeState& touch(int v);
+};
+
+void loadRoadCSV(const string& nodeFile, const string& linkFile, RoadGraph& g);
+void buildRoadGraph(RoadGraph& g, vector<int>& from, vector<int>& to,
+                    vector<float>& time, vector<int>& signal);
+void generateRoadGraph(RoadGraph& g, int nodes, unsigned seed);
+void buildLandmarks(RoadGraph& g, int count);
+vector<Corridor> planCorridors(const RoadGraph& g, const vector<EmergencyRequest>& requests, int threads);
+int applyPreemption(JunctionNetwork& net, const RoadGraph& g, const vector<Corridor>& corridors);
+void displayCorridor(const RoadGraph& g, const Corridor& c);
+void benchmarkCorridors();
+
+/* Shortest-path tree towards one root (e.g. a hospital) that is kept
+   alive while road costs change. Edge times and blocked flags are
+   changed through the setters and repaired in one batch by update():
+   only the subtree hanging off a slower or blocked tree edge is
+   invalidated and re-settled, and faster edges are propagated outwards
+   from where they improve a distance. */
+class DynamicCorridorTree {
+public:
+    DynamicCorridorTree(const RoadGraph& graph, int root);
+
+    void setEdgeTime(int e, float time);
+    void setEdgeBlocked(int e, bool blocked);
+    void setNodeBlocked(int v, bool blocked);
+
+    int update();               // repair pending changes, returns nodes re-settled
+                                // (falls back to recompute() for large repairs)
+    void recompute();           // full Dijkstra from scratch
+
+    float timeToRoot(int v) const { return dist[v]; }
+    Corridor corridorFrom(int vehicle, int source) const;
+
+private:
+    const RoadGraph& g;
+    int root;
+    vector<int> edgeFrom;
+    vector<int> inStart, inEdge;    // in-edges of v: inEdge[inStart[v] .. inStart[v+1])
+    vector<float> baseTime, weight; // weight = effective time, 1e30 when blocked
+    vector<char> edgeBlocked, nodeBlocked;
+    vector<float> dist;
+    vector<int> nextEdge;           // tree edge from v towards the root
+    vector<int> pending;
+    vector<char> isPending, affected;
+    priority_queue<pair<float,int>, vector<pair<float,int> >, greater<pair<float,int> > > pq;
+
+    float effectiveWeight(int e) const;
+    void markChanged(int e);
+    int settle();
+};
+
+void benchmarkDynamicCorridor();
+
+/* Replay of recorded traffic through the controller. arrivals[t * S + k]
+   is the number of vehicles counted at network signal k (S signals in
+   total) during interval t; every interval is intervalSeconds long. */
+struct TrafficRecording {
+    int intervals;
+    int intervalSeconds;
+    vector<unsigned short> arrivals;
+};
+
+enum ReplayPolicy {
+    PolicyFixed,                // equal fixed-time plan
+    PolicyJunction,             // computeGreenTime on the junction's own load
+    PolicyNetwork,              // optimizeJunction: own load + neighbour average
+    PolicyLongestQueue,         // MAX_GREEN to the longest queue, MIN_GREEN to the rest
+    PolicyCount
+};
+
+struct ReplayScenario {
+    ReplayPolicy policy;
+    double demand;              // multiplier on the recorded counts
+};
+
+struct ReplayResult {
+    ReplayScenario scenario;
+    double vehicles;            // arrivals replayed
+    double delay;               // vehicle-seconds spent waiting
+    double avgQueue;            // vehicles waiting per signal, time-averaged
+    double maxQueue;            // largest queue left at the end of an interval
+    double leftQueued;          // still waiting when the recording ends
+    double ms;
+};
+
+void loadRecordingCSV(const string& filename, const JunctionNetwork& net,
+                      int intervalSeconds, TrafficRecording& rec);
+void generateRecording(const JunctionNetwork& net, int intervals, int intervalSeconds,
+                       unsigned seed, TrafficRecording& rec);
+const char* policyName(ReplayPolicy policy);
+ReplayResult replayScenario(const JunctionNetwork& net, const TrafficRecording& rec,
+                            const ReplayScenario& scenario);
+vector<ReplayResult> replayScenarios(const JunctionNetwork& net, const TrafficRecording& rec,
+                                     const vector<ReplayScenario>& scenarios, int threads);
+void displayReplay(const vector<ReplayResult>& results);
+void benchmarkReplay(int junctions, int threads);
+
+/* Arterial corridor for green-wave coordination: junctions[i] is the
+   dense network index of the i-th junction in driving order, signals[i]
+   the network signal whose green serves the arterial there (both
+   directions), travel[i] the seconds from junctions[i - 1]. */
+struct Arterial {
+    vector<int> junctions;
+    vector<int> signals;
+    vector<int> travel;
+};
+
+struct GreenWave {
+    int cycle;                  // common cycle, seconds
+    vector<int> green;          // arterial green per junction, stretched to the cycle
+    vector<int> offset;         // arterial green start, seconds into the common cycle
+    int outbound, inbound;      // through bandwidth each way, seconds
+};
+
+void loadArterialCSV(const string& filename, const JunctionNetwork& net, Arterial& a);
+GreenWave uncoordinatedWave(const JunctionNetwork& net, const Arterial& a);
+GreenWave planGreenWave(const JunctionNetwork& net, const Arterial& a);
+void measureBandwidth(const Arterial& a, GreenWave& w);
+void displayGreenWave(const JunctionNetwork& net, const Arterial& a,
+                      const GreenWave& before, const GreenWave& after);
+void benchmarkGreenWave(int junctions);
+void benchmarkAlgorithms(const string& filename);
+
+
+/*
+ Usage:
+   t                                  single junction (traffic_data.csv + nearby_junctions.csv)
+   t network <signals.csv> <links.csv> one timing cycle over a whole junction network
+   t bench-network                    cycle time at 1k / 10k / 100k junctions
+   t bench-parallel [threads]         parallel cycle latency, 1..threads
+   t corridor <nodes.csv> <roads.csv> <requests.csv> [<signals.csv> <links.csv>]
+                                      green corridors for simultaneous emergencies,
+                                      optionally applied to a junction network
+   t bench-corridor                   corridor latency on a 100k-node road graph
+   t bench-dynamic                    corridor tree repair vs recompute under churn
+   t replay <signals.csv> <links.csv> <counts.csv> [interval_sec] [threads]
+                                      replay recorded counts under every timing policy
+   t bench-replay [junctions] [threads] replay a synthetic city-day
+   t greenwave <signals.csv> <links.csv> <arterial.csv>
+                                      green-wave offsets along an arterial
+   t bench-greenwave [junctions]      corridor re-solve latency under count changes
+   t bench-algorithms <traffic.csv>   time every timing algorithm on a traffic_data.csv
+
+ Any mode also exports per-stage counters and latency histograms when
+ METRICS_OUT=<file|unix:path> is set (see common/metrics.h).
+*/
+int main(int argc, char* argv[]) {
+    metricsExportAtExit("traffic");
+    string mode = argc > 1 ? argv[1] : "";
+
+    if (mode == "network" && argc >= 4) {
+        JunctionNetwork net;
+        loadNetworkCSV(argv[2], argv[3], net);
+        cout << "SMART TRAFFIC MANAGEMENT SYSTEM (NETWORK MODE)\n\n";
+        int emergencies = runNetworkCycle(net);
+        cout << "Junctions: " << net.size() << " | Signals: " << net.signals.size()
+             << " | Emergency junctions: " << emergencies << endl;
+        displayNetwork(net, 20);
+        return 0;
+    }
+    if (mode == "bench-network") {
+        benchmarkNetwork();
+        return 0;
+    }
+    if (mode == "bench-parallel") {
+        int maxThreads = argc > 2 ? atoi(argv[2]) : (int)thread::hardware_concurrency();
+        benchmarkParallelCycle(max(maxThreads, 1));
+        return 0;
+    }
+    if (mode == "corridor" && argc >= 5) {
+        RoadGraph roads;
+        loadRoadCSV(argv[2], argv[3], roads);
+
+        unordered_map<int,int> dense;
+        for (int v = 0; v < roads.size(); v++)
+            dense[roads.nodeIds[v]] = v;
+
+        vector<EmergencyRequest> requests;
+        MappedCSV file(argv[4]);
+        if (!file.isOpen()) {
+            cerr << "Error opening file: " << argv[4] << endl;
+            exit(1);
+        }
+        CSVRow row;
+        file.skipLine(); // skip header
+        while (file.nextRow(row)) {
+            EmergencyRequest r;
+            r.vehicle = row.toInt(0);
+            int source = row.toInt(1);
+            int target = row.toInt(2);
+            if (!dense.count(source) || !dense.count(target)) {
+                cerr << "Skipping vehicle " << r.vehicle << ": unknown junction\n";
+                continue;
+            }
+            r.source = dense[source];
+            r.target = dense[target];
+            requests.push_back(r);
+        }
+
+        cout << "SMART TRAFFIC MANAGEMENT SYSTEM (GREEN CORRIDORS)\n";
+        vector<Corridor> corridors = planCorridors(roads, requests, 1);
+        for (size_t i = 0; i < corridors.size(); i++)
+            displayCorridor(roads, corridors[i]);
+
+        if (argc >= 7) {
+            JunctionNetwork net;
+            loadNetworkCSV(argv[5], argv[6], net);
+            runNetworkCycle(net);
+            int conflicts = applyPreemption(net, roads, corridors);
+            cout << "\nPreempted network timings (conflicts: " << conflicts << "):\n";
+            displayNetwork(net, 20);
+        }
+        return 0;
+    }
+    if (mode == "bench-corridor") {
+        benchmarkCorridors();
+        return 0;
+    }
+    if (mode == "bench-dynamic") {
+        benchmarkDynamicCorridor();
+        return 0;
+    }
+    if (mode == "replay" && argc >= 5) {
+        JunctionNetwork net;
+        loadNetworkCSV(argv[2], argv[3], net);
+        TrafficRecording rec;
+        loadRecordingCSV(argv[4], net, argc > 5 ? atoi(argv[5]) : 300, rec);
+        int threads = argc > 6 ? atoi(argv[6]) : (int)thread::hardware_concurrency();
+
+        vector<ReplayScenario> scenarios;
+        for (int p = 0; p < PolicyCount; p++) {
+            ReplayScenario s = { (ReplayPolicy)p, 1.0 };
+            scenarios.push_back(s);
+        }
+        cout << "SMART TRAFFIC MANAGEMENT SYSTEM (REPLAY)\n\n";
+        cout << "Junctions: " << net.size() << " | Signals: " << net.signals.size()
+             << " | Intervals: " << rec.intervals << " x " << rec.intervalSeconds << " sec\n\n";
+        displayReplay(replayScenarios(net, rec, scenarios, max(threads, 1)));
+        return 0;
+    }
+    if (mode == "bench-replay") {
+        int junctions = argc > 2 ? atoi(argv[2]) : 10000;
+        int threads = argc > 3 ? atoi(argv[3]) : (int)thread::hardware_concurrency();
+        benchmarkReplay(max(junctions, 1), max(threads, 1));
+        return 0;
+    }
+    if (mode == "greenwave" && argc >= 5) {
+        JunctionNetwork net;
+        loadNetworkCSV(argv[2], argv[3], net);
+        Arterial arterial;
+        loadArterialCSV(argv[4], net, arterial);
+        runNetworkCycle(net);
+        cout << "SMART TRAFFIC MANAGEMENT SYSTEM (GREEN WAVE)\n\n";
+        displayGreenWave(net, arterial, uncoordinatedWave(net, arterial), planGreenWave(net, arterial));
+        return 0;
+    }
+    if (mode == "bench-greenwave") {
+        benchmarkGreenWave(argc > 2 ? max(atoi(argv[2]), 2) : 200);
+        return 0;
+    }
+    if (mode == "bench-algorithms" && argc >= 3) {
+        benchmarkAlgorithms(argv[2]);
+        return 0;
+    }
+    if (!mode.empty()) {
+        cerr << "Usage: t [network <signals.csv> <links.csv> | bench-network | bench-parallel [threads]\n"
+                "          | corridor <nodes.csv> <roads.csv> <requests.csv> [<signals.csv> <links.csv>]\n"
+                "          | bench-corridor | bench-dynamic\n"
+                "          | replay <signals.csv> <links.csv> <counts.csv> [interval_sec] [threads]\n"
+                "          | bench-replay [junctions] [threads]\n"
+                "          | greenwave <signals.csv> <links.csv> <arterial.csv> | bench-greenwave [junctions]\n"
+                "          | bench-algorithms <traffic.csv>]\n";
+        return 1;
+    }
 
-int main() {
     Junction current;
     current.id = 0;
     current.signals.resize(SIGNALS);
@@ -80,68 +505,55 @@ void initGraph(vector<vector<int> >& graph) {
 
 /* ---------- READ SIGNAL CSV ---------- */
 void readSignalCSV(const string& filename, Junction& j) {
-    ifstream file(filename);
-    string line;
+    MappedCSV file(filename);
+    CSVRow row;
 
-    if(!file.is_open()) {
+    if(!file.isOpen()) {
         cerr << "Error opening file: " << filename << endl;
         exit(1);
     }
 
-    getline(file, line); // skip header
+    StageTimer timer(StageParse);
+    file.skipLine(); // skip header
     j.totalVehicles = 0;
     int index = 0;
 
-    while (getline(file, line) && index < SIGNALS) {
-        stringstream ss(line);
-        string temp;
-
-        getline(ss, temp, ','); // signal id
-        j.signals[index].id = index;
-
-        getline(ss, temp, ',');
-        j.signals[index].vehicles = atoi(temp.c_str());
-
-        getline(ss, temp, ',');
-        j.signals[index].emergency = atoi(temp.c_str());
-
+    while (index < SIGNALS && file.nextRow(row)) {
+        j.signals[index].id = index;                 // column 0: signal id
+        j.signals[index].vehicles = row.toInt(1);
+        j.signals[index].emergency = row.toInt(2);
         j.signals[index].greenTime = 0;
         j.totalVehicles += j.signals[index].vehicles;
         index++;
     }
-    file.close();
+    timer.addItems(index);
 }
 
 /* ---------- READ NEARBY JUNCTION CSV ---------- */
 void readNearbyCSV(const string& filename, vector<Junction>& neighbors) {
-    ifstream file(filename);
-    string line;
+    MappedCSV file(filename);
+    CSVRow row;
 
-    if(!file.is_open()) {
+    if(!file.isOpen()) {
         cerr << "Error opening file: " << filename << endl;
         exit(1);
     }
 
-    getline(file, line); // skip header
+    StageTimer timer(StageParse);
+    file.skipLine(); // skip header
     int index = 0;
 
-    while (getline(file, line) && index < NEIGHBORS) {
-        stringstream ss(line);
-        string temp;
-
-        getline(ss, temp, ',');
-        neighbors[index].id = atoi(temp.c_str());
-
-        getline(ss, temp, ',');
-        neighbors[index].totalVehicles = atoi(temp.c_str());
-
+    while (index < NEIGHBORS && file.nextRow(row)) {
+        neighbors[index].id = row.toInt(0);
+        neighbors[index].totalVehicles = row.toInt(1);
         index++;
     }
-    file.close();
+    timer.addItems(index);
 }
 
 /* ---------- CHECK EMERGENCY ---------- */
 int checkEmergency(const Junction& j) {
+    StageTimer timer(StageAlerts, SIGNALS);
     for (int i = 0; i < SIGNALS; i++) {
         if (j.signals[i].emergency)
             return i;
@@ -151,6 +563,7 @@ int checkEmergency(const Junction& j) {
 
 /* ---------- HANDLE EMERGENCY ---------- */
 void handleEmergency(Junction& j, vector<vector<int> >& graph, int source) {
+    StageTimer timer(StageSearch, SIGNALS);
     cout << "🚑 Emergency detected at Signal " << source + 1 << endl;
 
     vector<int> dist = dijkstra(graph, source);
@@ -177,17 +590,23 @@ void optimizeTraffic(Junction& j, const vector<Junction>& neighbors) {
 
     int adjustedLoad = j.totalVehicles + (neighborLoad / NEIGHBORS);
 
-    for (size_t i = 0; i < j.signals.size(); i++) {
-        j.signals[i].greenTime = (j.signals[i].vehicles * MAX_GREEN) / adjustedLoad;
-        if (j.signals[i].greenTime < MIN_GREEN)
-            j.signals[i].greenTime = MIN_GREEN;
-    }
+    for (size_t i = 0; i < j.signals.size(); i++)
+        j.signals[i].greenTime = computeGreenTime(j.signals[i].vehicles, adjustedLoad);
 
     // Restore original signal order
     sort(j.signals.begin(), j.signals.end(),
          [](const Signal& a, const Signal& b){ return a.id < b.id; });
 }
 
+/* ---------- GREEN TIME SPLIT ---------- */
+// Proportional share of MAX_GREEN, never below MIN_GREEN.
+int computeGreenTime(int vehicles, int adjustedLoad) {
+    if (adjustedLoad <= 0)
+        return MIN_GREEN;
+    int green = (vehicles * MAX_GREEN) / adjustedLoad;
+    return green < MIN_GREEN ? MIN_GREEN : green;
+}
+
 /* ---------- HEAP SORT ---------- */
 void heapify(vector<Signal>& s, int n, int i) {
     int largest = i;
@@ -207,6 +626,7 @@ void heapify(vector<Signal>& s, int n, int i) {
 
 void heapSort(vector<Signal>& s) {
     int n = s.size();
+    StageTimer timer(StageSort, n);
     for (int i = n/2 -1; i >=0; i--)
         heapify(s,n,i);
     for (int i = n-1; i>0; i--) {
@@ -246,3 +666,1748 @@ void displayJunction(const Junction& j) {
     }
 }
 
+
+/* ---------- LOAD JUNCTION NETWORK ---------- */
+// signals file: junction_id,signal_id,vehicles,emergency (one row per signal)
+// links file:   junction_id,neighbor_id                 (one row per directed link)
+void loadNetworkCSV(const string& signalFile, const string& linkFile, JunctionNetwork& net) {
+    StageTimer timer(StageParse);
+    vector<pair<int,Signal> > rows;
+    vector<pair<int,int> > links;
+    CSVRow row;
+
+    MappedCSV sfile(signalFile);
+    if (!sfile.isOpen()) {
+        cerr << "Error opening file: " << signalFile << endl;
+        exit(1);
+    }
+    sfile.skipLine(); // skip header
+    while (sfile.nextRow(row)) {
+        Signal s;
+        s.id = row.toInt(1);
+        s.vehicles = row.toInt(2);
+        s.emergency = row.toInt(3);
+        s.greenTime = 0;
+        rows.push_back(make_pair(row.toInt(0), s));
+    }
+
+    MappedCSV lfile(linkFile);
+    if (!lfile.isOpen()) {
+        cerr << "Error opening file: " << linkFile << endl;
+        exit(1);
+    }
+    lfile.skipLine(); // skip header
+    while (lfile.nextRow(row))
+        links.push_back(make_pair(row.toInt(0), row.toInt(1)));
+
+    buildNetwork(net, rows, links);
+    timer.addItems(rows.size() + links.size());
+}
+
+/* ---------- BUILD CSR NETWORK ---------- */
+// rows/links use external junction ids; ids are densified in order of
+// first appearance in rows. Links naming unknown junctions are dropped.
+void buildNetwork(JunctionNetwork& net, vector<pair<int,Signal> >& rows,
+                  vector<pair<int,int> >& links) {
+    unordered_map<int,int> dense;
+    dense.reserve(rows.size());
+    net.junctionIds.clear();
+
+    for (size_t i = 0; i < rows.size(); i++) {
+        if (dense.find(rows[i].first) == dense.end()) {
+            dense[rows[i].first] = (int)net.junctionIds.size();
+            net.junctionIds.push_back(rows[i].first);
+        }
+    }
+    int n = net.size();
+
+    // Counting sort of signals by junction (keeps file order inside a junction)
+    net.signalStart.assign(n + 1, 0);
+    for (size_t i = 0; i < rows.size(); i++)
+        net.signalStart[dense[rows[i].first] + 1]++;
+    for (int j = 0; j < n; j++)
+        net.signalStart[j + 1] += net.signalStart[j];
+
+    net.signals.resize(rows.size());
+    net.totalVehicles.assign(n, 0);
+    vector<int> fill(net.signalStart.begin(), net.signalStart.end() - 1);
+    for (size_t i = 0; i < rows.size(); i++) {
+        int j = dense[rows[i].first];
+        Signal s = rows[i].second;
+        s.id = fill[j] - net.signalStart[j]; // position inside the junction
+        net.signals[fill[j]++] = s;
+        net.totalVehicles[j] += s.vehicles;
+    }
+
+    // Same for neighbour links
+    vector<pair<int,int> > denseLinks;
+    denseLinks.reserve(links.size());
+    for (size_t i = 0; i < links.size(); i++) {
+        unordered_map<int,int>::iterator a = dense.find(links[i].first);
+        unordered_map<int,int>::iterator b = dense.find(links[i].second);
+        if (a != dense.end() && b != dense.end() && a->second != b->second)
+            denseLinks.push_back(make_pair(a->second, b->second));
+    }
+    if (denseLinks.size() != links.size())
+        cerr << "Warning: dropped " << links.size() - denseLinks.size()
+             << " links to unknown junctions\n";
+
+    net.neighborStart.assign(n + 1, 0);
+    for (size_t i = 0; i < denseLinks.size(); i++)
+        net.neighborStart[denseLinks[i].first + 1]++;
+    for (int j = 0; j < n; j++)
+        net.neighborStart[j + 1] += net.neighborStart[j];
+
+    net.neighborIds.resize(denseLinks.size());
+    fill.assign(net.neighborStart.begin(), net.neighborStart.end() - 1);
+    for (size_t i = 0; i < denseLinks.size(); i++)
+        net.neighborIds[fill[denseLinks[i].first]++] = denseLinks[i].second;
+}
+
+/* ---------- SYNTHETIC CITY ---------- */
+// Square grid of junctions with 2-6 signals each, 4-way neighbour links
+// and a rare emergency flag. Used by the benchmark.
+void generateNetwork(JunctionNetwork& net, int junctions, unsigned seed) {
+    mt19937 rng(seed);
+    uniform_int_distribution<int> signalCount(2, 6);
+    uniform_int_distribution<int> vehicles(0, 60);
+    uniform_int_distribution<int> emergency(0, 999);
+
+    vector<pair<int,Signal> > rows;
+    vector<pair<int,int> > links;
+    rows.reserve(junctions * 4);
+    links.reserve(junctions * 4);
+
+    int side = 1;
+    while (side * side < junctions) side++;
+
+    for (int j = 0; j < junctions; j++) {
+        int count = signalCount(rng);
+        for (int k = 0; k < count; k++) {
+            Signal s;
+            s.id = k;
+            s.vehicles = vehicles(rng);
+            s.emergency = emergency(rng) == 0;
+            s.greenTime = 0;
+            rows.push_back(make_pair(j, s));
+        }
+
+        int r = j / side, c = j % side;
+        if (c > 0)                           links.push_back(make_pair(j, j - 1));
+        if (c + 1 < side && j + 1 < junctions) links.push_back(make_pair(j, j + 1));
+        if (r > 0)                           links.push_back(make_pair(j, j - side));
+        if (j + side < junctions)            links.push_back(make_pair(j, j + side));
+    }
+    buildNetwork(net, rows, links);
+}
+
+/* ---------- OPTIMIZE ONE NETWORK JUNCTION ---------- */
+// Same rules as checkEmergency / handleEmergency / optimizeTraffic, but
+// on the CSR arrays and without console output. Neighbour loads are read
+// from `loads` and averaged over the junction's real neighbour count.
+// Returns true when the junction was switched to emergency mode.
+bool optimizeJunction(JunctionNetwork& net, int j, const vector<int>& loads) {
+    Signal* s = &net.signals[net.signalStart[j]];
+    int count = net.signalStart[j + 1] - net.signalStart[j];
+
+    int emergency = -1;
+    for (int i = 0; i < count; i++) {
+        if (s[i].emergency) { emergency = i; break; }
+    }
+    if (emergency != -1) {
+        for (int i = 0; i < count; i++)
+            s[i].greenTime = (i == emergency) ? MAX_GREEN : 0;
+        return true;
+    }
+
+    int first = net.neighborStart[j], last = net.neighborStart[j + 1];
+    int neighborLoad = 0;
+    for (int k = first; k < last; k++)
+        neighborLoad += loads[net.neighborIds[k]];
+
+    int adjustedLoad = net.totalVehicles[j];
+    if (last > first)
+        adjustedLoad += neighborLoad / (last - first);
+
+    for (int i = 0; i < count; i++)
+        s[i].greenTime = computeGreenTime(s[i].vehicles, adjustedLoad);
+    return false;
+}
+
+/* ---------- ONE CYCLE OVER THE NETWORK ---------- */
+int runNetworkCycle(JunctionNetwork& net) {
+    int emergencies = 0;
+    int n = net.size();
+    StageTimer timer(StageQuality, n);
+    for (int j = 0; j < n; j++)
+        emergencies += optimizeJunction(net, j, net.totalVehicles);
+    return emergencies;
+}
+
+/* ---------- DISPLAY NETWORK ---------- */
+void displayNetwork(const JunctionNetwork& net, int limit) {
+    int n = min(net.size(), limit);
+    for (int j = 0; j < n; j++) {
+        cout << "\nJunction " << net.junctionIds[j]
+             << " | Vehicles: " << net.totalVehicles[j]
+             << " | Neighbours: " << net.neighborStart[j + 1] - net.neighborStart[j] << endl;
+        for (int k = net.signalStart[j]; k < net.signalStart[j + 1]; k++) {
+            cout << "  Signal " << net.signals[k].id + 1
+                 << " | Vehicles: " << net.signals[k].vehicles
+                 << " | Green: " << net.signals[k].greenTime << " sec\n";
+        }
+    }
+    if (net.size() > limit)
+        cout << "\n... " << net.size() - limit << " more junctions\n";
+}
+
+/* ---------- NETWORK BENCHMARK ---------- */
+void benchmarkNetwork() {
+    const int sizes[] = {1000, 10000, 100000};
+    const int cycles = 50;
+
+    cout << "bench=network_cycle\n";
+    for (int n : sizes) {
+        JunctionNetwork net;
+        generateNetwork(net, n, 42);
+        runNetworkCycle(net); // warm up
+
+        double best = 1e18, total = 0;
+        for (int c = 0; c < cycles; c++) {
+            chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+            runNetworkCycle(net);
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+            best = min(best, ms);
+            total += ms;
+        }
+        cout << "junctions=" << n
+             << " signals=" << net.signals.size()
+             << " links=" << net.neighborIds.size()
+             << " cycle_ms_avg=" << total / cycles
+             << " cycle_ms_min=" << best
+             << " ns_per_junction=" << (total / cycles) * 1e6 / n << endl;
+    }
+}
+
+/* ---------- PARALLEL CYCLE SCHEDULER ---------- */
+ParallelCycleScheduler::ParallelCycleScheduler(JunctionNetwork& network, int threads)
+    : net(network), threadCount(max(threads, 1)), work(max(threads, 1)), front(0),
+      generation(0), running(0), stopping(false), emergencies(0), stealCount(0) {
+    int n = net.size();
+
+    // About 64 equal-work chunks per thread so stealing has something to take
+    long long totalWork = (long long)net.signals.size() + net.neighborIds.size() + n;
+    long long target = max(1LL, totalWork / ((long long)threadCount * 64));
+    chunkStart.push_back(0);
+    long long acc = 0;
+    for (int j = 0; j < n; j++) {
+        acc += (net.signalStart[j + 1] - net.signalStart[j])
+             + (net.neighborStart[j + 1] - net.neighborStart[j]) + 1;
+        if (acc >= target) {
+            chunkStart.push_back(j + 1);
+            acc = 0;
+        }
+    }
+    if (chunkStart.back() != n)
+        chunkStart.push_back(n);
+
+    int chunks = (int)chunkStart.size() - 1;
+    ownerStart.resize(threadCount + 1);
+    for (int t = 0; t <= threadCount; t++)
+        ownerStart[t] = (int)((long long)chunks * t / threadCount);
+
+    loads[0] = net.totalVehicles;
+    loads[1] = net.totalVehicles;
+
+    for (int t = 1; t < threadCount; t++)
+        workers.push_back(thread(&ParallelCycleScheduler::workerLoop, this, t));
+}
+
+ParallelCycleScheduler::~ParallelCycleScheduler() {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    startCv.notify_all();
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+}
+
+int ParallelCycleScheduler::runCycle() {
+    StageTimer timer(StageQuality, net.size());
+    for (int t = 0; t < threadCount; t++)
+        work[t].range.store(((uint64_t)ownerStart[t] << 32) | (uint32_t)ownerStart[t + 1]);
+    emergencies.store(0);
+
+    {
+        lock_guard<mutex> guard(lock);
+        running = threadCount - 1;
+        generation++;
+    }
+    startCv.notify_all();
+
+    runShare(0); // calling thread is worker 0
+
+    {
+        unique_lock<mutex> guard(lock);
+        doneCv.wait(guard, [this]{ return running == 0; });
+    }
+
+    // Loads written this cycle become the ones neighbours read next cycle
+    front ^= 1;
+    return emergencies.load();
+}
+
+void ParallelCycleScheduler::workerLoop(int t) {
+    long long seen = 0;
+    for (;;) {
+        {
+            unique_lock<mutex> guard(lock);
+            startCv.wait(guard, [&]{ return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        runShare(t);
+        {
+            lock_guard<mutex> guard(lock);
+            running--;
+        }
+        doneCv.notify_one();
+    }
+}
+
+void ParallelCycleScheduler::runShare(int t) {
+    int chunk;
+    while (popOwn(t, chunk))
+        processChunk(chunk);
+
+    for (int k = 1; k < threadCount; k++) {
+        int victim = (t + k) % threadCount;
+        while (stealFrom(victim, chunk)) {
+            stealCount.fetch_add(1, memory_order_relaxed);
+            processChunk(chunk);
+        }
+    }
+}
+
+bool ParallelCycleScheduler::popOwn(int t, int& chunk) {
+    uint64_t cur = work[t].range.load();
+    for (;;) {
+        uint32_t head = (uint32_t)(cur >> 32), tail = (uint32_t)cur;
+        if (head >= tail) return false;
+        uint64_t next = ((uint64_t)(head + 1) << 32) | tail;
+        if (work[t].range.compare_exchange_weak(cur, next)) {
+            chunk = (int)head;
+            return true;
+        }
+    }
+}
+
+bool ParallelCycleScheduler::stealFrom(int victim, int& chunk) {
+    uint64_t cur = work[victim].range.load();
+    for (;;) {
+        uint32_t head = (uint32_t)(cur >> 32), tail = (uint32_t)cur;
+        if (head >= tail) return false;
+        uint64_t next = ((uint64_t)head << 32) | (tail - 1);
+        if (work[victim].range.compare_exchange_weak(cur, next)) {
+            chunk = (int)tail - 1;
+            return true;
+        }
+    }
+}
+
+void ParallelCycleScheduler::processChunk(int chunk) {
+    const vector<int>& readLoads = loads[front];
+    vector<int>& writeLoads = loads[front ^ 1];
+    int local = 0;
+
+    for (int j = chunkStart[chunk]; j < chunkStart[chunk + 1]; j++) {
+        // Refresh own load from the latest counts and publish it for next cycle
+        int total = 0;
+        for (int k = net.signalStart[j]; k < net.signalStart[j + 1]; k++)
+            total += net.signals[k].vehicles;
+        net.totalVehicles[j] = total;
+        writeLoads[j] = total;
+
+        local += optimizeJunction(net, j, readLoads);
+    }
+    if (local)
+        emergencies.fetch_add(local, memory_order_relaxed);
+}
+
+/* ---------- PARALLEL CYCLE BENCHMARK ---------- */
+void benchmarkParallelCycle(int maxThreads) {
+    const int sizes[] = {10000, 100000};
+    const int cycles = 50;
+
+    cout << "bench=parallel_cycle\n";
+    for (int n : sizes) {
+        JunctionNetwork net;
+        generateNetwork(net, n, 42);
+
+        vector<int> threadCounts;
+        for (int t = 1; t < maxThreads; t *= 2)
+            threadCounts.push_back(t);
+        threadCounts.push_back(maxThreads);
+
+        double baseline = 0;
+        for (size_t i = 0; i < threadCounts.size(); i++) {
+            int threads = threadCounts[i];
+            ParallelCycleScheduler scheduler(net, threads);
+            scheduler.runCycle(); // warm up
+
+            vector<double> latency;
+            for (int c = 0; c < cycles; c++) {
+                chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+                scheduler.runCycle();
+                latency.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count());
+            }
+            sort(latency.begin(), latency.end());
+            double avg = 0;
+            for (size_t k = 0; k < latency.size(); k++) avg += latency[k];
+            avg /= latency.size();
+            if (threads == 1) baseline = avg;
+
+            cout << "junctions=" << n
+                 << " threads=" << threads
+                 << " cycle_ms_avg=" << avg
+                 << " cycle_ms_p50=" << latency[latency.size() / 2]
+                 << " cycle_ms_p99=" << latency[latency.size() * 99 / 100]
+                 << " speedup=" << baseline / avg
+                 << " steals=" << scheduler.steals() << endl;
+        }
+    }
+}
+
+/* ---------- LOAD ROAD GRAPH ---------- */
+// nodes file: junction_id,x,y                      (metres)
+// roads file: from_id,to_id,travel_time,signal_id  (seconds, 1-based signal at to_id)
+void loadRoadCSV(const string& nodeFile, const string& linkFile, RoadGraph& g) {
+    StageTimer timer(StageParse);
+    unordered_map<int,int> dense;
+    CSVRow row;
+    g.nodeIds.clear(); g.x.clear(); g.y.clear();
+
+    MappedCSV nfile(nodeFile);
+    if (!nfile.isOpen()) {
+        cerr << "Error opening file: " << nodeFile << endl;
+        exit(1);
+    }
+    nfile.skipLine(); // skip header
+    while (nfile.nextRow(row)) {
+        int id = row.toInt(0);
+        dense[id] = (int)g.nodeIds.size();
+        g.nodeIds.push_back(id);
+        g.x.push_back(row.toDouble(1));
+        g.y.push_back(row.toDouble(2));
+    }
+
+    vector<int> from, to, signal;
+    vector<float> time;
+    MappedCSV lfile(linkFile);
+    if (!lfile.isOpen()) {
+        cerr << "Error opening file: " << linkFile << endl;
+        exit(1);
+    }
+    lfile.skipLine(); // skip header
+    while (lfile.nextRow(row)) {
+        int a = row.toInt(0);
+        int b = row.toInt(1);
+        float t = row.toFloat(2);
+        if (!dense.count(a) || !dense.count(b) || t <= 0) {
+            cerr << "Skipping road " << a << " -> " << b << endl;
+            continue;
+        }
+        from.push_back(dense[a]);
+        to.push_back(dense[b]);
+        time.push_back(t);
+        signal.push_back(row.toInt(3) - 1);
+    }
+    buildRoadGraph(g, from, to, time, signal);
+    buildLandmarks(g, 16);
+}
+
+/* ---------- BUILD CSR ROAD GRAPH ---------- */
+void buildRoadGraph(RoadGraph& g, vector<int>& from, vector<int>& to,
+                    vector<float>& time, vector<int>& signal) {
+    int n = g.size();
+    size_t m = from.size();
+
+    g.edgeStart.assign(n + 1, 0);
+    for (size_t e = 0; e < m; e++)
+        g.edgeStart[from[e] + 1]++;
+    for (int v = 0; v < n; v++)
+        g.edgeStart[v + 1] += g.edgeStart[v];
+
+    g.edgeTo.resize(m);
+    g.edgeTime.resize(m);
+    g.edgeSignal.resize(m);
+    g.maxSpeed = 0;
+    g.landmarks = 0;
+    g.landmarkTimes.clear();
+    vector<int> fill(g.edgeStart.begin(), g.edgeStart.end() - 1);
+    for (size_t e = 0; e < m; e++) {
+        int k = fill[from[e]]++;
+        g.edgeTo[k] = to[e];
+        g.edgeTime[k] = time[e];
+        g.edgeSignal[k] = signal[e];
+
+        double len = hypot(g.x[from[e]] - g.x[to[e]], g.y[from[e]] - g.y[to[e]]);
+        g.maxSpeed = max(g.maxSpeed, len / time[e]);
+    }
+}
+
+/* ---------- SYNTHETIC ROAD GRAPH ---------- */
+// Square grid, 200 m blocks, two-way roads at 8-17 m/s. Each junction
+// has four approach signals: 0 from west, 1 from east, 2 from north,
+// 3 from south.
+void generateRoadGraph(RoadGraph& g, int nodes, unsigned seed) {
+    mt19937 rng(seed);
+    uniform_real_distribution<float> speed(8.0f, 17.0f);
+    const double block = 200.0;
+
+    int side = 1;
+    while (side * side < nodes) side++;
+
+    g.nodeIds.resize(nodes);
+    g.x.resize(nodes);
+    g.y.resize(nodes);
+    for (int v = 0; v < nodes; v++) {
+        g.nodeIds[v] = v;
+        g.x[v] = (v % side) * block;
+        g.y[v] = (v / side) * block;
+    }
+
+    vector<int> from, to, signal;
+    vector<float> time;
+    for (int v = 0; v < nodes; v++) {
+        if (v % side + 1 < side && v + 1 < nodes) {
+            float t = (float)(block / speed(rng));
+            from.push_back(v);     to.push_back(v + 1); time.push_back(t); signal.push_back(0);
+            from.push_back(v + 1); to.push_back(v);     time.push_back(t); signal.push_back(1);
+        }
+        if (v + side < nodes) {
+            float t = (float)(block / speed(rng));
+            from.push_back(v);        to.push_back(v + side); time.push_back(t); signal.push_back(2);
+            from.push_back(v + side); to.push_back(v);        time.push_back(t); signal.push_back(3);
+        }
+    }
+    buildRoadGraph(g, from, to, time, signal);
+}
+
+/* ---------- ALT LANDMARKS ---------- */
+// Picks `count` landmarks by farthest-first selection and stores travel
+// times from and to each of them. Unreachable pairs keep 1e30 and are
+// ignored by the heuristic.
+void buildLandmarks(RoadGraph& g, int count) {
+    int n = g.size();
+    g.landmarks = 0;
+    g.landmarkTimes.clear();
+    if (n == 0 || count <= 0) return;
+
+    // Reverse graph for the "to landmark" searches
+    vector<int> revStart(n + 1, 0), revTo(g.edgeTo.size());
+    vector<float> revTime(g.edgeTo.size());
+    for (size_t e = 0; e < g.edgeTo.size(); e++)
+        revStart[g.edgeTo[e] + 1]++;
+    for (int v = 0; v < n; v++)
+        revStart[v + 1] += revStart[v];
+    vector<int> fill(revStart.begin(), revStart.end() - 1);
+    for (int u = 0; u < n; u++) {
+        for (int e = g.edgeStart[u]; e < g.edgeStart[u + 1]; e++) {
+            int k = fill[g.edgeTo[e]]++;
+            revTo[k] = u;
+            revTime[k] = g.edgeTime[e];
+        }
+    }
+
+    auto sssp = [n](const vector<int>& start, const vector<int>& to, const vector<float>& w,
+                    int src, vector<float>& dist) {
+        dist.assign(n, 1e30f);
+        priority_queue<pair<float,int>, vector<pair<float,int> >, greater<pair<float,int> > > pq;
+        dist[src] = 0;
+        pq.push(make_pair(0.0f, src));
+        while (!pq.empty()) {
+            pair<float,int> top = pq.top(); pq.pop();
+            int u = top.second;
+            if (top.first > dist[u]) continue;
+            for (int e = start[u]; e < start[u + 1]; e++) {
+                if (dist[u] + w[e] < dist[to[e]]) {
+                    dist[to[e]] = dist[u] + w[e];
+                    pq.push(make_pair(dist[to[e]], to[e]));
+                }
+            }
+        }
+    };
+
+    count = min(count, n);
+    g.landmarks = count;
+    g.landmarkTimes.assign((size_t)n * count * 2, 1e30f);
+
+    vector<float> from, to, nearest(n, 1e30f);
+    int landmark = 0;
+    for (int k = 0; k < count; k++) {
+        if (k == 0) {
+            // Start from the node farthest from node 0
+            sssp(g.edgeStart, g.edgeTo, g.edgeTime, 0, from);
+            for (int v = 0; v < n; v++)
+                if (from[v] < 1e30f && from[v] > from[landmark]) landmark = v;
+        }
+        sssp(g.edgeStart, g.edgeTo, g.edgeTime, landmark, from);
+        sssp(revStart, revTo, revTime, landmark, to);
+
+        int farthest = landmark;
+        for (int v = 0; v < n; v++) {
+            g.landmarkTimes[((size_t)v * count + k) * 2] = from[v];
+            g.landmarkTimes[((size_t)v * count + k) * 2 + 1] = to[v];
+            if (from[v] < nearest[v]) nearest[v] = from[v];
+            if (nearest[v] < 1e30f && nearest[v] > nearest[farthest]) farthest = v;
+        }
+        landmark = farthest;
+    }
+}
+
+/* ---------- CORRIDOR PLANNER (A*) ---------- */
+CorridorPlanner::CorridorPlanner(const RoadGraph& graph)
+    : g(graph), state(graph.size()), currentStamp(0), settled(0), target(0) {
+    for (size_t v = 0; v < state.size(); v++)
+        state[v].stamp = 0;
+}
+
+float CorridorPlanner::heuristic(int v) const {
+    float h = 0;
+    if (g.maxSpeed > 0) {
+        double dx = g.x[v] - g.x[target], dy = g.y[v] - g.y[target];
+        h = (float)(sqrt(dx * dx + dy * dy) / g.maxSpeed);
+    }
+
+    const float* times = g.landmarks ? &g.landmarkTimes[(size_t)v * g.landmarks * 2] : 0;
+    for (int k = 0; k < g.landmarks; k++) {
+        float from = times[2 * k], to = times[2 * k + 1];
+        // d(v,t) >= d(L,t) - d(L,v)  and  d(v,t) >= d(v,L) - d(t,L)
+        if (from < 1e30f && targetFrom[k] < 1e30f)
+            h = max(h, targetFrom[k] - from);
+        if (to < 1e30f && targetTo[k] < 1e30f)
+            h = max(h, to - targetTo[k]);
+    }
+    return h;
+}
+
+CorridorPlanner::NodeState& CorridorPlanner::touch(int v) {
+    NodeState& s = state[v];
+    if (s.stamp != currentStamp) {
+        s.stamp = currentStamp;
+        s.dist = 1e30f;
+        s.parentEdge = -1;
+        s.closed = false;
+    }
+    return s;
+}
+
+Corridor CorridorPlanner::plan(const EmergencyRequest& r) {
+    StageTimer timer(StageSearch, 1);
+    Corridor c;
+    c.vehicle = r.vehicle;
+    c.reachable = false;
+    c.travelTime = 0;
+
+    if (++currentStamp == 0) { // stamp wrapped, clear everything once
+        for (size_t v = 0; v < state.size(); v++)
+            state[v].stamp = 0;
+        currentStamp = 1;
+    }
+    target = r.target;
+    targetFrom.assign(g.landmarks, 0);
+    targetTo.assign(g.landmarks, 0);
+    for (int k = 0; k < g.landmarks; k++) {
+        targetFrom[k] = g.landmarkTimes[((size_t)target * g.landmarks + k) * 2];
+        targetTo[k] = g.landmarkTimes[((size_t)target * g.landmarks + k) * 2 + 1];
+    }
+
+    greater<pair<float,int> > cmp;
+    heap.clear();
+    settled = 0;
+
+    touch(r.source).dist = 0;
+    heap.push_back(make_pair(heuristic(r.source), r.source));
+
+    while (!heap.empty()) {
+        pop_heap(heap.begin(), heap.end(), cmp);
+        int u = heap.back().second;
+        heap.pop_back();
+        NodeState& su = state[u];
+        if (su.closed) continue;
+        su.closed = true;
+        settled++;
+        if (u == target) break;
+
+        for (int e = g.edgeStart[u]; e < g.edgeStart[u + 1]; e++) {
+            int v = g.edgeTo[e];
+            NodeState& sv = touch(v);
+            float nd = su.dist + g.edgeTime[e];
+            if (!sv.closed && nd < sv.dist) {
+                sv.dist = nd;
+                sv.parentEdge = e;
+                heap.push_back(make_pair(nd + heuristic(v), v));
+                push_heap(heap.begin(), heap.end(), cmp);
+            }
+        }
+    }
+
+    NodeState& st = touch(target);
+    if (target != r.source && st.parentEdge == -1)
+        return c;
+
+    // Walk parents back from the target, then reverse into driving order
+    for (int v = target; v != r.source; ) {
+        int e = state[v].parentEdge;
+        CorridorStep step;
+        step.junction = v;
+        step.signal = g.edgeSignal[e];
+        step.arrival = state[v].dist;
+        c.steps.push_back(step);
+        v = (int)(upper_bound(g.edgeStart.begin(), g.edgeStart.end(), e) - g.edgeStart.begin()) - 1;
+    }
+    CorridorStep start;
+    start.junction = r.source;
+    start.signal = -1;
+    start.arrival = 0;
+    c.steps.push_back(start);
+    reverse(c.steps.begin(), c.steps.end());
+
+    c.reachable = true;
+    c.travelTime = st.dist;
+    return c;
+}
+
+/* ---------- PLAN ALL ACTIVE EMERGENCIES ---------- */
+vector<Corridor> planCorridors(const RoadGraph& g, const vector<EmergencyRequest>& requests, int threads) {
+    vector<Corridor> result(requests.size());
+    threads = max(1, min(threads, (int)requests.size()));
+
+    atomic<size_t> next(0);
+    auto worker = [&]() {
+        CorridorPlanner planner(g);
+        for (size_t i = next++; i < requests.size(); i = next++)
+            result[i] = planner.plan(requests[i]);
+    };
+
+    vector<thread> pool;
+    for (int t = 1; t < threads; t++)
+        pool.push_back(thread(worker));
+    worker();
+    for (size_t t = 0; t < pool.size(); t++)
+        pool[t].join();
+    return result;
+}
+
+/* ---------- PREEMPT SIGNALS ALONG CORRIDORS ---------- */
+// Holds the approach signal of every corridor junction green. Claims are
+// granted in arrival order; when a later vehicle needs a different
+// approach at an already claimed junction it is counted as a conflict
+// and the earlier vehicle keeps the junction.
+int applyPreemption(JunctionNetwork& net, const RoadGraph& g, const vector<Corridor>& corridors) {
+    unordered_map<int,int> dense;
+    for (int j = 0; j < net.size(); j++)
+        dense[net.junctionIds[j]] = j;
+
+    vector<CorridorStep> claims;
+    for (size_t i = 0; i < corridors.size(); i++)
+        for (size_t k = 0; k < corridors[i].steps.size(); k++)
+            if (corridors[i].steps[k].signal >= 0)
+                claims.push_back(corridors[i].steps[k]);
+    stable_sort(claims.begin(), claims.end(),
+                [](const CorridorStep& a, const CorridorStep& b){ return a.arrival < b.arrival; });
+
+    unordered_map<int,int> owner;   // network junction -> preempted signal
+    int conflicts = 0;
+    for (size_t k = 0; k < claims.size(); k++) {
+        unordered_map<int,int>::iterator it = dense.find(g.nodeIds[claims[k].junction]);
+        if (it == dense.end()) continue;
+        int j = it->second;
+        int first = net.signalStart[j], count = net.signalStart[j + 1] - first;
+        if (claims[k].signal >= count) continue;
+
+        unordered_map<int,int>::iterator held = owner.find(j);
+        if (held != owner.end()) {
+            if (held->second != claims[k].signal) conflicts++;
+            continue;
+        }
+        owner[j] = claims[k].signal;
+        for (int s = 0; s < count; s++)
+            net.signals[first + s].greenTime = (s == claims[k].signal) ? MAX_GREEN : 0;
+    }
+    return conflicts;
+}
+
+/* ---------- DISPLAY CORRIDOR ---------- */
+void displayCorridor(const RoadGraph& g, const Corridor& c) {
+    cout << "\n🚑 Vehicle " << c.vehicle;
+    if (!c.reachable) {
+        cout << ": no route to destination\n";
+        return;
+    }
+    cout << " | Travel time: " << c.travelTime << " sec\n";
+    for (size_t k = 0; k < c.steps.size(); k++) {
+        cout << "  Junction " << g.nodeIds[c.steps[k].junction];
+        if (c.steps[k].signal >= 0)
+            cout << " | Preempt Signal " << c.steps[k].signal + 1
+                 << " | ETA " << c.steps[k].arrival << " sec";
+        else
+            cout << " | Start";
+        cout << endl;
+    }
+}
+
+/* ---------- CORRIDOR BENCHMARK ---------- */
+void benchmarkCorridors() {
+    const int nodes = 100000;
+    const int requests = 2000;
+
+    RoadGraph g;
+    generateRoadGraph(g, nodes, 7);
+    chrono::steady_clock::time_point p0 = chrono::steady_clock::now();
+    buildLandmarks(g, 16);
+    double prepMs = chrono::duration<double, milli>(chrono::steady_clock::now() - p0).count();
+    int side = 1;
+    while (side * side < nodes) side++;
+
+    mt19937 rng(11);
+    uniform_int_distribution<int> anyNode(0, nodes - 1);
+    uniform_int_distribution<int> offset(-15, 15); // within ~3 km
+
+    cout << "bench=corridor nodes=" << nodes << " edges=" << g.edgeTo.size()
+         << " landmarks=" << g.landmarks << " landmark_prep_ms=" << prepMs << endl;
+    for (int local = 1; local >= 0; local--) {
+        vector<EmergencyRequest> reqs;
+        for (int i = 0; i < requests; i++) {
+            EmergencyRequest r;
+            r.vehicle = i;
+            r.source = anyNode(rng);
+            if (local) {
+                int row = min(max(r.source / side + offset(rng), 0), side - 1);
+                int col = min(max(r.source % side + offset(rng), 0), side - 1);
+                r.target = min(row * side + col, nodes - 1);
+            } else {
+                r.target = anyNode(rng);
+            }
+            reqs.push_back(r);
+        }
+
+        CorridorPlanner planner(g);
+        vector<double> latency;
+        long long settled = 0, steps = 0;
+        for (size_t i = 0; i < reqs.size(); i++) {
+            chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+            Corridor c = planner.plan(reqs[i]);
+            latency.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - t0).count());
+            settled += planner.lastSettled();
+            steps += c.steps.size();
+        }
+        sort(latency.begin(), latency.end());
+        double avg = 0;
+        for (size_t i = 0; i < latency.size(); i++) avg += latency[i];
+        avg /= latency.size();
+
+        cout << "trips=" << (local ? "local_3km" : "city_wide")
+             << " requests=" << requests
+             << " us_avg=" << avg
+             << " us_p50=" << latency[latency.size() / 2]
+             << " us_p99=" << latency[latency.size() * 99 / 100]
+             << " settled_avg=" << settled / requests
+             << " corridor_len_avg=" << steps / requests << endl;
+    }
+}
+
+/* ---------- DYNAMIC CORRIDOR TREE ---------- */
+DynamicCorridorTree::DynamicCorridorTree(const RoadGraph& graph, int r)
+    : g(graph), root(r) {
+    int n = g.size();
+    size_t m = g.edgeTo.size();
+
+    edgeFrom.resize(m);
+    for (int u = 0; u < n; u++)
+        for (int e = g.edgeStart[u]; e < g.edgeStart[u + 1]; e++)
+            edgeFrom[e] = u;
+
+    inStart.assign(n + 1, 0);
+    for (size_t e = 0; e < m; e++)
+        inStart[g.edgeTo[e] + 1]++;
+    for (int v = 0; v < n; v++)
+        inStart[v + 1] += inStart[v];
+    inEdge.resize(m);
+    vector<int> fill(inStart.begin(), inStart.end() - 1);
+    for (size_t e = 0; e < m; e++)
+        inEdge[fill[g.edgeTo[e]]++] = (int)e;
+
+    baseTime.assign(g.edgeTime.begin(), g.edgeTime.end());
+    weight = baseTime;
+    edgeBlocked.assign(m, 0);
+    nodeBlocked.assign(n, 0);
+    isPending.assign(m, 0);
+    affected.assign(n, 0);
+    recompute();
+}
+
+float DynamicCorridorTree::effectiveWeight(int e) const {
+    if (edgeBlocked[e] || nodeBlocked[edgeFrom[e]] || nodeBlocked[g.edgeTo[e]])
+        return 1e30f;
+    return baseTime[e];
+}
+
+void DynamicCorridorTree::markChanged(int e) {
+    if (!isPending[e]) {
+        isPending[e] = 1;
+        pending.push_back(e);
+    }
+}
+
+void DynamicCorridorTree::setEdgeTime(int e, float time) {
+    baseTime[e] = time;
+    markChanged(e);
+}
+
+void DynamicCorridorTree::setEdgeBlocked(int e, bool blocked) {
+    edgeBlocked[e] = blocked;
+    markChanged(e);
+}
+
+void DynamicCorridorTree::setNodeBlocked(int v, bool blocked) {
+    nodeBlocked[v] = blocked;
+    for (int e = g.edgeStart[v]; e < g.edgeStart[v + 1]; e++)
+        markChanged(e);
+    for (int k = inStart[v]; k < inStart[v + 1]; k++)
+        markChanged(inEdge[k]);
+}
+
+void DynamicCorridorTree::recompute() {
+    for (size_t i = 0; i < pending.size(); i++) {
+        weight[pending[i]] = effectiveWeight(pending[i]);
+        isPending[pending[i]] = 0;
+    }
+    pending.clear();
+
+    dist.assign(g.size(), 1e30f);
+    nextEdge.assign(g.size(), -1);
+    if (!nodeBlocked[root]) {
+        dist[root] = 0;
+        pq.push(make_pair(0.0f, root));
+    }
+    settle();
+}
+
+// Dijkstra over in-edges: a settled node x offers dist[x] + w to every
+// node y with an edge y -> x.
+int DynamicCorridorTree::settle() {
+    int count = 0;
+    while (!pq.empty()) {
+        pair<float,int> top = pq.top(); pq.pop();
+        int x = top.second;
+        if (top.first > dist[x]) continue;
+        count++;
+        for (int k = inStart[x]; k < inStart[x + 1]; k++) {
+            int e = inEdge[k];
+            int y = edgeFrom[e];
+            float nd = dist[x] + weight[e];
+            if (nd < dist[y]) {
+                dist[y] = nd;
+                nextEdge[y] = e;
+                pq.push(make_pair(nd, y));
+            }
+        }
+    }
+    return count;
+}
+
+int DynamicCorridorTree::update() {
+    StageTimer timer(StageSearch, pending.size(), true);
+    vector<int> decreased, roots;
+    for (size_t i = 0; i < pending.size(); i++) {
+        int e = pending[i];
+        isPending[e] = 0;
+        float w = effectiveWeight(e);
+        if (w > weight[e]) {
+            weight[e] = w;
+            if (nextEdge[edgeFrom[e]] == e)
+                roots.push_back(edgeFrom[e]);   // tree edge got slower
+        } else if (w < weight[e]) {
+            weight[e] = w;
+            decreased.push_back(e);
+        }
+    }
+    pending.clear();
+
+    // Invalidate every node whose tree path used a slower edge
+    vector<int> lost;
+    for (size_t i = 0; i < roots.size(); i++) {
+        if (affected[roots[i]]) continue;
+        affected[roots[i]] = 1;
+        lost.push_back(roots[i]);
+    }
+    for (size_t i = 0; i < lost.size(); i++) {
+        int x = lost[i];
+        for (int k = inStart[x]; k < inStart[x + 1]; k++) {
+            int y = edgeFrom[inEdge[k]];
+            if (nextEdge[y] == inEdge[k] && !affected[y]) {
+                affected[y] = 1;
+                lost.push_back(y);
+            }
+        }
+    }
+
+    // A repair that re-settles a large part of the tree costs more than
+    // starting over (weights are already current)
+    if (lost.size() > (size_t)g.size() / 4) {
+        for (size_t i = 0; i < lost.size(); i++)
+            affected[lost[i]] = 0;
+        recompute();
+        return g.size();
+    }
+
+    for (size_t i = 0; i < lost.size(); i++) {
+        dist[lost[i]] = 1e30f;
+        nextEdge[lost[i]] = -1;
+    }
+
+    // Re-attach lost nodes through their best neighbour outside the subtree
+    for (size_t i = 0; i < lost.size(); i++) {
+        int y = lost[i];
+        for (int e = g.edgeStart[y]; e < g.edgeStart[y + 1]; e++) {
+            int x = g.edgeTo[e];
+            if (affected[x] || dist[x] >= 1e30f) continue;
+            if (dist[x] + weight[e] < dist[y]) {
+                dist[y] = dist[x] + weight[e];
+                nextEdge[y] = e;
+            }
+        }
+        if (dist[y] < 1e30f)
+            pq.push(make_pair(dist[y], y));
+    }
+    for (size_t i = 0; i < lost.size(); i++)
+        affected[lost[i]] = 0;
+
+    // Faster edges that now beat the current distance
+    for (size_t i = 0; i < decreased.size(); i++) {
+        int e = decreased[i];
+        int y = edgeFrom[e], x = g.edgeTo[e];
+        if (dist[x] < 1e30f && dist[x] + weight[e] < dist[y]) {
+            dist[y] = dist[x] + weight[e];
+            nextEdge[y] = e;
+            pq.push(make_pair(dist[y], y));
+        }
+    }
+    return settle();
+}
+
+Corridor DynamicCorridorTree::corridorFrom(int vehicle, int source) const {
+    Corridor c;
+    c.vehicle = vehicle;
+    c.reachable = dist[source] < 1e30f;
+    c.travelTime = c.reachable ? dist[source] : 0;
+    if (!c.reachable) return c;
+
+    CorridorStep step;
+    step.junction = source;
+    step.signal = -1;
+    step.arrival = 0;
+    c.steps.push_back(step);
+    for (int v = source; v != root; ) {
+        int e = nextEdge[v];
+        v = g.edgeTo[e];
+        step.junction = v;
+        step.signal = g.edgeSignal[e];
+        step.arrival = dist[source] - dist[v];
+        c.steps.push_back(step);
+    }
+    return c;
+}
+
+/* ---------- DYNAMIC CORRIDOR BENCHMARK ---------- */
+// Each tick re-times a share of the roads by up to +/-30% of their free-
+// flow time and toggles a few blocks, then compares the repair against a
+// full recomputation (which also checks the repaired distances).
+void benchmarkDynamicCorridor() {
+    const int nodes = 100000;
+    const int ticks = 20;
+    const double churnRates[] = {0.0001, 0.001, 0.01, 0.05};
+
+    RoadGraph g;
+    generateRoadGraph(g, nodes, 7);
+    int m = (int)g.edgeTo.size();
+
+    cout << "bench=dynamic_corridor nodes=" << nodes << " edges=" << m << endl;
+    for (double rate : churnRates) {
+        DynamicCorridorTree tree(g, nodes / 2);
+        DynamicCorridorTree check(g, nodes / 2);
+        mt19937 rng(5);
+        uniform_int_distribution<int> anyEdge(0, m - 1);
+        uniform_real_distribution<float> jitter(0.7f, 1.3f);
+        uniform_int_distribution<int> blockRoll(0, 99);
+        int changes = max(1, (int)(m * rate));
+
+        double updateMs = 0, fullMs = 0;
+        long long resettled = 0;
+        int mismatches = 0;
+        for (int t = 0; t < ticks; t++) {
+            for (int c = 0; c < changes; c++) {
+                int e = anyEdge(rng);
+                if (blockRoll(rng) == 0) {
+                    bool b = blockRoll(rng) < 50;
+                    tree.setEdgeBlocked(e, b);
+                    check.setEdgeBlocked(e, b);
+                } else {
+                    float time = g.edgeTime[e] * jitter(rng);
+                    tree.setEdgeTime(e, time);
+                    check.setEdgeTime(e, time);
+                }
+            }
+
+            chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+            resettled += tree.update();
+            chrono::steady_clock::time_point t1 = chrono::steady_clock::now();
+            check.recompute();
+            chrono::steady_clock::time_point t2 = chrono::steady_clock::now();
+            updateMs += chrono::duration<double, milli>(t1 - t0).count();
+            fullMs += chrono::duration<double, milli>(t2 - t1).count();
+
+            for (int v = 0; v < nodes; v++) {
+                float a = tree.timeToRoot(v), b = check.timeToRoot(v);
+                if (fabs(a - b) > 1e-3f * max(1.0f, b)) mismatches++;
+            }
+        }
+        cout << "churn_per_tick=" << rate * 100 << "%"
+             << " changes=" << changes
+             << " update_ms=" << updateMs / ticks
+             << " recompute_ms=" << fullMs / ticks
+             << " speedup=" << fullMs / max(updateMs, 1e-9)
+             << " resettled_avg=" << resettled / ticks
+             << " mismatches=" << mismatches << endl;
+    }
+}
+
+/* ---------- LOAD RECORDED COUNTS ---------- */
+// interval,junction_id,signal,vehicles - signal is the 1-based position
+// inside the junction (as printed by displayNetwork). Missing rows are
+// zero counts; rows naming unknown junctions or signals are skipped.
+void loadRecordingCSV(const string& filename, const JunctionNetwork& net,
+                      int intervalSeconds, TrafficRecording& rec) {
+    StageTimer timer(StageParse);
+    unordered_map<int,int> dense;
+    for (int j = 0; j < net.size(); j++)
+        dense[net.junctionIds[j]] = j;
+
+    MappedCSV file(filename);
+    if (!file.isOpen()) {
+        cerr << "Error opening file: " << filename << endl;
+        exit(1);
+    }
+    vector<pair<int,int> > counts;      // (interval, network signal) -> vehicles
+    vector<int> vehicles;
+    int skipped = 0;
+    CSVRow row;
+    file.skipLine(); // skip header
+    while (file.nextRow(row)) {
+        int t = row.toInt(0);
+        unordered_map<int,int>::const_iterator j = dense.find(row.toInt(1));
+        int k = row.toInt(2) - 1;
+        if (t < 0 || j == dense.end() || k < 0 ||
+            k >= net.signalStart[j->second + 1] - net.signalStart[j->second]) {
+            skipped++;
+            continue;
+        }
+        counts.push_back(make_pair(t, net.signalStart[j->second] + k));
+        vehicles.push_back(row.toInt(3));
+    }
+    timer.addItems(counts.size());
+    if (skipped)
+        cerr << "Warning: skipped " << skipped << " rows for unknown signals\n";
+
+    int S = (int)net.signals.size();
+    rec.intervalSeconds = max(intervalSeconds, 1);
+    rec.intervals = 0;
+    for (size_t i = 0; i < counts.size(); i++)
+        rec.intervals = max(rec.intervals, counts[i].first + 1);
+    rec.arrivals.assign((size_t)rec.intervals * S, 0);
+    for (size_t i = 0; i < counts.size(); i++)
+        rec.arrivals[(size_t)counts[i].first * S + counts[i].second] =
+            (unsigned short)min(max(vehicles[i], 0), 65535);
+}
+
+/* ---------- SYNTHETIC CITY-DAY ---------- */
+// Counts around a two-peak daily profile (09:00 and 18:00) with Poisson-
+// sized noise (normal approximation, mean + sqrt(mean) * N(0,1)).
+// Each junction gets a peak demand of 50-95% of its capacity, split over
+// its approaches in proportion to the snapshot vehicle counts, so some
+// approaches are much busier than others.
+void generateRecording(const JunctionNetwork& net, int intervals, int intervalSeconds,
+                       unsigned seed, TrafficRecording& rec) {
+    mt19937 rng(seed);
+    uniform_real_distribution<double> peakLoad(0.5, 0.95);
+    normal_distribution<float> noise(0.0f, 1.0f);
+    int S = (int)net.signals.size();
+
+    // Mean vehicles per second at each signal at the daily peak
+    vector<double> peakRate(S);
+    for (int j = 0; j < net.size(); j++) {
+        int first = net.signalStart[j], last = net.signalStart[j + 1];
+        double weight = 0;
+        for (int k = first; k < last; k++)
+            weight += net.signals[k].vehicles + 5;
+        // Approaches are served one after another, so the junction moves
+        // SATURATION_FLOW vehicles per second of green in total
+        double capacity = SATURATION_FLOW * MAX_GREEN / (MAX_GREEN + (last - first) * LOST_TIME);
+        double load = peakLoad(rng);
+        for (int k = first; k < last; k++)
+            peakRate[k] = load * capacity * (net.signals[k].vehicles + 5) / weight;
+    }
+
+    rec.intervals = intervals;
+    rec.intervalSeconds = intervalSeconds;
+    rec.arrivals.resize((size_t)intervals * S);
+    for (int t = 0; t < intervals; t++) {
+        double hour = (t + 0.5) * intervalSeconds / 3600.0;
+        double profile = 0.15 + 0.85 * exp(-(hour - 9) * (hour - 9) / 2)
+                              + 0.9 * exp(-(hour - 18) * (hour - 18) / 3);
+        unsigned short* a = &rec.arrivals[(size_t)t * S];
+        for (int k = 0; k < S; k++) {
+            float mean = (float)(peakRate[k] * profile * intervalSeconds);
+            float count = mean + sqrt(mean) * noise(rng) + 0.5f;
+            a[k] = (unsigned short)min(max(count, 0.0f), 65535.0f);
+        }
+    }
+}
+
+const char* policyName(ReplayPolicy policy) {
+    switch (policy) {
+    case PolicyFixed:        return "fixed";
+    case PolicyJunction:     return "junction";
+    case PolicyNetwork:      return "network";
+    case PolicyLongestQueue: return "longest-queue";
+    default:                 return "?";
+    }
+}
+
+/* ---------- REPLAY ONE SCENARIO ---------- */
+// Interval by interval: the detectors report what is still queued plus
+// what was counted over the previous interval, the policy turns that into
+// green times, and the interval's arrivals are discharged under those
+// greens. The plan repeats for the whole interval, so approach k gets
+// green for g_k / C of it, C = sum of greens + LOST_TIME per phase.
+// Delay per approach is Webster's uniform term for vehicles served within
+// the cycle plus the area under the overflow queue carried between
+// intervals (fluid model). Average queue follows by Little's law.
+ReplayResult replayScenario(const JunctionNetwork& net, const TrafficRecording& rec,
+                            const ReplayScenario& scenario) {
+    chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+
+    JunctionNetwork plan = net;         // private copy: signals / totals are rewritten
+    int n = plan.size();
+    int S = (int)plan.signals.size();
+    for (int k = 0; k < S; k++)
+        plan.signals[k].emergency = false;
+
+    vector<double> queue(S, 0.0), lastCount(S, 0.0);
+    double T = rec.intervalSeconds;
+    double perSaturated = 1.0 / (T * SATURATION_FLOW);
+    ReplayResult r;
+    r.scenario = scenario;
+    r.vehicles = r.delay = r.maxQueue = 0;
+
+    for (int t = 0; t < rec.intervals; t++) {
+        const unsigned short* a = &rec.arrivals[(size_t)t * S];
+
+        for (int j = 0; j < n; j++) {
+            int total = 0;
+            for (int k = plan.signalStart[j]; k < plan.signalStart[j + 1]; k++) {
+                int seen = (int)(queue[k] + lastCount[k] + 0.5);
+                plan.signals[k].vehicles = seen;
+                total += seen;
+            }
+            plan.totalVehicles[j] = total;
+        }
+
+        for (int j = 0; j < n; j++) {
+            int first = plan.signalStart[j], last = plan.signalStart[j + 1];
+            Signal* s = &plan.signals[first];
+            int count = last - first;
+
+            switch (scenario.policy) {
+            case PolicyFixed:
+                for (int i = 0; i < count; i++)
+                    s[i].greenTime = (MIN_GREEN + MAX_GREEN) / 2;
+                break;
+            case PolicyJunction:
+                for (int i = 0; i < count; i++)
+                    s[i].greenTime = computeGreenTime(s[i].vehicles, plan.totalVehicles[j]);
+                break;
+            case PolicyNetwork:
+                optimizeJunction(plan, j, plan.totalVehicles);
+                break;
+            default: {
+                int longest = 0;
+                for (int i = 1; i < count; i++)
+                    if (s[i].vehicles > s[longest].vehicles) longest = i;
+                for (int i = 0; i < count; i++)
+                    s[i].greenTime = (i == longest) ? MAX_GREEN : MIN_GREEN;
+                break;
+            }
+            }
+
+            double cycle = count * LOST_TIME;
+            for (int i = 0; i < count; i++)
+                cycle += s[i].greenTime;
+            double perCycle = 1.0 / cycle;
+
+            for (int k = first; k < last; k++) {
+                double arrivals = a[k] * scenario.demand;
+                double share = plan.signals[k].greenTime * perCycle;
+                double capacity = SATURATION_FLOW * share * T;
+
+                // Uniform delay per vehicle, degree of saturation capped at 1
+                double y = min(share, arrivals * perSaturated);
+                double uniform = 0.5 * cycle * (1 - share) * (1 - share) / (1 - y);
+
+                // Overflow queue: grows or drains linearly over the interval
+                double q0 = queue[k];
+                double q1 = max(0.0, q0 + arrivals - capacity);
+                double rate = (arrivals - capacity) / T;
+                double overflow;
+                if (rate >= 0) {
+                    overflow = 0.5 * (q0 + q1) * T;
+                } else {
+                    double clear = min(T, q0 / -rate);
+                    overflow = 0.5 * (2 * q0 + rate * clear) * clear;
+                }
+
+                r.delay += arrivals * uniform + overflow;
+                r.vehicles += arrivals;
+                r.maxQueue = max(r.maxQueue, q1);
+                queue[k] = q1;
+                lastCount[k] = arrivals;
+            }
+        }
+    }
+
+    r.leftQueued = 0;
+    for (int k = 0; k < S; k++)
+        r.leftQueued += queue[k];
+    double signalSeconds = T * rec.intervals * max(S, 1);
+    r.avgQueue = signalSeconds > 0 ? r.delay / signalSeconds : 0;
+    r.ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+    return r;
+}
+
+/* ---------- REPLAY SCENARIOS IN PARALLEL ---------- */
+// Scenarios share nothing but the read-only network and recording, so
+// each thread takes the next scenario until none are left.
+vector<ReplayResult> replayScenarios(const JunctionNetwork& net, const TrafficRecording& rec,
+                                     const vector<ReplayScenario>& scenarios, int threads) {
+    vector<ReplayResult> result(scenarios.size());
+    threads = max(1, min(threads, (int)scenarios.size()));
+
+    atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < scenarios.size(); i = next++)
+            result[i] = replayScenario(net, rec, scenarios[i]);
+    };
+
+    vector<thread> pool;
+    for (int t = 1; t < threads; t++)
+        pool.push_back(thread(worker));
+    worker();
+    for (size_t t = 0; t < pool.size(); t++)
+        pool[t].join();
+    return result;
+}
+
+/* ---------- DISPLAY REPLAY ---------- */
+void displayReplay(const vector<ReplayResult>& results) {
+    for (size_t i = 0; i < results.size(); i++) {
+        const ReplayResult& r = results[i];
+        cout << "Policy " << policyName(r.scenario.policy)
+             << " | Demand x" << r.scenario.demand
+             << " | Vehicles: " << (long long)(r.vehicles + 0.5)
+             << " | Avg delay: " << (r.vehicles > 0 ? r.delay / r.vehicles : 0) << " sec"
+             << " | Avg queue: " << r.avgQueue
+             << " | Max queue: " << (int)(r.maxQueue + 0.5)
+             << " | Left queued: " << (int)(r.leftQueued + 0.5) << endl;
+    }
+}
+
+/* ---------- REPLAY BENCHMARK ---------- */
+// One synthetic city-day at 2-minute intervals, every policy at recorded
+// and +15% demand, first on one thread and then on `threads`.
+void benchmarkReplay(int junctions, int threads) {
+    const int intervalSeconds = 120;
+    const int intervals = 86400 / intervalSeconds;
+    const double demands[] = {1.0, 1.15};
+
+    JunctionNetwork net;
+    generateNetwork(net, junctions, 42);
+    TrafficRecording rec;
+    chrono::steady_clock::time_point g0 = chrono::steady_clock::now();
+    generateRecording(net, intervals, intervalSeconds, 11, rec);
+    double genMs = chrono::duration<double, milli>(chrono::steady_clock::now() - g0).count();
+
+    vector<ReplayScenario> scenarios;
+    for (double d : demands) {
+        for (int p = 0; p < PolicyCount; p++) {
+            ReplayScenario s = { (ReplayPolicy)p, d };
+            scenarios.push_back(s);
+        }
+    }
+
+    cout << "bench=replay junctions=" << net.size()
+         << " signals=" << net.signals.size()
+         << " intervals=" << intervals << "x" << intervalSeconds << "s"
+         << " recording_mb=" << rec.arrivals.size() * sizeof(unsigned short) / 1048576.0
+         << " generate_ms=" << genMs << endl;
+
+    vector<int> threadCounts(1, 1);
+    if (threads > 1) threadCounts.push_back(threads);
+    for (size_t i = 0; i < threadCounts.size(); i++) {
+        chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+        vector<ReplayResult> results = replayScenarios(net, rec, scenarios, threadCounts[i]);
+        double wallMs = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+
+        for (size_t k = 0; k < results.size() && i == 0; k++) {
+            const ReplayResult& r = results[k];
+            cout << "policy=" << policyName(r.scenario.policy)
+                 << " demand=" << r.scenario.demand
+                 << " avg_delay_s=" << (r.vehicles > 0 ? r.delay / r.vehicles : 0)
+                 << " avg_queue=" << r.avgQueue
+                 << " max_queue=" << r.maxQueue
+                 << " left_queued=" << (long long)r.leftQueued
+                 << " replay_ms=" << r.ms << endl;
+        }
+        cout << "threads=" << threadCounts[i]
+             << " scenarios=" << scenarios.size()
+             << " wall_ms=" << wallMs
+             << " ms_per_city_day=" << wallMs / scenarios.size()
+             << " signal_intervals_per_s=" << (double)net.signals.size() * intervals * scenarios.size() / (wallMs / 1000)
+             << " faster_than_realtime=" << 86400.0 * scenarios.size() / (wallMs / 1000) << endl;
+    }
+}
+
+/* ---------- LOAD ARTERIAL ---------- */
+// junction_id,signal,travel_sec in driving order - signal is the 1-based
+// position of the arterial signal inside the junction, travel_sec the
+// time from the previous row's junction (ignored on the first row).
+void loadArterialCSV(const string& filename, const JunctionNetwork& net, Arterial& a) {
+    StageTimer timer(StageParse);
+    unordered_map<int,int> dense;
+    for (int j = 0; j < net.size(); j++)
+        dense[net.junctionIds[j]] = j;
+
+    MappedCSV file(filename);
+    if (!file.isOpen()) {
+        cerr << "Error opening file: " << filename << endl;
+        exit(1);
+    }
+    CSVRow row;
+    file.skipLine(); // skip header
+    while (file.nextRow(row)) {
+        unordered_map<int,int>::const_iterator j = dense.find(row.toInt(0));
+        int k = row.toInt(1) - 1;
+        if (j == dense.end() || k < 0 ||
+            k >= net.signalStart[j->second + 1] - net.signalStart[j->second]) {
+            cerr << "Skipping arterial row for junction " << row.toInt(0) << ": unknown signal\n";
+            continue;
+        }
+        a.junctions.push_back(j->second);
+        a.signals.push_back(net.signalStart[j->second] + k);
+        a.travel.push_back(a.junctions.size() == 1 ? 0 : max(row.toInt(2), 0));
+    }
+}
+
+/* ---------- CURRENT (UNCOORDINATED) TIMINGS ---------- */
+// Coordination needs one cycle length: the longest junction cycle on the
+// arterial (greens + LOST_TIME per phase). Shorter junctions stretch all
+// their greens in proportion. Offsets are all zero, which is what the
+// controller does today: every junction starts its cycle on its own.
+GreenWave uncoordinatedWave(const JunctionNetwork& net, const Arterial& a) {
+    int m = (int)a.junctions.size();
+    vector<int> own(m), lost(m);
+    GreenWave w;
+    w.cycle = 1;
+    for (int i = 0; i < m; i++) {
+        int j = a.junctions[i];
+        lost[i] = (net.signalStart[j + 1] - net.signalStart[j]) * LOST_TIME;
+        own[i] = lost[i];
+        for (int k = net.signalStart[j]; k < net.signalStart[j + 1]; k++)
+            own[i] += net.signals[k].greenTime;
+        w.cycle = max(w.cycle, own[i]);
+    }
+    w.green.resize(m);
+    w.offset.assign(m, 0);
+    for (int i = 0; i < m; i++) {
+        int g = net.signals[a.signals[i]].greenTime;
+        int usable = own[i] - lost[i];
+        w.green[i] = usable > 0 ? (int)((long long)g * (w.cycle - lost[i]) / usable) : 0;
+    }
+    measureBandwidth(a, w);
+    return w;
+}
+
+/* ---------- GREEN-WAVE OFFSETS ---------- */
+// Exact two-way bandwidth (to the second) for a common cycle C.
+// With T_i the travel time from the first junction and u_i = offset_i - T_i,
+// an outbound vehicle leaving junction 0 at t passes every green when
+// t is in [u_i, u_i + g_i) for all i; an inbound vehicle reaching junction
+// 0 at s does when s is in [u_i + 2 T_i, u_i + 2 T_i + g_i) for all i.
+// Shifting all offsets together moves both bands, so the outbound band
+// can be pinned to [0, b). Then junction i may use any u_i in [b - g_i, 0]
+// and, for an inbound band starting at c, the best it allows is
+// g_i - min over that range of (c - 2 T_i - u_i) mod C - O(1) per junction.
+// Enumerating b and c gives O(g_min * C * m), with no state between solves,
+// so a count change just re-solves the corridor.
+GreenWave planGreenWave(const JunctionNetwork& net, const Arterial& a) {
+    GreenWave w = uncoordinatedWave(net, a);
+    int m = (int)a.junctions.size();
+    int C = w.cycle;
+
+    vector<int> twice(m);               // 2 T_i mod C
+    int gmin = C;
+    long long T = 0;
+    for (int i = 0; i < m; i++) {
+        T += a.travel[i];
+        twice[i] = (int)(2 * T % C);
+        gmin = min(gmin, w.green[i]);
+    }
+
+    int bestOut = 0, bestIn = 0, bestC = 0;
+    for (int b = gmin; b >= 0; b--) {
+        if (b + gmin < bestOut + bestIn) break;     // inbound is capped by g_min too
+        for (int c = 0; c < C; c++) {
+            int in = gmin;
+            for (int i = 0; i < m && in > 0; i++) {
+                int e = c - twice[i];
+                if (e < 0) e += C;
+                int d = e + w.green[i] - b >= C ? 0 : e;
+                in = min(in, w.green[i] - d);
+            }
+            in = max(in, 0);
+            // Prefer the larger total, then the more even split
+            if (b + in > bestOut + bestIn ||
+                (b + in == bestOut + bestIn && min(b, in) > min(bestOut, bestIn))) {
+                bestOut = b;
+                bestIn = in;
+                bestC = c;
+            }
+        }
+    }
+
+    T = 0;
+    for (int i = 0; i < m; i++) {
+        T += a.travel[i];
+        int e = bestC - twice[i];
+        if (e < 0) e += C;
+        int k = e + w.green[i] - bestOut >= C ? (C - e) % C : 0;    // u_i = -k
+        w.offset[i] = (int)(((T - k) % C + C) % C);
+    }
+    measureBandwidth(a, w);
+    return w;
+}
+
+/* ---------- MEASURE BANDWIDTH ---------- */
+// Longest run of departure seconds (cyclic) that pass every arterial
+// green without stopping, each way. Independent of how offsets were set.
+void measureBandwidth(const Arterial& a, GreenWave& w) {
+    int m = (int)a.junctions.size();
+    int C = w.cycle;
+    vector<long long> arrive(m);
+    long long T = 0;
+    for (int i = 0; i < m; i++) {
+        T += a.travel[i];
+        arrive[i] = T;
+    }
+
+    for (int dir = 0; dir < 2; dir++) {
+        vector<char> pass(C, 1);
+        for (int t = 0; t < C; t++) {
+            for (int i = 0; i < m && pass[t]; i++) {
+                // outbound passes junction i at t + T_i, inbound at t - T_i
+                long long at = dir == 0 ? t + arrive[i] - w.offset[i] : t - arrive[i] - w.offset[i];
+                int phase = (int)(((at % C) + C) % C);
+                pass[t] = phase < w.green[i];
+            }
+        }
+        int best = 0, run = 0;
+        for (int t = 0; t < 2 * C; t++) {
+            run = pass[t % C] ? run + 1 : 0;
+            best = max(best, run);
+        }
+        (dir == 0 ? w.outbound : w.inbound) = min(best, C);
+    }
+}
+
+/* ---------- DISPLAY GREEN WAVE ---------- */
+void displayGreenWave(const JunctionNetwork& net, const Arterial& a,
+                      const GreenWave& before, const GreenWave& after) {
+    cout << "Arterial junctions: " << a.junctions.size()
+         << " | Common cycle: " << after.cycle << " sec\n";
+    long long T = 0;
+    for (size_t i = 0; i < a.junctions.size(); i++) {
+        T += a.travel[i];
+        int j = a.junctions[i];
+        cout << "Junction " << net.junctionIds[j]
+             << " | Signal " << a.signals[i] - net.signalStart[j] + 1
+             << " | Arrives: " << T << " sec"
+             << " | Green: " << after.green[i] << " sec"
+             << " | Offset: " << after.offset[i] << " sec\n";
+    }
+    cout << "\nBandwidth (outbound / inbound):\n"
+         << "  Uncoordinated: " << before.outbound << " / " << before.inbound << " sec\n"
+         << "  Green wave:    " << after.outbound << " / " << after.inbound << " sec\n";
+}
+
+/* ---------- GREEN-WAVE BENCHMARK ---------- */
+// The arterial is the first row of a junctions x junctions synthetic grid
+// with 20-60 s between junctions; arterial approaches get 60 extra
+// vehicles so they hold the longest greens. Each tick, counts change at 10% of the
+// arterial junctions; those are re-timed and the corridor is re-solved.
+void benchmarkGreenWave(int junctions) {
+    const int ticks = 200;
+
+    JunctionNetwork net;
+    generateNetwork(net, junctions * junctions, 42);
+    for (size_t k = 0; k < net.signals.size(); k++)
+        net.signals[k].emergency = false;
+
+    mt19937 rng(9);
+    uniform_int_distribution<int> travel(20, 60);
+    uniform_int_distribution<int> vehicles(0, 60);
+    uniform_int_distribution<int> anyJunction(0, junctions - 1);
+    Arterial a;
+    for (int j = 0; j < junctions; j++) {
+        int count = net.signalStart[j + 1] - net.signalStart[j];
+        int k = net.signalStart[j] + (int)(rng() % count);
+        a.junctions.push_back(j);
+        a.signals.push_back(k);
+        a.travel.push_back(j == 0 ? 0 : travel(rng));
+        // the arterial approach carries the heavier flow
+        net.signals[k].vehicles += 60;
+        net.totalVehicles[j] += 60;
+    }
+    runNetworkCycle(net);
+
+    vector<double> latency;
+    double before = 0, after = 0, cycleSum = 0, cap = 0;
+    for (int t = 0; t < ticks; t++) {
+        chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+        for (int c = 0; c < max(1, junctions / 10); c++) {
+            int j = anyJunction(rng);
+            net.totalVehicles[j] = 0;
+            for (int k = net.signalStart[j]; k < net.signalStart[j + 1]; k++) {
+                net.signals[k].vehicles = vehicles(rng) + (k == a.signals[j] ? 60 : 0);
+                net.totalVehicles[j] += net.signals[k].vehicles;
+            }
+            optimizeJunction(net, j, net.totalVehicles);
+        }
+        GreenWave wave = planGreenWave(net, a);
+        latency.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count());
+
+        GreenWave base = uncoordinatedWave(net, a);
+        before += base.outbound + base.inbound;
+        after += wave.outbound + wave.inbound;
+        cycleSum += wave.cycle;
+        cap += 2 * *min_element(wave.green.begin(), wave.green.end());
+    }
+    sort(latency.begin(), latency.end());
+    double avg = 0;
+    for (size_t k = 0; k < latency.size(); k++) avg += latency[k];
+    avg /= latency.size();
+
+    cout << "bench=greenwave junctions=" << junctions
+         << " ticks=" << ticks
+         << " cycle_s_avg=" << cycleSum / ticks
+         << " resolve_ms_avg=" << avg
+         << " resolve_ms_p50=" << latency[latency.size() / 2]
+         << " resolve_ms_p99=" << latency[latency.size() * 99 / 100]
+         << " bandwidth_uncoordinated_s=" << before / ticks
+         << " bandwidth_greenwave_s=" << after / ticks
+         << " bandwidth_gain_s=" << (after - before) / ticks
+         << " bandwidth_cap_s=" << cap / ticks << endl;
+}
+
+/* ---------- ALGORITHM BENCHMARK ---------- */
+// Times the timing algorithms on a traffic_data.csv of any size
+// (Benchmarks/gen_data writes them). readSignalCSV stops after SIGNALS
+// rows, so the whole file is read with the same parsing into one junction
+// for heapSort / optimizeTraffic, and cut into junctions of SIGNALS
+// signals (square grid links, as generateNetwork) for the network cycle.
+// dijkstra runs on the fixed SIGNALS-node graph from initGraph; it is
+// reported per call.
+void benchmarkAlgorithms(const string& filename) {
+    const int dijkstraCalls = 100000;
+    Junction all;
+    all.id = 0;
+    all.totalVehicles = 0;
+
+    double ms = timeMs([&]() {
+        MappedCSV file(filename);
+        if (!file.isOpen()) {
+            cerr << "Error opening file: " << filename << endl;
+            exit(1);
+        }
+        CSVRow row;
+        file.skipLine(); // skip header
+        while (file.nextRow(row)) {
+            Signal s;
+            s.id = (int)all.signals.size();
+            s.vehicles = row.toInt(1);
+            s.emergency = row.toInt(2);
+            s.greenTime = 0;
+            all.totalVehicles += s.vehicles;
+            all.signals.push_back(s);
+        }
+    });
+    int n = (int)all.signals.size();
+    reportAlgorithm("traffic", "loadSignals", n, ms);
+    if (n == 0)
+        return;
+
+    vector<Signal> sorted = all.signals;
+    ms = timeMs([&]() { heapSort(sorted); });
+    reportAlgorithm("traffic", "heapSort", n, ms);
+
+    vector<Junction> neighbors(NEIGHBORS);
+    for (int k = 0; k < NEIGHBORS; k++)
+        neighbors[k].totalVehicles = all.totalVehicles;
+    {
+        QuietCout quiet;
+        ms = timeMs([&]() { optimizeTraffic(all, neighbors); });
+    }
+    reportAlgorithm("traffic", "optimizeTraffic", n, ms);
+
+    vector<vector<int> > graph;
+    initGraph(graph);
+    long long reached = 0;
+    ms = timeMs([&]() {
+        for (int c = 0; c < dijkstraCalls; c++)
+            reached += dijkstra(graph, c % SIGNALS)[0];
+    });
+    reportAlgorithm("traffic", "dijkstra", SIGNALS, ms / dijkstraCalls);
+
+    int junctions = (n + SIGNALS - 1) / SIGNALS;
+    int side = 1;
+    while (side * side < junctions) side++;
+    vector<pair<int,Signal> > rows;
+    vector<pair<int,int> > links;
+    rows.reserve(n);
+    for (int i = 0; i < n; i++)
+        rows.push_back(make_pair(i / SIGNALS, all.signals[i]));
+    for (int j = 0; j < junctions; j++) {
+        int r = j / side, c = j % side;
+        if (c > 0)                             links.push_back(make_pair(j, j - 1));
+        if (c + 1 < side && j + 1 < junctions) links.push_back(make_pair(j, j + 1));
+        if (r > 0)                             links.push_back(make_pair(j, j - side));
+        if (j + side < junctions)              links.push_back(make_pair(j, j + side));
+    }
+    JunctionNetwork net;
+    ms = timeMs([&]() { buildNetwork(net, rows, links); });
+    reportAlgorithm("traffic", "buildNetwork", n, ms);
+    ms = timeMs([&]() { runNetworkCycle(net); });
+    reportAlgorithm("traffic", "runNetworkCycle", n, ms);
+    reportMetricsOverhead("traffic");
+}
@@ -0,0 +1,93 @@
+#ifndef BENCH_TIMER_H
+#define BENCH_TIMER_H
+
+/*
+ Timing helpers for the "bench-algorithms <csv>" mode of each program,
+ which Benchmarks/run_benchmarks.sh sweeps over generated data sets.
+
+ Every measurement is printed as one line
+
+   bench=algorithm program=<p> function=<f> rows=<n> ms=<t> ns_per_row=<x>
+
+ and, for quadratic or worse functions run on a prefix of the file,
+ capped_from=<file rows>. The runner turns these lines into CSV.
+
+ The run ends with the cost of the stage instrumentation (metrics.h)
+ inside the timed functions:
+
+   bench=metrics_overhead program=<p> timers=<n> sampled_out=<m> timer_ns=<c>
+         count_ns=<d> timed_ms=<t> overhead_pct=<x>
+
+ i.e. n clock-reading StageTimers at their calibrated cost c plus m
+ sampled-out calls at cost d, over the total time reported. This says
+ where the instrumentation cost goes; whether it is actually paid is
+ measured separately: run_benchmarks.sh builds every program again with
+ -DNO_METRICS and compares the median gap of paired runs of both
+ builds against 1% plus the noise measured across those pairs.
+
+ Functions that print per row are timed with cout discarded through
+ QuietCout: the formatting is still done and timed, the terminal is not.
+*/
+
+#include <iostream>
+#include <streambuf>
+#include <chrono>
+#include "metrics.h"
+
+class QuietCout {
+public:
+    QuietCout() : saved(std::cout.rdbuf(&sink)) {}
+    ~QuietCout() { std::cout.rdbuf(saved); }
+
+private:
+    struct Discard : std::streambuf {
+        char buf[4096];
+        Discard() { setp(buf, buf + sizeof(buf)); }
+        std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+        int overflow(int c) override { setp(buf, buf + sizeof(buf)); return c; }
+    };
+    Discard sink;
+    std::streambuf* saved;
+};
+
+// Wall time of fn() in milliseconds
+template<class F> double timeMs(F fn) {
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// Sum of every ms passed to reportAlgorithm
+inline double& benchTimedMs() {
+    static double total = 0;
+    return total;
+}
+
+inline void reportAlgorithm(const char* program, const char* function, long long rows,
+                            double ms, long long cappedFrom = 0) {
+    benchTimedMs() += ms;
+    std::cout << "bench=algorithm program=" << program
+              << " function=" << function
+              << " rows=" << rows
+              << " ms=" << ms
+              << " ns_per_row=" << (rows > 0 ? ms * 1e6 / rows : 0.0);
+    if (cappedFrom > rows) std::cout << " capped_from=" << cappedFrom;
+    std::cout << std::endl;
+}
+
+inline void reportMetricsOverhead(const char* program) {
+    MetricsSnapshot snap = metricsSnapshot();
+    uint64_t timers = snap.totalTimed(), counted = snap.totalCalls() - timers;
+    double cost = metricsTimerCostNs(), countCost = metricsTimerCostNs(false);
+    double timed = benchTimedMs();
+    double overheadNs = timers * cost + counted * countCost;
+    std::cout << "bench=metrics_overhead program=" << program
+              << " timers=" << timers
+              << " sampled_out=" << counted
+              << " timer_ns=" << cost
+              << " count_ns=" << countCost
+              << " timed_ms=" << timed
+              << " overhead_pct=" << (timed > 0 ? overheadNs / (timed * 1e4) : 0.0) << std::endl;
+}
+
+#endif
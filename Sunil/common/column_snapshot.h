@@ -0,0 +1,284 @@
+#ifndef COLUMN_SNAPSHOT_H
+#define COLUMN_SNAPSHOT_H
+
+/*
+ Binary columnar snapshot of a sensor table.
+
+ A snapshot is written once from the CSV and memory-mapped on startup.
+ Every column is a plain array (int32 / float32 / float64 / uint8) or a
+ dictionary-encoded string column (uint32 codes + one copy of each
+ distinct string), so a scan only pages in the columns it reads.
+
+ Layout (little endian, sections 64-byte aligned):
+   header   "CSNP", version, row count, column count
+   columns  name[32], type, data offset/bytes, dictionary offset/bytes
+   data     column arrays and dictionaries
+
+ Needs C++17 (string_view).
+*/
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+enum ColumnType : uint32_t { COL_INT32 = 1, COL_FLOAT32 = 2, COL_FLOAT64 = 3, COL_UINT8 = 4, COL_DICT = 5 };
+
+struct SnapshotHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t rows;
+    uint32_t columns;
+    uint32_t reserved;
+};
+
+struct SnapshotColumn {
+    char name[32];
+    uint32_t type;
+    uint32_t dictCount;     // distinct strings (COL_DICT only)
+    uint64_t offset, bytes;
+    uint64_t dictOffset, dictBytes;
+};
+
+// Dictionary column view: codes[row] indexes the distinct strings
+struct DictColumn {
+    const uint32_t* codes = 0;
+    uint32_t count = 0;
+    const uint32_t* stringStart = 0;   // count + 1 offsets into chars
+    const char* chars = 0;
+
+    std::string_view value(uint32_t code) const {
+        return std::string_view(chars + stringStart[code], stringStart[code + 1] - stringStart[code]);
+    }
+    std::string_view at(size_t row) const { return value(codes[row]); }
+};
+
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(uint64_t rows) : rowCount(rows) {}
+
+    void addInt32(const std::string& name, const std::vector<int32_t>& v)  { add(name, COL_INT32, v.data(), v.size() * 4); }
+    void addFloat32(const std::string& name, const std::vector<float>& v)  { add(name, COL_FLOAT32, v.data(), v.size() * 4); }
+    void addFloat64(const std::string& name, const std::vector<double>& v) { add(name, COL_FLOAT64, v.data(), v.size() * 8); }
+    void addUInt8(const std::string& name, const std::vector<uint8_t>& v)  { add(name, COL_UINT8, v.data(), v.size()); }
+
+    void addStrings(const std::string& name, const std::vector<std::string>& v) {
+        std::unordered_map<std::string, uint32_t> ids;
+        std::vector<uint32_t> codes(v.size());
+        std::vector<uint32_t> starts(1, 0);
+        std::string chars;
+        for (size_t i = 0; i < v.size(); i++) {
+            auto it = ids.find(v[i]);
+            if (it == ids.end()) {
+                it = ids.emplace(v[i], (uint32_t)ids.size()).first;
+                chars += v[i];
+                starts.push_back((uint32_t)chars.size());
+            }
+            codes[i] = it->second;
+        }
+        Pending p = make(name, COL_DICT, codes.data(), codes.size() * 4);
+        p.col.dictCount = (uint32_t)ids.size();
+        p.dict.assign((const char*)starts.data(), starts.size() * 4);
+        p.dict += chars;
+        pending.push_back(p);
+    }
+
+    bool write(const std::string& path) const {
+        FILE* f = fopen(path.c_str(), "wb");
+        if (!f) return false;
+
+        SnapshotHeader h;
+        memcpy(h.magic, "CSNP", 4);
+        h.version = 1;
+        h.rows = rowCount;
+        h.columns = (uint32_t)pending.size();
+        h.reserved = 0;
+
+        std::vector<SnapshotColumn> cols;
+        uint64_t at = align(sizeof(h) + pending.size() * sizeof(SnapshotColumn));
+        for (size_t i = 0; i < pending.size(); i++) {
+            SnapshotColumn c = pending[i].col;
+            c.offset = at;
+            at = align(at + c.bytes);
+            if (c.type == COL_DICT) {
+                c.dictOffset = at;
+                c.dictBytes = pending[i].dict.size();
+                at = align(at + c.dictBytes);
+            }
+            cols.push_back(c);
+        }
+
+        bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+        if (!cols.empty())
+            ok = ok && fwrite(cols.data(), sizeof(SnapshotColumn), cols.size(), f) == cols.size();
+        uint64_t written = sizeof(h) + cols.size() * sizeof(SnapshotColumn);
+        for (size_t i = 0; i < pending.size() && ok; i++) {
+            ok = pad(f, written, cols[i].offset) && put(f, written, pending[i].data);
+            if (cols[i].type == COL_DICT)
+                ok = ok && pad(f, written, cols[i].dictOffset) && put(f, written, pending[i].dict);
+        }
+        return fclose(f) == 0 && ok;
+    }
+
+private:
+    struct Pending {
+        SnapshotColumn col;
+        std::string data, dict;
+    };
+    uint64_t rowCount;
+    std::vector<Pending> pending;
+
+    static uint64_t align(uint64_t x) { return (x + 63) & ~(uint64_t)63; }
+
+    Pending make(const std::string& name, ColumnType type, const void* data, size_t bytes) const {
+        Pending p;
+        memset(&p.col, 0, sizeof(p.col));
+        strncpy(p.col.name, name.c_str(), sizeof(p.col.name) - 1);
+        p.col.type = type;
+        p.col.bytes = bytes;
+        p.data.assign((const char*)data, bytes);
+        return p;
+    }
+    void add(const std::string& name, ColumnType type, const void* data, size_t bytes) {
+        pending.push_back(make(name, type, data, bytes));
+    }
+    static bool pad(FILE* f, uint64_t& written, uint64_t to) {
+        static const char zeros[64] = {0};
+        if (to < written || to - written > 64) return false;
+        size_t n = (size_t)(to - written);
+        written = to;
+        return n == 0 || fwrite(zeros, 1, n, f) == n;
+    }
+    static bool put(FILE* f, uint64_t& written, const std::string& s) {
+        written += s.size();
+        return s.empty() || fwrite(s.data(), 1, s.size(), f) == s.size();
+    }
+};
+
+class MappedSnapshot {
+public:
+    MappedSnapshot() : base(0), size(0) {}
+    ~MappedSnapshot() { close(); }
+    MappedSnapshot(const MappedSnapshot&) = delete;
+    MappedSnapshot& operator=(const MappedSnapshot&) = delete;
+
+    // Maps and validates the file; false on any inconsistency. Every
+    // column must lie inside the file, every dictionary code must name an
+    // entry and every entry must lie inside its dictionary, so a truncated
+    // or corrupt snapshot is rejected instead of read out of bounds.
+    bool open(const std::string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SnapshotHeader)) { ::close(fd); return false; }
+        size = (size_t)st.st_size;
+        void* p = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) { size = 0; return false; }
+        base = (const char*)p;
+
+        const SnapshotHeader* h = header();
+        if (memcmp(h->magic, "CSNP", 4) != 0 || h->version != 1 || h->rows > size ||
+            sizeof(SnapshotHeader) + (uint64_t)h->columns * sizeof(SnapshotColumn) > size) {
+            close();
+            return false;
+        }
+        for (uint32_t i = 0; i < h->columns; i++)
+            if (!valid(column(i), h->rows)) {
+                close();
+                return false;
+            }
+        return true;
+    }
+
+    bool isOpen() const { return base != 0; }
+    uint64_t rows() const { return header()->rows; }
+
+    const int32_t* int32Column(const char* name) const  { return (const int32_t*)find(name, COL_INT32); }
+    const float* float32Column(const char* name) const  { return (const float*)find(name, COL_FLOAT32); }
+    const double* float64Column(const char* name) const { return (const double*)find(name, COL_FLOAT64); }
+    const uint8_t* uint8Column(const char* name) const  { return (const uint8_t*)find(name, COL_UINT8); }
+
+    DictColumn dictColumn(const char* name) const {
+        DictColumn d;
+        for (uint32_t i = 0; base && i < header()->columns; i++) {
+            const SnapshotColumn& c = column(i);
+            if (c.type == COL_DICT && strncmp(c.name, name, sizeof(c.name)) == 0) {
+                d.codes = (const uint32_t*)(base + c.offset);
+                d.count = c.dictCount;
+                d.stringStart = (const uint32_t*)(base + c.dictOffset);
+                d.chars = base + c.dictOffset + (uint64_t)(c.dictCount + 1) * 4;
+            }
+        }
+        return d;
+    }
+
+    void close() {
+        if (base) munmap((void*)base, size);
+        base = 0;
+        size = 0;
+    }
+
+private:
+    const char* base;
+    size_t size;
+
+    const SnapshotHeader* header() const { return (const SnapshotHeader*)base; }
+    const SnapshotColumn& column(uint32_t i) const {
+        return ((const SnapshotColumn*)(base + sizeof(SnapshotHeader)))[i];
+    }
+    bool inside(uint64_t offset, uint64_t bytes) const {
+        return offset <= size && bytes <= size - offset;
+    }
+
+    bool valid(const SnapshotColumn& c, uint64_t rows) const {
+        if (c.type < COL_INT32 || c.type > COL_DICT) return false;
+        uint64_t width = c.type == COL_FLOAT64 ? 8 : c.type == COL_UINT8 ? 1 : 4;
+        if (c.bytes != rows * width || c.offset % width != 0 || !inside(c.offset, c.bytes)) return false;
+        if (c.type != COL_DICT) return true;
+
+        uint64_t startBytes = ((uint64_t)c.dictCount + 1) * 4;
+        if (c.dictOffset % 4 != 0 || !inside(c.dictOffset, c.dictBytes) || startBytes > c.dictBytes)
+            return false;
+        const uint32_t* start = (const uint32_t*)(base + c.dictOffset);
+        if (start[0] != 0) return false;
+        for (uint32_t k = 0; k < c.dictCount; k++)
+            if (start[k + 1] < start[k]) return false;
+        if (start[c.dictCount] > c.dictBytes - startBytes) return false;
+        const uint32_t* codes = (const uint32_t*)(base + c.offset);
+        for (uint64_t r = 0; r < rows; r++)
+            if (codes[r] >= c.dictCount) return false;
+        return true;
+    }
+
+    const void* find(const char* name, ColumnType type) const {
+        for (uint32_t i = 0; base && i < header()->columns; i++) {
+            const SnapshotColumn& c = column(i);
+            if (c.type == type && strncmp(c.name, name, sizeof(c.name)) == 0)
+                return base + c.offset;
+        }
+        return 0;
+    }
+};
+
+// True when `snapshot` exists and was modified strictly after `source`,
+// to the nanosecond. An equal timestamp counts as stale: a CSV edited
+// within the same filesystem tick as the snapshot write must not be
+// hidden by it, and a needless CSV parse is the safe side to err on.
+inline bool snapshotIsFresh(const std::string& snapshot, const std::string& source) {
+    struct stat a, b;
+    if (stat(snapshot.c_str(), &a) != 0) return false;
+    if (stat(source.c_str(), &b) != 0) return true;
+    if (a.st_mtim.tv_sec != b.st_mtim.tv_sec) return a.st_mtim.tv_sec > b.st_mtim.tv_sec;
+    return a.st_mtim.tv_nsec > b.st_mtim.tv_nsec;
+}
+
+#endif
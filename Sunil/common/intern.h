@@ -0,0 +1,193 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+/*
+ Interned names for the record structs: zone, subzone and basin names
+ (and the app's area keys) are stored once and referred to by a 32-bit
+ id, so a record holds 4 bytes instead of a 32-byte std::string, and
+ copying a record into a heap, a span or a result vector never touches
+ the allocator.
+
+ StringInterner keeps the characters back to back in 64 KB arena blocks
+ that never move, so views handed out stay valid for the life of the
+ table. Lookups go through an open-addressing table (linear probing,
+ kept at most half full) whose slots hold the id and the full hash side
+ by side: a probe touches one cache line, the characters are compared
+ only on a hash match, and growing the table never re-reads them.
+
+ ZoneId is a handle into the process-wide nameTable(). Id 0 is the
+ empty string, which is what a default-constructed ZoneId names.
+ Interning is not thread-safe: the programs intern while loading, on
+ one thread, and only read names afterwards. A table that is rebuilt
+ while other threads read the old one (app server reloads) owns its
+ own StringInterner instead.
+*/
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class StringInterner {
+public:
+    static constexpr uint32_t None = UINT32_MAX;
+
+    StringInterner() : slots(16), cur(0), left(0), arenaBytes(0) {}
+
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    // Id of s, adding it on first sight
+    uint32_t intern(std::string_view s) {
+        uint32_t h = hashOf(s);
+        size_t mask = slots.size() - 1, i = h & mask;
+        for (;; i = (i + 1) & mask) {
+            const Slot& e = slots[i];
+            if (e.id == 0) break;
+            if (e.hash == h && strings[e.id - 1] == s) return e.id - 1;
+        }
+        uint32_t id = strings.size();
+        strings.push_back(copy(s));
+        if (2 * strings.size() > slots.size()) {
+            grow(slots.size() * 2);
+            place(id + 1, h);
+        } else {
+            slots[i] = Slot{id + 1, h};
+        }
+        return id;
+    }
+
+    // Id of s, or None when it was never interned
+    uint32_t find(std::string_view s) const {
+        uint32_t h = hashOf(s);
+        size_t mask = slots.size() - 1;
+        for (size_t i = h & mask;; i = (i + 1) & mask) {
+            const Slot& e = slots[i];
+            if (e.id == 0) return None;
+            if (e.hash == h && strings[e.id - 1] == s) return e.id - 1;
+        }
+    }
+
+    // Copy of s in the arena that is not interned, for strings that are
+    // printed but never looked up
+    std::string_view store(std::string_view s) { return copy(s); }
+
+    // Interned copy of s, valid as long as the table
+    std::string_view keep(std::string_view s) { return view(intern(s)); }
+
+    std::string_view view(uint32_t id) const { return strings[id]; }
+    uint32_t size() const { return strings.size(); }
+
+    // Heap bytes held: arena blocks, slot table and views
+    size_t bytes() const {
+        return arenaBytes + slots.capacity() * sizeof(Slot) + strings.capacity() * sizeof(std::string_view);
+    }
+
+private:
+    static constexpr size_t BlockSize = 64 << 10;
+
+    struct Slot {
+        uint32_t id;    // id + 1, 0 = empty
+        uint32_t hash;
+    };
+
+    std::vector<Slot> slots;
+    std::vector<std::string_view> strings;  // id -> characters in the arena
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char* cur;
+    size_t left;
+    size_t arenaBytes;
+
+    static uint32_t hashOf(std::string_view s) {
+        size_t h = std::hash<std::string_view>()(s);
+        return (uint32_t)(h ^ (h >> 32));
+    }
+
+    std::string_view copy(std::string_view s) {
+        if (s.empty()) return std::string_view();
+        if (s.size() > left) {
+            // Long names get a block of their own so the open block is kept
+            size_t n = s.size() > BlockSize / 4 ? s.size() : BlockSize;
+            blocks.emplace_back(new char[n]);
+            arenaBytes += n;
+            if (n != BlockSize) {
+                memcpy(blocks.back().get(), s.data(), s.size());
+                return std::string_view(blocks.back().get(), s.size());
+            }
+            cur = blocks.back().get();
+            left = n;
+        }
+        memcpy(cur, s.data(), s.size());
+        std::string_view v(cur, s.size());
+        cur += s.size();
+        left -= s.size();
+        return v;
+    }
+
+    void place(uint32_t idPlusOne, uint32_t hash) {
+        size_t mask = slots.size() - 1;
+        size_t i = hash & mask;
+        while (slots[i].id) i = (i + 1) & mask;
+        slots[i] = Slot{idPlusOne, hash};
+    }
+
+    void grow(size_t cap) {
+        std::vector<Slot> old(cap);
+        old.swap(slots);
+        for (const Slot& e : old)
+            if (e.id) place(e.id, e.hash);
+    }
+};
+
+// Names shared by every record of the program
+inline StringInterner& nameTable() {
+    static StringInterner* t = [] {
+        StringInterner* s = new StringInterner;
+        s->intern("");
+        return s;
+    }();
+    return *t;
+}
+
+class ZoneId {
+public:
+    ZoneId() : id(0) {}
+    explicit ZoneId(std::string_view s) : id(nameTable().intern(s)) {}
+
+    uint32_t index() const { return id; }
+    std::string_view view() const { return nameTable().view(id); }
+    std::string str() const { return std::string(view()); }
+    bool empty() const { return id == 0; }
+
+    friend bool operator==(ZoneId a, ZoneId b) { return a.id == b.id; }
+    friend bool operator!=(ZoneId a, ZoneId b) { return a.id != b.id; }
+    friend bool operator==(ZoneId a, std::string_view s) { return a.view() == s; }
+    friend bool operator!=(ZoneId a, std::string_view s) { return a.view() != s; }
+    friend std::ostream& operator<<(std::ostream& out, ZoneId z) { return out << z.view(); }
+
+private:
+    uint32_t id;
+};
+
+// Record index by name through the shared table: one hash of the query,
+// no string built per lookup. A later add() of the same name wins.
+class NameIndex {
+public:
+    void add(ZoneId name, int row) {
+        if (name.index() >= rowOf.size()) rowOf.resize(name.index() + 1, -1);
+        rowOf[name.index()] = row;
+    }
+    int find(std::string_view name) const {
+        uint32_t id = nameTable().find(name);
+        return id < rowOf.size() ? rowOf[id] : -1;
+    }
+
+private:
+    std::vector<int> rowOf;
+};
+
+#endif
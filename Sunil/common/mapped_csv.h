@@ -0,0 +1,173 @@
+#ifndef MAPPED_CSV_H
+#define MAPPED_CSV_H
+
+/*
+ Shared CSV reader for the traffic and pollution programs.
+
+ The file is memory-mapped read-only and rows are handed out as
+ string_view fields pointing into the mapping, so reading a row does
+ not allocate. Numbers are parsed with from_chars. Lines end in \n or
+ \r\n, blank lines are skipped, fields are split on ',' (no quoting,
+ none of our data sets use it).
+
+ Pages already consumed are released every few MB so peak RSS stays
+ flat on multi-GB historic dumps.
+
+ Needs C++17 (string_view, from_chars).
+*/
+
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+struct CSVRow {
+    static const int MaxFields = 16;
+    std::string_view field[MaxFields];
+    int count = 0;
+
+    std::string_view operator[](int i) const { return i < count ? field[i] : std::string_view(); }
+    std::string str(int i) const { std::string_view f = (*this)[i]; return std::string(f.data(), f.size()); }
+
+    // Like atoi / atof: leading blanks are skipped, bad input gives 0
+    int toInt(int i) const {
+        std::string_view f = trimmed(i);
+        int v = 0;
+        std::from_chars(f.data(), f.data() + f.size(), v);
+        return v;
+    }
+    long long toLong(int i) const {
+        std::string_view f = trimmed(i);
+        long long v = 0;
+        std::from_chars(f.data(), f.data() + f.size(), v);
+        return v;
+    }
+    double toDouble(int i) const {
+        std::string_view f = trimmed(i);
+        double v = 0;
+        std::from_chars(f.data(), f.data() + f.size(), v);
+        return v;
+    }
+    float toFloat(int i) const { return (float)toDouble(i); }
+
+private:
+    std::string_view trimmed(int i) const {
+        std::string_view f = (*this)[i];
+        while (!f.empty() && (f.front() == ' ' || f.front() == '\t')) f.remove_prefix(1);
+        if (!f.empty() && f.front() == '+') f.remove_prefix(1);
+        return f;
+    }
+};
+
+class MappedCSV {
+public:
+    MappedCSV() : data(0), size(0), pos(0), released(0), opened(false) {}
+    explicit MappedCSV(const std::string& path)
+        : data(0), size(0), pos(0), released(0), opened(false) { open(path); }
+    ~MappedCSV() { close(); }
+
+    MappedCSV(const MappedCSV&) = delete;
+    MappedCSV& operator=(const MappedCSV&) = delete;
+
+    // Returns false when the file cannot be opened or mapped. An empty
+    // file opens fine and simply has no rows.
+    bool open(const std::string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0) { ::close(fd); return false; }
+        size = (size_t)st.st_size;
+        if (size > 0) {
+            void* p = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) { ::close(fd); size = 0; return false; }
+            data = (const char*)p;
+            madvise(p, size, MADV_SEQUENTIAL);
+        }
+        ::close(fd);
+        opened = true;
+        return true;
+    }
+
+    bool isOpen() const { return opened; }
+    size_t bytes() const { return size; }
+
+    // Rows left from the current position, estimated from the line length
+    // of the next 64 KB plus 1/16 slack, for reserving record arrays in
+    // one block. Counting every line would fault in the whole mapping.
+    size_t estimateRows() const {
+        size_t sample = size - pos < (64 << 10) ? size - pos : (64 << 10);
+        if (sample == 0) return 0;
+        const char* end = data + pos + sample;
+        size_t lines = 0;
+        for (const char* p = data + pos; (p = (const char*)memchr(p, '\n', end - p)); p++)
+            lines++;
+        if (sample == size - pos) return lines + 1;
+        size_t rows = (size - pos) * (lines ? lines : 1) / sample;
+        return rows + rows / 16;
+    }
+
+    // Skips one line (e.g. the header), blank or not
+    void skipLine() {
+        if (pos >= size) return; // empty file: data may be null
+        const char* nl = (const char*)memchr(data + pos, '\n', size - pos);
+        pos = nl ? (size_t)(nl - data) + 1 : size;
+    }
+
+    // Fills row with the next non-blank line. Fields past MaxFields are
+    // folded into the last one.
+    bool nextRow(CSVRow& row) {
+        while (pos < size) {
+            const char* start = data + pos;
+            const char* nl = (const char*)memchr(start, '\n', size - pos);
+            const char* end = nl ? nl : data + size;
+            pos = nl ? (size_t)(nl - data) + 1 : size;
+            if (end > start && end[-1] == '\r') end--;
+            if (end == start) continue;
+
+            row.count = 0;
+            const char* p = start;
+            while (row.count < CSVRow::MaxFields - 1) {
+                const char* comma = (const char*)memchr(p, ',', end - p);
+                if (!comma) break;
+                row.field[row.count++] = std::string_view(p, comma - p);
+                p = comma + 1;
+            }
+            row.field[row.count++] = std::string_view(p, end - p);
+
+            releaseConsumed();
+            return true;
+        }
+        return false;
+    }
+
+    void close() {
+        if (data) munmap((void*)data, size);
+        data = 0; size = 0; pos = 0; released = 0;
+        opened = false;
+    }
+
+private:
+    const char* data;
+    size_t size;
+    size_t pos;
+    size_t released;
+    bool opened;
+
+    void releaseConsumed() {
+        const size_t step = 8 << 20;
+        if (pos - released < 2 * step) return;
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size_t upto = ((pos - step) / page) * page;
+        if (upto > released) {
+            madvise((void*)(data + released), upto - released, MADV_DONTNEED);
+            released = upto;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,406 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+/*
+ Stage instrumentation shared by the monitors: how often each pipeline
+ stage ran, how many items (rows, readings, queries) it handled and a
+ latency histogram per stage.
+
+   parse    reading CSV / stream input into records
+   quality  AQI and quality / risk scores
+   sort     sorting, heaps and ranked queues
+   search   graph searches and index lookups
+   alerts   rule and threshold evaluation
+
+ Recording never takes a lock. Each thread gets its own shard on first
+ use (one mutex acquisition per thread, ever) and only that thread writes
+ it, so counters are bumped with relaxed load + store instead of locked
+ read-modify-writes. A snapshot sums every shard; shards outlive their
+ threads so nothing recorded is lost when a worker exits.
+
+ Latencies go into power-of-two nanosecond buckets (bucket b holds
+ [2^(b-1), 2^b) ns), so recording is one bit scan and a few stores.
+
+ Timers wrap whole stages, never single rows: a StageTimer costs two
+ steady_clock reads (tens to a couple of hundred ns, depending on the
+ clock source), which is free around a load of a file and far too much
+ around one AQI formula. Loops add their row count with addItems().
+ Per-request paths that run in a few microseconds use sampled timers:
+ every call is counted, one in METRIC_SAMPLE_EVERY reads the clock and
+ goes into the histogram.
+
+ Export is driven by the environment, so no program mode changes:
+
+   METRICS_OUT=<file>        snapshot written at exit (.json gives JSON,
+                             anything else Prometheus text); the file is
+                             replaced atomically through <file>.tmp.<pid>
+   METRICS_OUT=unix:<path>   snapshot sent to a listening Unix socket
+   METRICS_INTERVAL=<sec>    also export every <sec> seconds while the
+                             program runs (stream follow, server mode)
+
+ Building with -DNO_METRICS compiles every timer to nothing.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+enum MetricStage {
+    StageParse,
+    StageQuality,
+    StageSort,
+    StageSearch,
+    StageAlerts,
+    StageCount
+};
+
+inline const char* metricStageName(int s) {
+    static const char* names[StageCount] = {"parse", "quality", "sort", "search", "alerts"};
+    return names[s];
+}
+
+const int METRIC_BUCKETS = 40;          // up to 2^39 ns, about 9 minutes
+const unsigned METRIC_SAMPLE_EVERY = 64;
+
+struct MetricShard {
+    std::atomic<uint64_t> calls[StageCount];    // every call
+    std::atomic<uint64_t> items[StageCount];
+    std::atomic<uint64_t> timed[StageCount];    // calls in the histogram
+    std::atomic<uint64_t> sumNs[StageCount];
+    std::atomic<uint64_t> buckets[StageCount][METRIC_BUCKETS];
+    unsigned tick[StageCount];                  // sampling phase, owner only
+
+    MetricShard() {
+        for (int s = 0; s < StageCount; s++) {
+            calls[s].store(0, std::memory_order_relaxed);
+            items[s].store(0, std::memory_order_relaxed);
+            timed[s].store(0, std::memory_order_relaxed);
+            sumNs[s].store(0, std::memory_order_relaxed);
+            tick[s] = 0;
+            for (int b = 0; b < METRIC_BUCKETS; b++) buckets[s][b].store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+inline int metricBucket(uint64_t ns) {
+    int b = ns ? 64 - __builtin_clzll(ns) : 0;
+    return b < METRIC_BUCKETS ? b : METRIC_BUCKETS - 1;
+}
+
+// Single-writer increment: only the owning thread stores to its shard
+inline void metricBump(std::atomic<uint64_t>& c, uint64_t n) {
+    c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+inline void metricCountInto(MetricShard& sh, int stage, uint64_t items) {
+    metricBump(sh.calls[stage], 1);
+    metricBump(sh.items[stage], items);
+}
+
+inline void metricRecordInto(MetricShard& sh, int stage, uint64_t ns, uint64_t items) {
+    metricCountInto(sh, stage, items);
+    metricBump(sh.timed[stage], 1);
+    metricBump(sh.sumNs[stage], ns);
+    metricBump(sh.buckets[stage][metricBucket(ns)], 1);
+}
+
+// Every shard ever created. Never destroyed: exporters may still run
+// from atexit or a detached thread while statics are torn down.
+struct MetricRegistry {
+    std::mutex lock;
+    std::vector<std::unique_ptr<MetricShard> > shards;
+};
+
+inline MetricRegistry& metricRegistry() {
+    static MetricRegistry* r = new MetricRegistry;
+    return *r;
+}
+
+inline MetricShard& metricLocalShard() {
+    thread_local MetricShard* mine = 0;
+    if (!mine) {
+        MetricRegistry& r = metricRegistry();
+        std::lock_guard<std::mutex> g(r.lock);
+        r.shards.emplace_back(new MetricShard);
+        mine = r.shards.back().get();
+    }
+    return *mine;
+}
+
+// Times its scope as one call of a stage. With sampled=true only every
+// METRIC_SAMPLE_EVERY-th call on a thread is timed; the rest are counted.
+class StageTimer {
+public:
+#ifndef NO_METRICS
+    explicit StageTimer(MetricStage s, uint64_t items = 0, bool sampled = false)
+        : shard(metricLocalShard()), stage(s), n(items),
+          timed(!sampled || shard.tick[s]++ % METRIC_SAMPLE_EVERY == 0) {
+        if (timed) t0 = start();
+    }
+    ~StageTimer() {
+        if (!timed) { metricCountInto(shard, stage, n); return; }
+        stop(shard, stage, t0, n);
+    }
+    void addItems(uint64_t k) { n += k; }
+
+private:
+    MetricShard& shard;
+    MetricStage stage;
+    uint64_t n;
+    bool timed;
+    std::chrono::steady_clock::time_point t0;
+
+    // The clock reads stay out of line: inlined into every timed function
+    // they cost more in lost inlining there (~2.5% of the app's lookups,
+    // measured A/B) than the reads themselves
+    __attribute__((noinline, cold)) static std::chrono::steady_clock::time_point start() {
+        return std::chrono::steady_clock::now();
+    }
+    __attribute__((noinline, cold)) static void stop(MetricShard& sh, MetricStage s,
+                                                     std::chrono::steady_clock::time_point t0, uint64_t n) {
+        metricRecordInto(sh, s, (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    std::chrono::steady_clock::now() - t0).count(), n);
+    }
+#else
+    explicit StageTimer(MetricStage, uint64_t = 0, bool = false) {}
+    void addItems(uint64_t) {}
+#endif
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+};
+
+/* ---- snapshots ---- */
+
+struct StageSnapshot {
+    uint64_t calls = 0, items = 0, timed = 0, sumNs = 0;
+    uint64_t buckets[METRIC_BUCKETS] = {};
+
+    // Upper bound of the bucket holding quantile q of the timed calls, in ns
+    uint64_t quantileNs(double q) const {
+        if (!timed) return 0;
+        uint64_t want = (uint64_t)(q * (timed - 1)) + 1, seen = 0;
+        for (int b = 0; b < METRIC_BUCKETS; b++) {
+            seen += buckets[b];
+            if (seen >= want) return b ? (1ull << b) - 1 : 0;
+        }
+        return (1ull << (METRIC_BUCKETS - 1)) - 1;
+    }
+};
+
+struct MetricsSnapshot {
+    StageSnapshot stage[StageCount];
+    int threads = 0;
+
+    uint64_t totalCalls() const {
+        uint64_t t = 0;
+        for (int s = 0; s < StageCount; s++) t += stage[s].calls;
+        return t;
+    }
+    uint64_t totalTimed() const {
+        uint64_t t = 0;
+        for (int s = 0; s < StageCount; s++) t += stage[s].timed;
+        return t;
+    }
+};
+
+inline MetricsSnapshot metricsSnapshot() {
+    MetricsSnapshot snap;
+    MetricRegistry& r = metricRegistry();
+    std::lock_guard<std::mutex> g(r.lock);
+    snap.threads = (int)r.shards.size();
+    for (size_t i = 0; i < r.shards.size(); i++) {
+        const MetricShard& sh = *r.shards[i];
+        for (int s = 0; s < StageCount; s++) {
+            StageSnapshot& st = snap.stage[s];
+            st.calls += sh.calls[s].load(std::memory_order_relaxed);
+            st.items += sh.items[s].load(std::memory_order_relaxed);
+            st.timed += sh.timed[s].load(std::memory_order_relaxed);
+            st.sumNs += sh.sumNs[s].load(std::memory_order_relaxed);
+            for (int b = 0; b < METRIC_BUCKETS; b++)
+                st.buckets[b] += sh.buckets[s][b].load(std::memory_order_relaxed);
+        }
+    }
+    return snap;
+}
+
+// Prometheus text exposition format. Histogram buckets are cumulative
+// with le in seconds and cover the timed calls; stages that never ran
+// are left out.
+inline std::string metricsPrometheus(const std::string& program) {
+    MetricsSnapshot snap = metricsSnapshot();
+    std::ostringstream out;
+    out << "# HELP monitor_stage_seconds Time spent per timed pipeline stage call.\n"
+        << "# TYPE monitor_stage_seconds histogram\n";
+    for (int s = 0; s < StageCount; s++) {
+        const StageSnapshot& st = snap.stage[s];
+        if (!st.timed) continue;
+        std::string labels = "program=\"" + program + "\",stage=\"" + metricStageName(s) + "\"";
+        uint64_t cum = 0;
+        for (int b = 0; b < METRIC_BUCKETS - 1; b++) {
+            cum += st.buckets[b];
+            out << "monitor_stage_seconds_bucket{" << labels << ",le=\"" << (double)(1ull << b) * 1e-9 << "\"} "
+                << cum << "\n";
+        }
+        out << "monitor_stage_seconds_bucket{" << labels << ",le=\"+Inf\"} " << st.timed << "\n"
+            << "monitor_stage_seconds_sum{" << labels << "} " << st.sumNs * 1e-9 << "\n"
+            << "monitor_stage_seconds_count{" << labels << "} " << st.timed << "\n";
+    }
+    out << "# HELP monitor_stage_calls_total Calls per stage, timed or not.\n"
+        << "# TYPE monitor_stage_calls_total counter\n";
+    for (int s = 0; s < StageCount; s++)
+        if (snap.stage[s].calls)
+            out << "monitor_stage_calls_total{program=\"" << program << "\",stage=\"" << metricStageName(s)
+                << "\"} " << snap.stage[s].calls << "\n";
+    out << "# HELP monitor_stage_items_total Rows, readings or queries handled per stage.\n"
+        << "# TYPE monitor_stage_items_total counter\n";
+    for (int s = 0; s < StageCount; s++)
+        if (snap.stage[s].calls)
+            out << "monitor_stage_items_total{program=\"" << program << "\",stage=\"" << metricStageName(s)
+                << "\"} " << snap.stage[s].items << "\n";
+    out << "# HELP monitor_metric_threads Threads that recorded metrics.\n"
+        << "# TYPE monitor_metric_threads gauge\n"
+        << "monitor_metric_threads{program=\"" << program << "\"} " << snap.threads << "\n";
+    return out.str();
+}
+
+inline std::string metricsJSON(const std::string& program) {
+    MetricsSnapshot snap = metricsSnapshot();
+    std::ostringstream out;
+    out << "{\"program\":\"" << program << "\",\"threads\":" << snap.threads << ",\"stages\":{";
+    bool first = true;
+    for (int s = 0; s < StageCount; s++) {
+        const StageSnapshot& st = snap.stage[s];
+        if (!st.calls) continue;
+        out << (first ? "" : ",") << "\"" << metricStageName(s) << "\":{"
+            << "\"calls\":" << st.calls << ",\"items\":" << st.items << ",\"timed\":" << st.timed
+            << ",\"sum_ns\":" << st.sumNs
+            << ",\"p50_ns\":" << st.quantileNs(0.5) << ",\"p99_ns\":" << st.quantileNs(0.99)
+            << ",\"buckets\":[";
+        for (int b = 0; b < METRIC_BUCKETS; b++) out << (b ? "," : "") << st.buckets[b];
+        out << "]}";
+        first = false;
+    }
+    out << "}}\n";
+    return out.str();
+}
+
+/* ---- export ---- */
+
+inline bool metricsWriteAll(int fd, const std::string& s) {
+    size_t done = 0;
+    while (done < s.size()) {
+        ssize_t n = write(fd, s.data() + done, s.size() - done);
+        if (n <= 0) return false;
+        done += n;
+    }
+    return true;
+}
+
+// Writes one snapshot to target ("unix:<path>" or a file name)
+inline bool metricsExport(const std::string& target, const std::string& program) {
+    if (target.compare(0, 5, "unix:") == 0) {
+        std::string path = target.substr(5);
+        sockaddr_un addr;
+        if (path.size() >= sizeof(addr.sun_path)) return false;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return false;
+        bool ok = connect(fd, (sockaddr*)&addr, sizeof(addr)) == 0 &&
+                  metricsWriteAll(fd, metricsPrometheus(program));
+        close(fd);
+        return ok;
+    }
+    bool json = target.size() > 5 && target.compare(target.size() - 5, 5, ".json") == 0;
+    std::string body = json ? metricsJSON(program) : metricsPrometheus(program);
+    std::string tmp = target + ".tmp." + std::to_string(getpid());
+    FILE* f = fopen(tmp.c_str(), "w");
+    if (!f) return false;
+    bool ok = fwrite(body.data(), 1, body.size(), f) == body.size();
+    ok = fclose(f) == 0 && ok;
+    return ok && rename(tmp.c_str(), target.c_str()) == 0;
+}
+
+inline std::string& metricsProgramName() {
+    static std::string* name = new std::string;
+    return *name;
+}
+
+// One export at a time: the interval thread and the exit hook share the
+// temp file. Once the final export has started the interval thread stops.
+struct MetricsExportState {
+    std::mutex lock;
+    bool final = false;
+};
+
+inline MetricsExportState& metricsExportState() {
+    static MetricsExportState* state = new MetricsExportState;
+    return *state;
+}
+
+// Returns false once the final export has been written
+inline bool metricsExportNow(bool final = false) {
+    MetricsExportState& st = metricsExportState();
+    std::lock_guard<std::mutex> g(st.lock);
+    if (st.final) return false;
+    st.final = final;
+    const char* target = getenv("METRICS_OUT");
+    if (target && *target && !metricsExport(target, metricsProgramName()))
+        fprintf(stderr, "metrics: cannot export to %s\n", target);
+    return true;
+}
+
+inline void metricsExportFinal() { metricsExportNow(true); }
+
+// Call once at the top of main. Does nothing unless METRICS_OUT is set.
+inline void metricsExportAtExit(const char* program) {
+    const char* target = getenv("METRICS_OUT");
+    if (!target || !*target) return;
+    metricsProgramName() = program;
+    metricRegistry();
+    atexit(metricsExportFinal);
+    const char* every = getenv("METRICS_INTERVAL");
+    int sec = every ? atoi(every) : 0;
+    if (sec > 0)
+        std::thread([sec] {
+            do std::this_thread::sleep_for(std::chrono::seconds(sec));
+            while (metricsExportNow());
+        }).detach();
+}
+
+// Mean cost in ns of one timed StageTimer (timed=true) or one counted
+// sampled call, measured on a private shard so the real counters are
+// untouched. Used by the bench modes to turn counts into an overhead.
+inline double metricsTimerCostNs(bool timed = true) {
+    MetricShard scratch;
+    const int n = 200000;
+    volatile uint64_t sink = 0;
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        if (!timed) {
+            metricCountInto(scratch, i % StageCount, 1);
+            sink = sink + scratch.tick[0]++;
+            continue;
+        }
+        std::chrono::steady_clock::time_point a = std::chrono::steady_clock::now();
+        metricRecordInto(scratch, i % StageCount,
+                         (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - a).count(), 1);
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / n;
+}
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef ROLLING_STATS_H
+#define ROLLING_STATS_H
+
+/*
+ Per-subzone sliding-window statistics for spike detection on sensor
+ streams (water and land programs).
+
+ Every stream (one subzone, one measured quantity) keeps the last W
+ readings in a ring, the rolling mean and variance of that window, an
+ EWMA and the rate of change since its previous reading. All of it is
+ updated in O(1) per reading: the reading that falls out of the window
+ is removed from the running mean / M2 with the sliding form of
+ Welford's update, so there is no per-reading loop over the window.
+
+ Memory is fixed when the detector is built: W floats in one flat ring
+ array plus a 48-byte state record per stream, so an update touches one
+ state cache line and one ring slot. No allocation after construction.
+
+ A reading is flagged when, once the window has minSamples values,
+   - it is more than zLimit standard deviations from the window mean,
+   - it is more than ewmaRatio above the EWMA, or
+   - it changes faster than rateLimit units per second.
+*/
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+
+struct SpikeConfig {
+    int window = 60;            // readings kept per stream
+    int minSamples = 10;        // no verdict before this many readings
+    double ewmaAlpha = 0.1;
+    double zLimit = 4.0;
+    double ewmaRatio = 0.5;     // x > ewma * (1 + ratio)
+    double rateLimit = 1e30;    // units per second, off by default
+};
+
+enum SpikeFlag {
+    SpikeNone = 0,
+    SpikeZScore = 1,
+    SpikeEwma = 2,
+    SpikeRate = 4
+};
+
+class SpikeDetector {
+public:
+    SpikeDetector(int streams, const SpikeConfig& config = SpikeConfig())
+        : cfg(config), n(streams), w(config.window < 1 ? 1 : config.window),
+          ring((size_t)streams * w, 0.0f), state(streams) {}
+
+    // Adds reading x of stream s taken at time t (seconds) and returns
+    // the SpikeFlag bits it raised. The statistics the reading is judged
+    // against are those from before it was added.
+    int add(int s, double t, float x) {
+        State& st = state[s];
+        int flags = SpikeNone;
+        int k = st.filled;
+
+        if (k > 0) {
+            double dt = t - st.lastT;
+            st.rate = dt > 0 ? (float)((x - st.last) / dt) : 0.0f;
+        }
+        if (k >= cfg.minSamples) {
+            double d = x - st.mean;
+            // |x - mean| > z * sd without the square root
+            if (st.m2 > 0 && d * d * (k - 1) > cfg.zLimit * cfg.zLimit * st.m2) flags |= SpikeZScore;
+            if (x > st.ewma * (1 + cfg.ewmaRatio)) flags |= SpikeEwma;
+            if (std::fabs(st.rate) > cfg.rateLimit) flags |= SpikeRate;
+        }
+
+        float& slot = ring[(size_t)s * w + st.head];
+        if (k < w) {
+            // Window still filling: plain Welford
+            double d = x - st.mean;
+            st.mean += d / (k + 1);
+            st.m2 += d * (x - st.mean);
+            st.filled = k + 1;
+        } else {
+            // Slide: x replaces the oldest reading y
+            double y = slot;
+            double oldMean = st.mean;
+            st.mean += (x - y) / w;
+            st.m2 += (x - y) * (x - st.mean + y - oldMean);
+            if (st.m2 < 0) st.m2 = 0;
+        }
+        slot = x;
+        st.head = st.head + 1 == w ? 0 : st.head + 1;
+
+        st.ewma = k == 0 ? x : (float)(cfg.ewmaAlpha * x + (1 - cfg.ewmaAlpha) * st.ewma);
+        st.last = x;
+        st.lastT = t;
+        return flags;
+    }
+
+    int streams() const { return n; }
+    int window() const { return w; }
+    int count(int s) const { return state[s].filled; }
+    double mean(int s) const { return state[s].mean; }
+    double variance(int s) const { return state[s].filled > 1 ? state[s].m2 / (state[s].filled - 1) : 0.0; }
+    double stddev(int s) const { return std::sqrt(variance(s)); }
+    float ewma(int s) const { return state[s].ewma; }
+    float rate(int s) const { return state[s].rate; }
+    float last(int s) const { return state[s].last; }
+
+    // Bytes held per stream, fixed at construction
+    size_t bytesPerStream() const { return w * sizeof(float) + sizeof(State); }
+
+private:
+    struct State {
+        double mean = 0, m2 = 0, lastT = 0;
+        float ewma = 0, last = 0, rate = 0;
+        int head = 0, filled = 0;
+    };
+
+    SpikeConfig cfg;
+    int n, w;
+    std::vector<float> ring;
+    std::vector<State> state;
+};
+
+#endif
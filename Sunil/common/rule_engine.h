@@ -0,0 +1,355 @@
+#ifndef RULE_ENGINE_H
+#define RULE_ENGINE_H
+
+/*
+ Declarative alert rules compiled once and run in batch over columnar
+ readings (water, land and app programs).
+
+ A rule file has one rule per line, '#' starts a comment line:
+
+   <name> <scope> <condition> : <message>
+
+   scope      *          all rows handed to evaluate()
+              each       every group separately
+              <group>    only the group with that name (e.g. a zone)
+
+   condition  col op value             per row: one hit per matching row
+              any(col op value)        first matching row in the scope
+              count(col op value) op n
+              sum(col) op n  avg(col) op n  min(col) op n  max(col) op n
+
+   op is one of > >= < <= == !=. A value for a string column is a word
+   or "quoted text" and is compiled to its dictionary code.
+
+   message    {row}, {group} and {value} are filled in by format()
+
+ compile() turns the text into a flat instruction array: column names,
+ scopes, operators and string literals are all resolved to integers.
+ Each instruction runs as one tight loop over a column slice, with the
+ comparison picked once per instruction through a template, so the
+ per-reading work is a compare and an add (count) or a compare and an
+ unconditional store (row hits), with no data-dependent branch.
+
+ Needs C++17 (generic lambdas).
+*/
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include "metrics.h"
+
+struct RuleGroup {
+    std::string name;
+    size_t begin, end;          // rows [begin, end)
+};
+
+struct RuleHit {
+    int rule;
+    int group;                  // -1 for scope *
+    long long row;              // -1 for count/sum/avg/min/max rules
+    double value;               // row value or aggregate
+};
+
+class RuleEngine {
+public:
+    // Columns are passed to evaluate() in the order they are added here.
+    // dict lists the strings of a dictionary-coded column (code = index).
+    int addColumn(const std::string& name, const std::vector<std::string>& dict = std::vector<std::string>()) {
+        columnIds[name] = columnDicts.size();
+        columnDicts.push_back(dict);
+        return columnDicts.size() - 1;
+    }
+
+    // Replaces the current rules. On error nothing is kept and error
+    // names the offending line.
+    bool compile(const std::string& text, std::string& error) {
+        prog.clear(); names.clear(); messages.clear(); scopeNames.clear();
+        std::istringstream in(text);
+        std::string line;
+        for (int lineNo = 1; std::getline(in, line); lineNo++) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            size_t p = line.find_first_not_of(" \t");
+            if (p == std::string::npos || line[p] == '#') continue;
+            if (!compileLine(line, error)) {
+                error = "line " + std::to_string(lineNo) + ": " + error;
+                prog.clear(); names.clear(); messages.clear(); scopeNames.clear();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool load(const std::string& path, std::string& error) {
+        std::ifstream f(path);
+        if (!f) { error = "cannot open " + path; return false; }
+        std::stringstream ss;
+        ss << f.rdbuf();
+        return compile(ss.str(), error);
+    }
+
+    int size() const { return prog.size(); }
+    const std::string& name(int rule) const { return names[rule]; }
+
+    // cols[c] points at the rows of column c. Hits are appended in rule
+    // order, then group order, then row order.
+    void evaluate(const std::vector<const float*>& cols, size_t rows,
+                  const std::vector<RuleGroup>& groups, std::vector<RuleHit>& hits) const {
+        StageTimer timer(StageAlerts, rows, rows < 1024);   // single-row requests are sampled
+        std::vector<int> scopeGroup(scopeNames.size(), -1);
+        if (!scopeNames.empty()) {
+            std::unordered_map<std::string, int> byName;
+            for (size_t g = 0; g < groups.size(); g++) byName.emplace(groups[g].name, g);
+            for (size_t s = 0; s < scopeNames.size(); s++) {
+                auto it = byName.find(scopeNames[s]);
+                if (it != byName.end()) scopeGroup[s] = it->second;
+            }
+        }
+
+        for (size_t r = 0; r < prog.size(); r++) {
+            const Instr& in = prog[r];
+            const float* x = cols[in.col];
+            if (in.scope == ScopeAll) {
+                run(in, r, -1, x, 0, rows, hits);
+            } else if (in.scope == ScopeEach) {
+                for (size_t g = 0; g < groups.size(); g++)
+                    run(in, r, g, x, groups[g].begin, groups[g].end, hits);
+            } else if (scopeGroup[in.scope] >= 0) {
+                const RuleGroup& g = groups[scopeGroup[in.scope]];
+                run(in, r, scopeGroup[in.scope], x, g.begin, g.end, hits);
+            }
+        }
+    }
+
+    std::string format(const RuleHit& h, const std::vector<RuleGroup>& groups, const std::string& rowName = "") const {
+        std::string out;
+        const std::string& m = messages[h.rule];
+        for (size_t i = 0; i < m.size(); i++) {
+            if (m.compare(i, 5, "{row}") == 0) { out += rowName; i += 4; }
+            else if (m.compare(i, 7, "{group}") == 0) { if (h.group >= 0) out += groups[h.group].name; i += 6; }
+            else if (m.compare(i, 7, "{value}") == 0) { out += number(h.value); i += 6; }
+            else out += m[i];
+        }
+        return out;
+    }
+
+private:
+    enum { CmpGt, CmpGe, CmpLt, CmpLe, CmpEq, CmpNe };
+    enum { AggRow, AggAny, AggCount, AggSum, AggAvg, AggMin, AggMax };
+    enum { ScopeAll = -1, ScopeEach = -2 };
+    static const size_t Chunk = 2048;
+
+    struct Instr {
+        uint8_t agg, cmp, limitCmp;
+        int col;
+        int scope;              // ScopeAll, ScopeEach or index into scopeNames
+        float value;            // row predicate operand
+        double limit;           // aggregate operand
+    };
+
+    struct Gt { bool operator()(float a, float b) const { return a > b; } };
+    struct Ge { bool operator()(float a, float b) const { return a >= b; } };
+    struct Lt { bool operator()(float a, float b) const { return a < b; } };
+    struct Le { bool operator()(float a, float b) const { return a <= b; } };
+    struct Eq { bool operator()(float a, float b) const { return a == b; } };
+    struct Ne { bool operator()(float a, float b) const { return a != b; } };
+
+    template <class F>
+    static void withCmp(int cmp, F f) {
+        switch (cmp) {
+            case CmpGt: f(Gt()); break;
+            case CmpGe: f(Ge()); break;
+            case CmpLt: f(Lt()); break;
+            case CmpLe: f(Le()); break;
+            case CmpEq: f(Eq()); break;
+            default:    f(Ne()); break;
+        }
+    }
+
+    static bool test(int cmp, double a, double b) {
+        switch (cmp) {
+            case CmpGt: return a > b;
+            case CmpGe: return a >= b;
+            case CmpLt: return a < b;
+            case CmpLe: return a <= b;
+            case CmpEq: return a == b;
+            default:    return a != b;
+        }
+    }
+
+    void run(const Instr& in, int rule, int group, const float* x, size_t b, size_t e,
+             std::vector<RuleHit>& hits) const {
+        float v = in.value;
+        switch (in.agg) {
+        case AggRow:
+            withCmp(in.cmp, [&](auto c) {
+                // Branch-free select into a small index buffer, one chunk
+                // at a time: always store, advance only on a match
+                uint32_t idx[Chunk];
+                for (size_t cb = b; cb < e; cb += Chunk) {
+                    size_t ce = e - cb < Chunk ? e : cb + Chunk, k = 0;
+                    for (size_t i = cb; i < ce; i++) {
+                        idx[k] = i - cb;
+                        k += c(x[i], v);
+                    }
+                    for (size_t j = 0; j < k; j++)
+                        hits.push_back({rule, group, (long long)(cb + idx[j]), x[cb + idx[j]]});
+                }
+            });
+            return;
+        case AggAny:
+            withCmp(in.cmp, [&](auto c) {
+                for (size_t i = b; i < e; i++)
+                    if (c(x[i], v)) { hits.push_back({rule, group, (long long)i, x[i]}); return; }
+            });
+            return;
+        case AggCount: {
+            size_t n = 0;
+            withCmp(in.cmp, [&](auto c) {
+                for (size_t i = b; i < e; i++) n += c(x[i], v);
+            });
+            if (test(in.limitCmp, (double)n, in.limit)) hits.push_back({rule, group, -1, (double)n});
+            return;
+        }
+        default: {
+            if (b == e) return;
+            double acc = in.agg == AggMin || in.agg == AggMax ? x[b] : 0;
+            if (in.agg == AggMin)      for (size_t i = b; i < e; i++) acc = x[i] < acc ? x[i] : acc;
+            else if (in.agg == AggMax) for (size_t i = b; i < e; i++) acc = x[i] > acc ? x[i] : acc;
+            else                       for (size_t i = b; i < e; i++) acc += x[i];
+            if (in.agg == AggAvg) acc /= (e - b);
+            if (test(in.limitCmp, acc, in.limit)) hits.push_back({rule, group, -1, acc});
+            return;
+        }
+        }
+    }
+
+    bool compileLine(const std::string& line, std::string& error) {
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) { error = "missing ': <message>'"; return false; }
+        std::string msg = line.substr(colon + 1);
+        size_t m = msg.find_first_not_of(" \t");
+        msg = m == std::string::npos ? "" : msg.substr(m);
+
+        const char* s = line.c_str();
+        const char* end = s + colon;
+        std::string ruleName = word(s, end), scope = word(s, end);
+        if (ruleName.empty() || scope.empty()) { error = "expected '<name> <scope> <condition>'"; return false; }
+
+        Instr in = {AggRow, CmpGt, CmpGe, 0, ScopeAll, 0, 1};
+        if (scope == "each") in.scope = ScopeEach;
+        else if (scope != "*") {
+            in.scope = scopeNames.size();
+            for (size_t i = 0; i < scopeNames.size(); i++)
+                if (scopeNames[i] == scope) in.scope = i;
+            if (in.scope == (int)scopeNames.size()) scopeNames.push_back(scope);
+        }
+
+        std::string head = word(s, end);
+        skip(s, end);
+        if (s < end && *s == '(') {
+            static const char* aggs[] = {"", "any", "count", "sum", "avg", "min", "max"};
+            in.agg = 0;
+            for (int a = 1; a <= AggMax; a++)
+                if (head == aggs[a]) in.agg = a;
+            if (in.agg == AggRow) { error = "unknown aggregate '" + head + "'"; return false; }
+            s++;
+            if (!column(word(s, end), in.col, error)) return false;
+            if (in.agg == AggAny || in.agg == AggCount) {
+                if (!op(s, end, in.cmp, error) || !operand(s, end, in.col, in.value, error)) return false;
+            }
+            skip(s, end);
+            if (s >= end || *s != ')') { error = "expected ')'"; return false; }
+            s++;
+            if (in.agg != AggAny) {
+                float limit;
+                if (!op(s, end, in.limitCmp, error) || !operand(s, end, -1, limit, error)) return false;
+                in.limit = limit;
+            }
+        } else {
+            if (!column(head, in.col, error)) return false;
+            if (!op(s, end, in.cmp, error) || !operand(s, end, in.col, in.value, error)) return false;
+        }
+        skip(s, end);
+        if (s < end) { error = "unexpected '" + std::string(s, end) + "'"; return false; }
+
+        prog.push_back(in);
+        names.push_back(ruleName);
+        messages.push_back(msg);
+        return true;
+    }
+
+    static void skip(const char*& s, const char* end) {
+        while (s < end && (*s == ' ' || *s == '\t')) s++;
+    }
+
+    static std::string word(const char*& s, const char* end) {
+        skip(s, end);
+        const char* b = s;
+        while (s < end && *s != ' ' && *s != '\t' && *s != '(' && *s != ')' && !strchr("<>=!", *s)) s++;
+        return std::string(b, s);
+    }
+
+    bool column(const std::string& name, int& col, std::string& error) const {
+        auto it = columnIds.find(name);
+        if (it == columnIds.end()) { error = "unknown column '" + name + "'"; return false; }
+        col = it->second;
+        return true;
+    }
+
+    static bool op(const char*& s, const char* end, uint8_t& cmp, std::string& error) {
+        skip(s, end);
+        static const char* ops[] = {">=", "<=", "==", "!=", ">", "<"};
+        static const uint8_t codes[] = {CmpGe, CmpLe, CmpEq, CmpNe, CmpGt, CmpLt};
+        for (int i = 0; i < 6; i++) {
+            size_t len = strlen(ops[i]);
+            if ((size_t)(end - s) >= len && strncmp(s, ops[i], len) == 0) {
+                cmp = codes[i];
+                s += len;
+                return true;
+            }
+        }
+        error = "expected a comparison";
+        return false;
+    }
+
+    // A number, or a string literal looked up in the column's dictionary.
+    // A string missing from the dictionary gets code -1 and never matches.
+    bool operand(const char*& s, const char* end, int col, float& value, std::string& error) const {
+        skip(s, end);
+        std::string text;
+        if (s < end && *s == '"') {
+            const char* b = ++s;
+            while (s < end && *s != '"') s++;
+            if (s >= end) { error = "unterminated string"; return false; }
+            text.assign(b, s++);
+        } else {
+            text = word(s, end);
+            char* stop;
+            double d = strtod(text.c_str(), &stop);
+            if (!text.empty() && *stop == 0) { value = d; return true; }
+        }
+        if (col < 0 || columnDicts[col].empty()) { error = "expected a number, got '" + text + "'"; return false; }
+        value = -1;
+        for (size_t i = 0; i < columnDicts[col].size(); i++)
+            if (columnDicts[col][i] == text) value = i;
+        return true;
+    }
+
+    static std::string number(double v) {
+        std::ostringstream os;
+        os << v;
+        return os.str();
+    }
+
+    std::unordered_map<std::string, int> columnIds;
+    std::vector<std::vector<std::string>> columnDicts;
+    std::vector<Instr> prog;
+    std::vector<std::string> names, messages, scopeNames;
+};
+
+#endif